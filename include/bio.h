@@ -35,6 +35,8 @@ AUTOLIB(bio)
 
 #include <fcntl.h>	/* for O_RDONLY, O_WRONLY */
 
+#define	OMMAP	0x10000	/* or'ed into OREAD, serve regular files from a memory mapping */
+
 typedef	struct	Biobuf	Biobuf;
 
 enum
@@ -62,6 +64,7 @@ struct	Biobuf
 	int	state;		/* r/w/inactive */
 	int	fid;		/* open file */
 	int	flag;		/* magic if malloc'ed */
+	int	mapped;		/* buffer is a mapping of the whole file */
 	vlong	offset;		/* offset of buffer in file */
 	int	bsize;		/* size of buffer */
 	unsigned char*	bbuf;		/* pointer to beginning of buffer */
@@ -91,6 +94,7 @@ int	Bfildes(Biobuf*);
 int	Bflush(Biobuf*);
 int	Bgetc(Biobuf*);
 int	Bgetd(Biobuf*, double*);
+void*	Bgetp(Biobuf*, long);
 long	Bgetrune(Biobuf*);
 int	Binit(Biobuf*, int, int);
 int	Binits(Biobuf*, int, int, unsigned char*, int);
@@ -193,6 +193,7 @@ typedef	struct	Reglist	Reglist;
 typedef	struct	Mach	Mach;
 typedef	struct	Machdata Machdata;
 typedef	struct	Seg	Seg;
+typedef	struct	Pagecache Pagecache;
 
 typedef int Maprw(Map *m, Seg *s, uvlong addr, void *v, uint n, int isread);
 
@@ -213,6 +214,7 @@ struct Seg {
 struct Map {
 	int	pid;
 	int	tid;
+	Pagecache	*cache;	/* pages read since the process last ran */
 	int	nsegs;	/* number of segments */
 	Seg	seg[1];	/* actually n of these */
 };
@@ -34,6 +34,10 @@ extern enum E myConstFunc(struct S* const ctx, int const id, struct S **const fi
 
 enum E myConstFunc(struct S *const ctx, int const id, struct S **const filter) { return 0; }
 
+int add(int x, int y) {
+	return x+y;
+}
+
 // issue 1222
 typedef union {
 	long align;
@@ -52,6 +56,7 @@ struct ibv_context {
 import "C"
 import (
 	"os"
+	"runtime"
 	"testing"
 	"unsafe"
 )
@@ -132,3 +137,37 @@ var (
 type Context struct {
 	ctx *C.struct_ibv_context
 }
+
+// Benchmark the cost of a call into a trivial C function,
+// which is dominated by the cgocall bookkeeping.
+func benchCgoCall(b *testing.B) {
+	const x = C.int(2)
+	const y = C.int(3)
+	for i := 0; i < b.N; i++ {
+		C.add(x, y)
+	}
+}
+
+// Same as benchCgoCall, but with one caller per proc,
+// so that the calls contend on the scheduler.
+func benchCgoCallParallel(b *testing.B) {
+	const x = C.int(2)
+	const y = C.int(3)
+	procs := runtime.GOMAXPROCS(0)
+	done := make(chan bool, procs)
+	for p := 0; p < procs; p++ {
+		n := b.N / procs
+		if p == 0 {
+			n += b.N % procs
+		}
+		go func(n int) {
+			for i := 0; i < n; i++ {
+				C.add(x, y)
+			}
+			done <- true
+		}(n)
+	}
+	for p := 0; p < procs; p++ {
+		<-done
+	}
+}
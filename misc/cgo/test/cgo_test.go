@@ -26,3 +26,6 @@ func TestBlocking(t *testing.T)            { testBlocking(t) }
 func Test1328(t *testing.T)                { test1328(t) }
 func TestParallelSleep(t *testing.T)       { testParallelSleep(t) }
 func TestSetEnv(t *testing.T)              { testSetEnv(t) }
+
+func BenchmarkCgoCall(b *testing.B)         { benchCgoCall(b) }
+func BenchmarkCgoCallParallel(b *testing.B) { benchCgoCallParallel(b) }
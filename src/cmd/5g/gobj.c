@@ -33,9 +33,9 @@
 void
 zname(Biobuf *b, Sym *s, int t)
 {
-	Bputc(b, ANAME);	/* as */
-	Bputc(b, t);		/* type */
-	Bputc(b, s->sym);	/* sym */
+	BPUTC(b, ANAME);	/* as */
+	BPUTC(b, t);		/* type */
+	BPUTC(b, s->sym);	/* sym */
 
 	Bputname(b, s);
 }
@@ -43,12 +43,12 @@ zname(Biobuf *b, Sym *s, int t)
 void
 zfile(Biobuf *b, char *p, int n)
 {
-	Bputc(b, ANAME);
-	Bputc(b, D_FILE);
-	Bputc(b, 1);
-	Bputc(b, '<');
+	BPUTC(b, ANAME);
+	BPUTC(b, D_FILE);
+	BPUTC(b, 1);
+	BPUTC(b, '<');
 	Bwrite(b, p, n);
-	Bputc(b, 0);
+	BPUTC(b, 0);
 }
 
 void
@@ -56,13 +56,13 @@ zhist(Biobuf *b, int line, vlong offset)
 {
 	Addr a;
 
-	Bputc(b, AHISTORY);
-	Bputc(b, C_SCOND_NONE);
-	Bputc(b, NREG);
-	Bputc(b, line);
-	Bputc(b, line>>8);
-	Bputc(b, line>>16);
-	Bputc(b, line>>24);
+	BPUTC(b, AHISTORY);
+	BPUTC(b, C_SCOND_NONE);
+	BPUTC(b, NREG);
+	BPUTC(b, line);
+	BPUTC(b, line>>8);
+	BPUTC(b, line>>16);
+	BPUTC(b, line>>24);
 	zaddr(b, &zprog.from, 0);
 	a = zprog.to;
 	if(offset != 0) {
@@ -89,10 +89,10 @@ zaddr(Biobuf *b, Addr *a, int s)
 		fatal("We should no longer generate these as types");
 
 	default:
-		Bputc(b, a->type);
-		Bputc(b, a->reg);
-		Bputc(b, s);
-		Bputc(b, a->name);
+		BPUTC(b, a->type);
+		BPUTC(b, a->reg);
+		BPUTC(b, s);
+		BPUTC(b, a->name);
 	}
 
 	switch(a->type) {
@@ -107,10 +107,10 @@ zaddr(Biobuf *b, Addr *a, int s)
 
 	case D_CONST2:
 		l = a->offset2;
-		Bputc(b, l);
-		Bputc(b, l>>8);
-		Bputc(b, l>>16);
-		Bputc(b, l>>24); // fall through
+		BPUTC(b, l);
+		BPUTC(b, l>>8);
+		BPUTC(b, l>>16);
+		BPUTC(b, l>>24); // fall through
 	case D_OREG:
 	case D_CONST:
 	case D_SHIFT:
@@ -119,10 +119,10 @@ zaddr(Biobuf *b, Addr *a, int s)
 	case D_EXTERN:
 	case D_PARAM:
 		l = a->offset;
-		Bputc(b, l);
-		Bputc(b, l>>8);
-		Bputc(b, l>>16);
-		Bputc(b, l>>24);
+		BPUTC(b, l);
+		BPUTC(b, l>>8);
+		BPUTC(b, l>>16);
+		BPUTC(b, l>>24);
 		break;
 
 	case D_BRANCH:
@@ -130,36 +130,36 @@ zaddr(Biobuf *b, Addr *a, int s)
 			fatal("unpatched branch");
 		a->offset = a->branch->loc;
 		l = a->offset;
-		Bputc(b, l);
-		Bputc(b, l>>8);
-		Bputc(b, l>>16);
-		Bputc(b, l>>24);
+		BPUTC(b, l);
+		BPUTC(b, l>>8);
+		BPUTC(b, l>>16);
+		BPUTC(b, l>>24);
 		break;
 
 	case D_SCONST:
 		n = a->sval;
 		for(i=0; i<NSNAME; i++) {
-			Bputc(b, *n);
+			BPUTC(b, *n);
 			n++;
 		}
 		break;
 
 	case D_REGREG:
-		Bputc(b, a->offset);
+		BPUTC(b, a->offset);
 		break;
 
 	case D_FCONST:
 		ieeedtod(&e, a->dval);
 		l = e;
-		Bputc(b, l);
-		Bputc(b, l>>8);
-		Bputc(b, l>>16);
-		Bputc(b, l>>24);
+		BPUTC(b, l);
+		BPUTC(b, l>>8);
+		BPUTC(b, l>>16);
+		BPUTC(b, l>>24);
 		l = e >> 32;
-		Bputc(b, l);
-		Bputc(b, l>>8);
-		Bputc(b, l>>16);
-		Bputc(b, l>>24);
+		BPUTC(b, l);
+		BPUTC(b, l>>8);
+		BPUTC(b, l>>16);
+		BPUTC(b, l>>24);
 		break;
 	}
 }
@@ -249,13 +249,13 @@ dumpfuncs(void)
 					goto jackpot;
 				break;
 			}
-			Bputc(bout, p->as);
-			Bputc(bout, p->scond);
- 			Bputc(bout, p->reg);
-			Bputc(bout, p->lineno);
-			Bputc(bout, p->lineno>>8);
-			Bputc(bout, p->lineno>>16);
-			Bputc(bout, p->lineno>>24);
+			BPUTC(bout, p->as);
+			BPUTC(bout, p->scond);
+ 			BPUTC(bout, p->reg);
+			BPUTC(bout, p->lineno);
+			BPUTC(bout, p->lineno>>8);
+			BPUTC(bout, p->lineno>>16);
+			BPUTC(bout, p->lineno>>24);
 			zaddr(bout, &p->from, sf);
 			zaddr(bout, &p->to, st);
 		}
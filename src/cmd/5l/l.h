@@ -269,7 +269,7 @@ enum
 	STRINGSZ	= 200,
 	MINSIZ		= 64,
 	NENT		= 100,
-	MAXIO		= 8192,
+	MAXIO		= 64*1024,
 	MAXHIST		= 20,	/* limit of path elements for history symbols */
 	MINLC	= 4,
 };
@@ -298,29 +298,74 @@ main(int argc, char *argv[])
 	errorexit();
 }
 
+enum
+{
+	ProgSlab = 1024,
+	ProgBytes = 40,	/* bytes of object file per Prog kept, counting ANAME and ADATA */
+};
+
+static Prog *progslab;
+static int nprogslab;
+
+/*
+ * Progs come from slabs.  Ldobj1 makes sure there is a slab
+ * big enough for all of an object's instructions before
+ * decoding them.
+ */
+static void
+progs(int n)
+{
+	if(nprogslab >= n)
+		return;
+	if(n < ProgSlab)
+		n = ProgSlab;
+	progslab = mal(n*sizeof(Prog));
+	nprogslab = n;
+}
+
+static Prog*
+newprog(void)
+{
+	if(nprogslab == 0)
+		progs(ProgSlab);
+	nprogslab--;
+	return progslab++;
+}
+
+/*
+ * Give back p, the last Prog returned by newprog.
+ */
+static void
+unprog(Prog *p)
+{
+	if(p != progslab-1)
+		return;
+	memset(p, 0, sizeof *p);
+	progslab--;
+	nprogslab++;
+}
+
 static void
-zaddr(Biobuf *f, Adr *a, Sym *h[])
+zaddr(Objbuf *b, Adr *a, Sym *h[])
 {
 	int i, c;
 	int32 l;
 	Sym *s;
 	Auto *u;
 
-	a->type = Bgetc(f);
-	a->reg = Bgetc(f);
-	c = Bgetc(f);
-	if(c < 0 || c > NSYM){
+	a->type = OGETC(b);
+	a->reg = OGETC(b);
+	c = OGETC(b);
+	if(c >= NSYM){
 		print("sym out of range: %d\n", c);
-		Bputc(f, ALAST+1);
 		return;
 	}
 	a->sym = h[c];
-	a->name = Bgetc(f);
+	a->name = OGETC(b);
 
 	if((schar)a->reg < 0 || a->reg > NREG) {
 		print("register out of range %d\n", a->reg);
-		Bputc(f, ALAST+1);
-		return;	/*  force real diagnostic */
+		return;
 	}
 
 	if(a->type == D_CONST || a->type == D_OCONST) {
@@ -337,8 +382,7 @@ zaddr(Biobuf *f, Adr *a, Sym *h[])
 	switch(a->type) {
 	default:
 		print("unknown type %d\n", a->type);
-		Bputc(f, ALAST+1);
-		return;	/*  force real diagnostic */
+		return;
 
 	case D_NONE:
 	case D_REG:
@@ -348,29 +392,28 @@ zaddr(Biobuf *f, Adr *a, Sym *h[])
 		break;
 
 	case D_REGREG:
-		a->offset = Bgetc(f);
-		c++;
+		a->offset = OGETC(b);
 		break;
 
 	case D_CONST2:
-		a->offset2 = Bget4(f);	// fall through
+		a->offset2 = OGET4(b);	// fall through
 	case D_BRANCH:
 	case D_OREG:
 	case D_CONST:
 	case D_OCONST:
 	case D_SHIFT:
-		a->offset = Bget4(f);
+		a->offset = OGET4(b);
 		break;
 
 	case D_SCONST:
 		a->sval = mal(NSNAME);
-		Bread(f, a->sval, NSNAME);
-		c += NSNAME;
+		memmove(a->sval, b->p, NSNAME);
+		b->p += NSNAME;
 		break;
 
 	case D_FCONST:
-		a->ieee.l = Bget4(f);
-		a->ieee.h = Bget4(f);
+		a->ieee.l = OGET4(b);
+		a->ieee.h = OGET4(b);
 		break;
 	}
 	s = a->sym;
@@ -420,10 +463,14 @@ ldobj1(Biobuf *f, char *pkg, int64 len, char *pn)
 	int32 eof;
 	char src[1024], *x;
 	Prog *lastp;
+	Objbuf ob, *b;
 
 	lastp = nil;
 	ntext = 0;
-	eof = Boffset(f) + len;
+	b = &ob;
+	objinit(b, f, len);
+	eof = b->off + len;
+	progs(len/ProgBytes);
 	src[0] = 0;
 
 newloop:
@@ -434,34 +481,27 @@ newloop:
 	skip = 0;
 
 loop:
-	if(f->state == Bracteof || Boffset(f) >= eof)
-		goto eof;
-	o = Bgetc(f);
-	if(o == Beof)
+	if(objrec(b) <= 0)
 		goto eof;
+	o = OGETC(b);
 
 	if(o <= AXXX || o >= ALAST) {
-		diag("%s:#%lld: opcode out of range: %#ux", pn, Boffset(f), o);
+		diag("%s:#%lld: opcode out of range: %#ux", pn, OOFFSET(b), o);
 		print("	probably not a .5 file\n");
 		errorexit();
 	}
 	if(o == ANAME || o == ASIGNAME) {
 		sig = 0;
 		if(o == ASIGNAME)
-			sig = Bget4(f);
-		v = Bgetc(f); /* type */
-		o = Bgetc(f); /* sym */
+			sig = OGET4(b);
+		v = OGETC(b); /* type */
+		o = OGETC(b); /* sym */
 		r = 0;
 		if(v == D_STATIC)
 			r = version;
-		name = Brdline(f, '\0');
-		if(name == nil) {
-			if(Blinelen(f) > 0) {
-				fprint(2, "%s: name too long\n", pn);
-				errorexit();
-			}
+		name = objname(b);
+		if(name == nil)
 			goto eof;
-		}
 		x = expandpkg(name, pkg);
 		s = lookup(x, r);
 		if(x != name)
@@ -499,14 +539,14 @@ loop:
 		goto loop;
 	}
 
-	p = mal(sizeof(Prog));
+	p = newprog();
 	p->as = o;
-	p->scond = Bgetc(f);
-	p->reg = Bgetc(f);
-	p->line = Bget4(f);
+	p->scond = OGETC(b);
+	p->reg = OGETC(b);
+	p->line = OGET4(b);
 
-	zaddr(f, &p->from, h);
-	zaddr(f, &p->to, h);
+	zaddr(b, &p->from, h);
+	zaddr(b, &p->to, h);
 
 	if(p->as != ATEXT && p->as != AGLOBL && p->reg > NREG)
 		diag("register out of range %A %d", p->as, p->reg);
@@ -538,8 +578,8 @@ loop:
 			cursym->autom = curauto;
 		curauto = 0;
 		cursym = nil;
-		if(Boffset(f) == eof)
-			return;
+		if(OOFFSET(b) == eof)
+			goto out;
 		goto newloop;
 
 	case AGLOBL:
@@ -581,7 +621,7 @@ loop:
 			errorexit();
 		}
 		savedata(s, p, pn);
-		unmal(p, sizeof *p);
+		unprog(p);
 		break;
 
 	case AGOK:
@@ -606,7 +646,7 @@ loop:
 			/* redefinition, so file has probably been seen before */
 			if(debug['v'])
 				Bprint(&bso, "skipping: %s: redefinition: %s", pn, s->name);
-			return;
+			goto out;
 		}
 		skip = 0;
 		if(s->type != 0 && s->type != SXREF) {
@@ -745,6 +785,8 @@ loop:
 
 eof:
 	diag("truncated object file: %s", pn);
+out:
+	objterm(b);
 }
 
 Prog*
@@ -752,7 +794,7 @@ prg(void)
 {
 	Prog *p;
 
-	p = mal(sizeof(Prog));
+	p = newprog();
 	*p = zprg;
 	return p;
 }
@@ -692,6 +692,7 @@ igen(Node *n, Node *a, Node *res)
 	case OCALLFUNC:
 		fp = structfirst(&flist, getoutarg(n->left->type));
 		cgen_call(n, 0);
+		regcallspill(n);
 		memset(a, 0, sizeof *a);
 		a->op = OINDREG;
 		a->val.u.reg = D_SP;
@@ -1112,6 +1113,12 @@ sgen(Node *n, Node *ns, int32 w)
 		}
 		// we leave with the flag clear
 		gins(ACLD, N, N);
+	} else if(w >= 16 && w <= MaxInlineSSE) {
+		// normal direction, medium size.
+		// REP MOVSQ has a high startup cost; copy 16 bytes
+		// at a time through an SSE register instead, then
+		// pick up the tail through CX.
+		ssecopy(D_SI, D_DI, w, &cx);
 	} else {
 		// normal direction
 		if(q >= 4) {
@@ -1140,6 +1147,48 @@ sgen(Node *n, Node *ns, int32 w)
 	restx(&cx, &oldcx);
 }
 
+/*
+ * copy w bytes from 0(sreg) to 0(dreg) in ascending order
+ * using unaligned 16-byte SSE moves, finishing the
+ * tail with moves through the scratch register tmp.
+ * only safe if the destination does not overlap
+ * the source from above.
+ */
+void
+ssecopy(int sreg, int dreg, int32 w, Node *tmp)
+{
+	Node x, src, dst, t;
+	int32 o;
+
+	regalloc(&x, types[TFLOAT64], N);
+	for(o=0; o+16<=w; o+=16) {
+		nodindreg(&src, types[TFLOAT64], sreg);
+		src.xoffset = o;
+		nodindreg(&dst, types[TFLOAT64], dreg);
+		dst.xoffset = o;
+		gins(AMOVOU, &src, &x);
+		gins(AMOVOU, &x, &dst);
+	}
+	regfree(&x);
+
+	for(; o<w; o+=t.type->width) {
+		if(w-o >= 8)
+			nodreg(&t, types[TUINT64], tmp->val.u.reg);
+		else if(w-o >= 4)
+			nodreg(&t, types[TUINT32], tmp->val.u.reg);
+		else if(w-o >= 2)
+			nodreg(&t, types[TUINT16], tmp->val.u.reg);
+		else
+			nodreg(&t, types[TUINT8], tmp->val.u.reg);
+		nodindreg(&src, t.type, sreg);
+		src.xoffset = o;
+		nodindreg(&dst, t.type, dreg);
+		dst.xoffset = o;
+		gins(optoas(OAS, t.type), &src, &t);
+		gins(optoas(OAS, t.type), &t, &dst);
+	}
+}
+
 static int
 cadable(Node *n)
 {
@@ -0,0 +1,941 @@
+// Copyright 2011 The Go Authors.  All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/*
+ * value numbering.
+ *
+ * runs on the flow graph regopt built, after
+ * the registers have been assigned.  every
+ * register carries the number of the value it
+ * holds.  an instruction that computes a value
+ * already in a register is replaced by a move
+ * from that register, or deleted if its
+ * destination holds the value already.
+ *
+ * the code generator often copies a register
+ * over a value only to compute the same value
+ * into it again (MOVQ CX,BX; MOVQ 8(BX),BX).
+ * such a run of writes, none of which can fault
+ * and none of whose results are used elsewhere,
+ * is deleted when it ends with the register
+ * holding what it held before.
+ *
+ * what is known flows down extended basic blocks:
+ * an instruction with a single predecessor starts
+ * with what was known after that predecessor, a
+ * join starts with nothing.
+ *
+ * memory is handled conservatively.  a stack slot
+ * whose address is never taken is only changed by
+ * a store that names it.  a store through a pointer
+ * or a call forgets every other load.
+ */
+
+#include "gg.h"
+#include "opt.h"
+
+enum
+{
+	NVREG	= 32,		/* AX..R15, X0..X15 */
+	NVEXPR	= 128,
+	NTAKEN	= 64,
+	NCHAIN	= 4,
+	BIGW	= 1<<20,	/* width of an unknown store */
+};
+
+typedef	struct	Vexpr	Vexpr;
+typedef	struct	Vstate	Vstate;
+typedef	struct	Vsave	Vsave;
+typedef	struct	Vchain	Vchain;
+
+struct	Vexpr
+{
+	short	as;
+	uchar	type;		/* source operand */
+	uchar	index;
+	uchar	scale;
+	int	width;		/* bytes loaded; 0 if not a load */
+	Sym*	sym;
+	vlong	offset;
+	int32	v0;		/* destination before a read-modify-write */
+	int32	v1;		/* source or base register */
+	int32	v2;		/* index register */
+	int32	val;
+};
+
+struct	Vstate
+{
+	int32	reg[NVREG];
+	int	nexpr;
+	Vexpr	expr[NVEXPR];
+};
+
+/*
+ * writes to one register since it last
+ * held before; see vnchain.
+ */
+struct	Vchain
+{
+	int	n;
+	int32	before;
+	Reg*	r[NCHAIN];
+};
+
+struct	Vsave
+{
+	Reg*	r;
+	Vstate	s;
+	Vsave*	link;
+};
+
+static	Vstate	cur;
+static	int32	nval;
+static	Vsave*	saved;
+static	Vsave*	freesave;
+static	Vchain	chain[NVREG];
+static	int	vnlast;		/* register whose chain the last instruction joined */
+static	Sym*	taken[NTAKEN];
+static	int	ntaken;
+static	int	anytaken;
+
+static int
+vnreg(int t)
+{
+	if(t >= D_AX && t <= D_R15)
+		return t - D_AX;
+	if(t >= D_X0 && t <= D_X0+15)
+		return 16 + t - D_X0;
+	if(t >= D_AL && t <= D_R15B)
+		return t - D_AL;
+	if(t >= D_AH && t <= D_BH)
+		return t - D_AH;
+	return -1;
+}
+
+static int
+ismem(int t)
+{
+	switch(t) {
+	case D_EXTERN:
+	case D_STATIC:
+	case D_AUTO:
+	case D_PARAM:
+		return 1;
+	}
+	return t >= D_INDIR+D_AX && t <= D_INDIR+D_R15;
+}
+
+static void
+vnset(int i, int32 v)
+{
+	cur.reg[i] = v;
+	chain[i].n = 0;
+}
+
+static void
+vnkill(int i)
+{
+	vnset(i, ++nval);
+}
+
+static void
+vnreset(void)
+{
+	int i;
+
+	for(i=0; i<NVREG; i++)
+		vnkill(i);
+	cur.nexpr = 0;
+}
+
+/*
+ * bytes read or written by the memory
+ * operand of an instruction.
+ */
+static int
+vnwidth(int as)
+{
+	switch(as) {
+	case AMOVB:
+	case AMOVBLSX:
+	case AMOVBLZX:
+	case AMOVBQSX:
+	case AMOVBQZX:
+	case AADDB:
+	case ASUBB:
+	case AANDB:
+	case AORB:
+	case AXORB:
+	case ASETCC:
+	case ASETCS:
+	case ASETEQ:
+	case ASETGE:
+	case ASETGT:
+	case ASETHI:
+	case ASETLE:
+	case ASETLS:
+	case ASETLT:
+	case ASETMI:
+	case ASETNE:
+	case ASETOC:
+	case ASETOS:
+	case ASETPC:
+	case ASETPL:
+	case ASETPS:
+		return 1;
+
+	case AMOVW:
+	case AMOVWLSX:
+	case AMOVWLZX:
+	case AMOVWQSX:
+	case AMOVWQZX:
+	case AADDW:
+	case ASUBW:
+	case AANDW:
+	case AORW:
+	case AXORW:
+		return 2;
+
+	case AMOVL:
+	case AMOVLQSX:
+	case AMOVLQZX:
+	case AMOVSS:
+	case ACVTSL2SD:
+	case ACVTSL2SS:
+	case ACVTSS2SD:
+	case ACVTSS2SL:
+	case ACVTSS2SQ:
+	case ACVTTSS2SL:
+	case ACVTTSS2SQ:
+	case AADDL:
+	case ASUBL:
+	case AANDL:
+	case AORL:
+	case AXORL:
+	case AINCL:
+	case ADECL:
+	case ANEGL:
+	case ANOTL:
+	case ASHLL:
+	case ASHRL:
+	case ASARL:
+	case AADDSS:
+	case ASUBSS:
+	case AMULSS:
+	case ADIVSS:
+		return 4;
+
+	case AMOVQ:
+	case AMOVSD:
+	case ACVTSD2SL:
+	case ACVTSD2SQ:
+	case ACVTSD2SS:
+	case ACVTSQ2SD:
+	case ACVTSQ2SS:
+	case ACVTTSD2SL:
+	case ACVTTSD2SQ:
+	case AADDQ:
+	case ASUBQ:
+	case AANDQ:
+	case AORQ:
+	case AXORQ:
+	case AINCQ:
+	case ADECQ:
+	case ANEGQ:
+	case ANOTQ:
+	case ASHLQ:
+	case ASHRQ:
+	case ASARQ:
+	case AADDSD:
+	case ASUBSD:
+	case AMULSD:
+	case ADIVSD:
+		return 8;
+
+	case AMOVOU:
+		return 16;
+	}
+	return BIGW;
+}
+
+/*
+ * might a pointer refer to the stack slot?
+ */
+static int
+vntaken(int type, Sym *s)
+{
+	int i;
+
+	if(type != D_AUTO && type != D_PARAM)
+		return 1;
+	if(anytaken || s == S)
+		return 1;
+	for(i=0; i<ntaken; i++)
+		if(taken[i] == s)
+			return 1;
+	return 0;
+}
+
+static void
+vnaddr(Adr *a)
+{
+	int i, t;
+
+	t = a->type;
+	if(a->type == D_ADDR)
+		t = a->index;
+	if(t == D_SP || t == D_INDIR+D_SP) {
+		anytaken = 1;
+		return;
+	}
+	if(t != D_AUTO && t != D_PARAM)
+		return;
+	if(a->sym == S || ntaken >= NTAKEN) {
+		anytaken = 1;
+		return;
+	}
+	for(i=0; i<ntaken; i++)
+		if(taken[i] == a->sym)
+			return;
+	taken[ntaken++] = a->sym;
+}
+
+/*
+ * find the stack slots whose
+ * address is taken.
+ */
+static void
+vntakenscan(void)
+{
+	Reg *r;
+	Prog *p;
+
+	ntaken = 0;
+	anytaken = 0;
+	for(r=firstr; r!=R; r=r->link) {
+		p = r->prog;
+		if(p->as == ALEAQ || p->as == ALEAL)
+			vnaddr(&p->from);
+		if(p->from.type == D_ADDR || p->from.type == D_SP)
+			vnaddr(&p->from);
+		if(p->to.type == D_ADDR || p->to.type == D_SP)
+			vnaddr(&p->to);
+	}
+}
+
+static int
+overlap(vlong o1, int w1, vlong o2, int w2)
+{
+	return o1 < o2+w2 && o2 < o1+w1;
+}
+
+/*
+ * forget the loads that a store of w bytes
+ * to a might change.  a == A is a call.
+ */
+static void
+vnstore(Adr *a, int w)
+{
+	Vexpr *x, *e;
+	int k;
+
+	e = cur.expr + cur.nexpr;
+	for(x=cur.expr; x<e; x++) {
+		if(x->width == 0)
+			continue;
+		k = 0;
+		if(a == A || !ismem(a->type) || a->type >= D_INDIR) {
+			k = vntaken(x->type, x->sym);
+		} else
+		if(x->type == D_AUTO || x->type == D_PARAM) {
+			if(x->type == a->type)
+				k = a->index != D_NONE || x->index != D_NONE ||
+					overlap(x->offset, x->width, a->offset, w);
+		} else
+		if(x->type == D_EXTERN || x->type == D_STATIC) {
+			if(x->type == a->type && x->sym == a->sym)
+				k = a->index != D_NONE || x->index != D_NONE ||
+					overlap(x->offset, x->width, a->offset, w);
+		} else {
+			/* through a pointer */
+			k = vntaken(a->type, a->sym);
+		}
+		if(k) {
+			*x = *--e;
+			x--;
+		}
+	}
+	cur.nexpr = e - cur.expr;
+}
+
+/*
+ * describe the source operand a in e.
+ * returns 0 if it cannot be described,
+ * 2 for memory, 1 otherwise.
+ */
+static int
+vnsrc(Adr *a, Vexpr *e)
+{
+	int i, t;
+
+	t = a->type;
+	e->type = t;
+	e->index = D_NONE;
+	e->scale = 0;
+	e->sym = a->sym;
+	e->offset = a->offset;
+	e->v1 = 0;
+	e->v2 = 0;
+	switch(t) {
+	case D_NONE:
+	case D_CONST:
+		return 1;
+
+	case D_ADDR:
+		switch(a->index) {
+		case D_EXTERN:
+		case D_STATIC:
+		case D_AUTO:
+		case D_PARAM:
+			e->index = a->index;
+			return 1;
+		}
+		return 0;
+
+	case D_EXTERN:
+	case D_STATIC:
+	case D_AUTO:
+	case D_PARAM:
+		break;
+
+	default:
+		if(t >= D_INDIR+D_AX && t <= D_INDIR+D_R15) {
+			e->v1 = cur.reg[t-D_INDIR-D_AX];
+			break;
+		}
+		i = vnreg(t);
+		if(i < 0)
+			return 0;
+		if(t >= D_AX && t <= D_R15)
+			e->type = D_AX;
+		if(t >= D_X0 && t <= D_X0+15)
+			e->type = D_X0;
+		e->sym = S;
+		e->offset = 0;
+		e->v1 = cur.reg[i];
+		return 1;
+	}
+
+	if(a->index != D_NONE) {
+		if(a->index < D_AX || a->index > D_R15)
+			return 0;
+		e->index = D_AX;
+		e->scale = a->scale;
+		e->v2 = cur.reg[a->index-D_AX];
+	}
+	return 2;
+}
+
+static Vexpr*
+vnfind(Vexpr *e)
+{
+	Vexpr *x, *ex;
+
+	ex = cur.expr + cur.nexpr;
+	for(x=cur.expr; x<ex; x++)
+		if(x->as == e->as && x->type == e->type &&
+		   x->index == e->index && x->scale == e->scale &&
+		   x->sym == e->sym && x->offset == e->offset &&
+		   x->v0 == e->v0 && x->v1 == e->v1 && x->v2 == e->v2)
+			return x;
+	return nil;
+}
+
+/*
+ * can the condition codes set
+ * by p be thrown away?
+ */
+static int
+flagsdead(Prog *p)
+{
+	for(p=p->link; p!=P; p=p->link) {
+		switch(p->as) {
+		case ANOP:
+		case AMOVL:
+		case AMOVQ:
+		case AMOVSS:
+		case AMOVSD:
+		case ALEAL:
+		case ALEAQ:
+			continue;
+
+		case ACMPB:
+		case ACMPW:
+		case ACMPL:
+		case ACMPQ:
+		case ATESTB:
+		case ATESTW:
+		case ATESTL:
+		case ATESTQ:
+		case ACOMISD:
+		case ACOMISS:
+		case AUCOMISD:
+		case AUCOMISS:
+		case AADDL:
+		case AADDQ:
+		case ASUBL:
+		case ASUBQ:
+		case AANDL:
+		case AANDQ:
+		case AORL:
+		case AORQ:
+		case AXORL:
+		case AXORQ:
+		case ACALL:
+		case ARET:
+			return 1;
+		}
+		return 0;
+	}
+	return 0;
+}
+
+/*
+ * r sets register d to v; if that is
+ * what d held before the chain of writes
+ * leading up to r, delete them all.
+ */
+static int
+vnchain(Reg *r, int d, int32 v)
+{
+	Vchain *c;
+	int i;
+
+	c = &chain[d];
+	if(c->n == 0 || c->before != v)
+		return 0;
+	for(i=0; i<c->n; i++) {
+		if(debug['P'] && debug['v'])
+			print("%P ===cse===\n", c->r[i]->prog);
+		excise(c->r[i]);
+	}
+	if(debug['P'] && debug['v'])
+		print("%P ===cse===\n", r->prog);
+	excise(r);
+	ostats.ncse += c->n + 1;
+	vnset(d, v);
+	return 1;
+}
+
+/*
+ * r, which cannot fault, sets register d to v.
+ */
+static void
+vnappend(Reg *r, int d, int32 v)
+{
+	Vchain *c;
+
+	c = &chain[d];
+	if(c->n == 0)
+		c->before = cur.reg[d];
+	if(c->n >= NCHAIN || uniqp(r) == R) {
+		vnset(d, v);
+		return;
+	}
+	c->r[c->n++] = r;
+	cur.reg[d] = v;
+	vnlast = d;
+}
+
+/*
+ * r computes e into register d.
+ * flags is set if r sets the condition
+ * codes, load if it reads memory.
+ */
+static void
+vncompute(Reg *r, int d, Vexpr *e, int flags, int load)
+{
+	Prog *p;
+	Vexpr *x;
+	int i, lo;
+
+	p = r->prog;
+	x = vnfind(e);
+	if(x == nil) {
+		if(cur.nexpr >= NVEXPR)
+			cur.nexpr--;
+		e->val = ++nval;
+		cur.expr[cur.nexpr++] = *e;
+		if(flags || load)
+			vnset(d, e->val);
+		else
+			vnappend(r, d, e->val);
+		return;
+	}
+
+	if(flags && !flagsdead(p)) {
+		vnset(d, x->val);
+		return;
+	}
+	if(cur.reg[d] == x->val) {
+		if(debug['P'] && debug['v'])
+			print("%P ===cse===\n", p);
+		excise(r);
+		ostats.ncse++;
+		return;
+	}
+	if(!flags && vnchain(r, d, x->val))
+		return;
+	lo = 0;
+	if(d >= 16)
+		lo = 16;
+	for(i=lo; i<lo+16; i++) {
+		if(i == d || cur.reg[i] != x->val)
+			continue;
+		if(debug['P'] && debug['v'])
+			print("%P ===cse=== ", p);
+		p->as = AMOVQ;
+		if(lo)
+			p->as = AMOVSD;
+		p->from = zprog.from;
+		p->from.type = D_AX + i;
+		if(lo)
+			p->from.type = D_X0 + i - lo;
+		if(debug['P'] && debug['v'])
+			print("%P\n", p);
+		ostats.ncse++;
+		flags = 0;
+		break;
+	}
+	if(flags)
+		vnset(d, x->val);
+	else
+		vnappend(r, d, x->val);
+}
+
+static void
+vnprog(Reg *r)
+{
+	Prog *p;
+	Vexpr e;
+	int d, k, t;
+
+	p = r->prog;
+	memset(&e, 0, sizeof e);
+	e.as = p->as;
+	switch(p->as) {
+	default:
+		vnreset();
+		return;
+
+	case ANOP:
+	case AJMP:
+	case AJCC:
+	case AJCS:
+	case AJEQ:
+	case AJGE:
+	case AJGT:
+	case AJHI:
+	case AJLE:
+	case AJLS:
+	case AJLT:
+	case AJMI:
+	case AJNE:
+	case AJOC:
+	case AJOS:
+	case AJPC:
+	case AJPL:
+	case AJPS:
+	case ARET:
+	case ACMPB:
+	case ACMPW:
+	case ACMPL:
+	case ACMPQ:
+	case ATESTB:
+	case ATESTW:
+	case ATESTL:
+	case ATESTQ:
+	case ACOMISD:
+	case ACOMISS:
+	case AUCOMISD:
+	case AUCOMISS:
+		return;
+
+	case ACALL:
+		for(d=0; d<NVREG; d++)
+			vnkill(d);
+		vnstore(A, 0);
+		return;
+
+	case AIMULL:
+	case AIMULQ:
+		if(p->to.type != D_NONE)
+			goto arith;
+	case AMULL:
+	case AMULQ:
+	case ADIVL:
+	case ADIVQ:
+	case AIDIVL:
+	case AIDIVQ:
+	case ACDQ:
+	case ACQO:
+		vnkill(D_AX-D_AX);
+		vnkill(D_DX-D_AX);
+		return;
+
+	case AMOVB:
+	case AMOVW:
+	case AADDB:
+	case AADDW:
+	case ASUBB:
+	case ASUBW:
+	case AANDB:
+	case AANDW:
+	case AORB:
+	case AORW:
+	case AXORB:
+	case AXORW:
+	case ASETCC:
+	case ASETCS:
+	case ASETEQ:
+	case ASETGE:
+	case ASETGT:
+	case ASETHI:
+	case ASETLE:
+	case ASETLS:
+	case ASETLT:
+	case ASETMI:
+	case ASETNE:
+	case ASETOC:
+	case ASETOS:
+	case ASETPC:
+	case ASETPL:
+	case ASETPS:
+		/* partial register write */
+		break;
+
+	case AMOVL:
+	case AMOVQ:
+	case AMOVBLSX:
+	case AMOVBLZX:
+	case AMOVBQSX:
+	case AMOVBQZX:
+	case AMOVLQSX:
+	case AMOVLQZX:
+	case AMOVWLSX:
+	case AMOVWLZX:
+	case AMOVWQSX:
+	case AMOVWQZX:
+	case AMOVSS:
+	case AMOVSD:
+	case ACVTSD2SL:
+	case ACVTSD2SQ:
+	case ACVTSD2SS:
+	case ACVTSL2SD:
+	case ACVTSL2SS:
+	case ACVTSQ2SD:
+	case ACVTSQ2SS:
+	case ACVTSS2SD:
+	case ACVTSS2SL:
+	case ACVTSS2SQ:
+	case ACVTTSD2SL:
+	case ACVTTSD2SQ:
+	case ACVTTSS2SL:
+	case ACVTTSS2SQ:
+	case ALEAL:
+	case ALEAQ:
+		t = p->to.type;
+		if(!(t >= D_AX && t <= D_R15) && !(t >= D_X0 && t <= D_X0+15))
+			break;
+		d = vnreg(t);
+		k = vnsrc(&p->from, &e);
+		if(k == 0) {
+			vnkill(d);
+			return;
+		}
+		if(p->as == ALEAL || p->as == ALEAQ) {
+			if(k != 2) {
+				vnkill(d);
+				return;
+			}
+		} else
+		if(k == 2)
+			e.width = vnwidth(p->as);
+
+		/* copy */
+		if(k == 1 && (p->as == AMOVQ && e.type == D_AX && d < 16 ||
+		   (p->as == AMOVSD || p->as == AMOVSS) && e.type == D_X0 && d >= 16)) {
+			if(!vnchain(r, d, e.v1))
+				vnappend(r, d, e.v1);
+			return;
+		}
+		vncompute(r, d, &e, 0, k == 2);
+		return;
+
+	case AADDL:
+	case AADDQ:
+	case ASUBL:
+	case ASUBQ:
+	case AANDL:
+	case AANDQ:
+	case AORL:
+	case AORQ:
+	case AXORL:
+	case AXORQ:
+	case AINCL:
+	case AINCQ:
+	case ADECL:
+	case ADECQ:
+	case ANEGL:
+	case ANEGQ:
+	case ANOTL:
+	case ANOTQ:
+	case ASHLL:
+	case ASHLQ:
+	case ASHRL:
+	case ASHRQ:
+	case ASARL:
+	case ASARQ:
+	case AADDSD:
+	case AADDSS:
+	case ASUBSD:
+	case ASUBSS:
+	case AMULSD:
+	case AMULSS:
+	case ADIVSD:
+	case ADIVSS:
+	arith:
+		t = p->to.type;
+		if(!(t >= D_AX && t <= D_R15) && !(t >= D_X0 && t <= D_X0+15))
+			break;
+		d = vnreg(t);
+		if(vnsrc(&p->from, &e) != 1) {
+			vnkill(d);
+			return;
+		}
+		e.v0 = cur.reg[d];
+		switch(p->as) {
+		case AADDL:
+		case AADDQ:
+		case AANDL:
+		case AANDQ:
+		case AORL:
+		case AORQ:
+		case AXORL:
+		case AXORQ:
+		case AIMULL:
+		case AIMULQ:
+		case AADDSD:
+		case AADDSS:
+		case AMULSD:
+		case AMULSS:
+			/* commutative */
+			if((e.type == D_AX || e.type == D_X0) && e.v1 < e.v0) {
+				k = e.v0;
+				e.v0 = e.v1;
+				e.v1 = k;
+			}
+		}
+		vncompute(r, d, &e, d < 16, 0);
+		return;
+	}
+
+	/*
+	 * everything left writes only p->to
+	 */
+	t = p->to.type;
+	if(ismem(t)) {
+		vnstore(&p->to, vnwidth(p->as));
+		return;
+	}
+	d = vnreg(t);
+	if(d < 0) {
+		vnreset();
+		return;
+	}
+	vnkill(d);
+}
+
+/*
+ * a chain is broken when anything
+ * else reads its register.
+ */
+static void
+vnreads(Reg *r)
+{
+	Adr v;
+	int i;
+
+	v = zprog.from;
+	for(i=0; i<NVREG; i++) {
+		if(chain[i].n == 0 || i == vnlast)
+			continue;
+		v.type = D_AX + i;
+		if(i >= 16)
+			v.type = D_X0 + i - 16;
+		switch(copyu(r->prog, &v, A)) {
+		case 1:
+		case 2:
+		case 4:
+			chain[i].n = 0;
+		}
+	}
+}
+
+void
+cse(void)
+{
+	Reg *r, *r1, *prev;
+	Vsave *v, **lv;
+	int i;
+
+	vntakenscan();
+	saved = nil;
+	prev = R;
+	for(r=firstr; r!=R; r=r->link)
+		r->active = 0;
+	for(r=firstr; r!=R; r=r->link) {
+		r1 = uniqp(r);
+		if(r1 == R || r1 != prev) {
+			vnreset();
+			if(r1 != R)
+			for(lv=&saved; (v=*lv) != nil; lv=&v->link) {
+				if(v->r == r) {
+					cur = v->s;
+					*lv = v->link;
+					v->link = freesave;
+					freesave = v;
+					break;
+				}
+			}
+		}
+		r->active = 1;
+		vnlast = -1;
+		vnprog(r);
+		vnreads(r);
+
+		r1 = r->s2;
+		if(r1 != R)
+			for(i=0; i<NVREG; i++)
+				chain[i].n = 0;
+		if(r1 != R && !r1->active && uniqp(r1) == r) {
+			v = freesave;
+			if(v != nil)
+				freesave = v->link;
+			else
+				v = mal(sizeof(*v));
+			v->r = r1;
+			v->s = cur;
+			v->link = saved;
+			saved = v;
+		}
+		prev = r;
+	}
+	while(saved != nil) {
+		v = saved;
+		saved = v->link;
+		v->link = freesave;
+		freesave = v;
+	}
+}
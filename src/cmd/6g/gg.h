@@ -41,6 +41,12 @@ struct	Prog
 	Addr	to;		// dst address
 	Prog*	link;		// next instruction in this func
 	void*	reg;		// pointer to containing Reg struct
+	uint32	regused;	// registers live across it (register calls)
+};
+
+enum
+{
+	MaxInlineSSE	= 128,	// largest fat copy or clear done with inline MOVOU
 };
 
 EXTERN	Biobuf*	bout;
@@ -81,6 +87,7 @@ void	genconv(Type*, Type*);
 void	allocparams(void);
 void	checklabels();
 void	ginscall(Node*, int);
+void	regcallspill(Node*);
 int	gen_as_init(Node*);
 
 /*
@@ -91,6 +98,7 @@ void	igen(Node*, Node*, Node*);
 vlong	fieldoffset(Type*, Node*);
 void	bgen(Node*, int, Prog*);
 void	sgen(Node*, Node*, int32);
+void	ssecopy(int, int, int32, Node*);
 void	gmove(Node*, Node*);
 Prog*	gins(int, Node*, Node*);
 int	samaddr(Node*, Node*);
@@ -9,6 +9,10 @@
 
 static Prog *pret;
 
+static void	regcallentry(void);
+static void	regcallret(void);
+static int	regcallretexpr(NodeList*);
+
 void
 compile(Node *fn)
 {
@@ -69,6 +73,7 @@ compile(Node *fn)
 	afunclit(&ptxt->from);
 
 	ginit();
+	regcallentry();
 	genlist(curfn->enter);
 
 	pret = nil;
@@ -98,6 +103,8 @@ compile(Node *fn)
 		ginscall(deferreturn, 0);
 	if(curfn->exit)
 		genlist(curfn->exit);
+	if(pret)
+		regcallret();
 	gclean();
 	if(nerrors != 0)
 		goto ret;
@@ -106,6 +113,7 @@ compile(Node *fn)
 
 	if(!debug['N'] || debug['R'] || debug['P']) {
 		regopt(ptxt);
+		stackopt(ptxt);
 	}
 
 	// fill in argument size
@@ -122,6 +130,291 @@ ret:
 	lineno = lno;
 }
 
+/*
+ * register convention for direct calls to the
+ * functions gc marked regcall (see gc/regcall.c):
+ * up to six integer or pointer arguments in R8-R13,
+ * up to four floating point arguments in X8-X11,
+ * and at most one result, in AX or X0.
+ * the arguments keep their stack slots, which the
+ * callee uses as their home.  none of these registers
+ * is touched by the stack split prologue, and
+ * morestack and lessstack in runtime/amd64/asm.s
+ * save and restore them.
+ */
+static	int	regint[] = { D_R8, D_R9, D_R10, D_R11, D_R12, D_R13 };
+static	int	regflt[] = { D_X0+8, D_X0+9, D_X0+10, D_X0+11 };
+
+enum
+{
+	Nregarg	= nelem(regint) + nelem(regflt),
+};
+
+/*
+ * 1 if t fits an integer register,
+ * 2 if it fits a floating point one.
+ */
+static int
+regclass(Type *t)
+{
+	int et;
+
+	et = simtype[t->etype];
+	if(isint[et] || isptr[et] || et == TBOOL)
+		return 1;
+	if(isfloat[et])
+		return 2;
+	return 0;
+}
+
+/*
+ * assign registers to the arguments and result
+ * of a function of type t; *rres is D_NONE if
+ * there is no result.  0 if t does not fit.
+ */
+static int
+regcallsig(Type *t, int *rarg, int *rres)
+{
+	Type *f;
+	Iter save;
+	int i, ni, nf;
+
+	if(t->thistuple > 0 || t->outtuple > 1)
+		return 0;
+	i = 0;
+	ni = 0;
+	nf = 0;
+	for(f=structfirst(&save, getinarg(t)); f!=T; f=structnext(&save)) {
+		switch(regclass(f->type)) {
+		default:
+			return 0;
+		case 1:
+			if(ni >= nelem(regint))
+				return 0;
+			rarg[i++] = regint[ni++];
+			break;
+		case 2:
+			if(nf >= nelem(regflt))
+				return 0;
+			rarg[i++] = regflt[nf++];
+			break;
+		}
+	}
+	*rres = D_NONE;
+	f = structfirst(&save, getoutarg(t));
+	if(f != T) {
+		switch(regclass(f->type)) {
+		default:
+			return 0;
+		case 1:
+			*rres = D_AX;
+			break;
+		case 2:
+			*rres = D_X0;
+			break;
+		}
+	}
+	return 1;
+}
+
+/*
+ * does a direct call of f use the registers?
+ */
+static int
+regcallto(Node *f, int *rarg, int *rres)
+{
+	if(f->op != ONAME || f->class != PFUNC || !f->regcall)
+		return 0;
+	return regcallsig(f->type, rarg, rres);
+}
+
+static uint32
+regcallbit(int r)
+{
+	if(r >= D_X0 && r <= D_X0+15)
+		return FtoB(r);
+	return RtoB(r);
+}
+
+/*
+ * the registers in mask must survive from p
+ * up to the end of the code; keep regopt
+ * from putting variables in them.
+ */
+static void
+regkeep(Prog *p, uint32 mask)
+{
+	for(; p != pc; p = p->link)
+		p->regused |= mask;
+}
+
+static void
+regcallentry(void)
+{
+	Type *f;
+	Iter save;
+	Node r, a;
+	int i, rarg[Nregarg], rres;
+	uint32 mask;
+	Prog *p0;
+
+	if(!regcallto(curfn->nname, rarg, &rres))
+		return;
+
+	p0 = pc;
+	mask = 0;
+	i = 0;
+	for(f=structfirst(&save, getinarg(curfn->type)); f!=T; f=structnext(&save), i++) {
+		mask |= regcallbit(rarg[i]);
+		if(f->nname == N || isblank(f->nname))
+			continue;
+		nodreg(&r, f->type, rarg[i]);
+		a = *nodarg(f, 1);
+		gmove(&r, &a);
+	}
+	regkeep(p0, mask);
+}
+
+/*
+ * load the result register before RET.
+ */
+static void
+regcallret(void)
+{
+	Type *f;
+	Iter save;
+	Node r, a;
+	int rarg[Nregarg], rres;
+
+	if(!regcallto(curfn->nname, rarg, &rres) || rres == D_NONE)
+		return;
+	f = structfirst(&save, getoutarg(curfn->type));
+	nodreg(&r, f->type, rres);
+	a = *nodarg(f, 1);
+	gmove(&a, &r);
+}
+
+/*
+ * return x: with nothing to run on the way out
+ * and no one to read the result slot, x can go
+ * straight to the result register.
+ */
+static int
+regcallretexpr(NodeList *l)
+{
+	Node r;
+	int rarg[Nregarg], rres;
+
+	if(!regcallto(curfn->nname, rarg, &rres) || rres == D_NONE)
+		return 0;
+	if(l == nil || l->next != nil || l->n->op != OAS || l->n->right == N)
+		return 0;
+	nodreg(&r, l->n->left->type, rres);
+	reg[rres]++;
+	cgen(l->n->right, &r);
+	reg[rres]--;
+	return 1;
+}
+
+/*
+ * the argument in list for the slot at offset o.
+ */
+static Node*
+regcallarg(NodeList *l, vlong o)
+{
+	Node *a;
+
+	for(; l; l=l->next) {
+		a = l->n;
+		if(a->op == OAS && a->left->op == OINDREG && a->left->xoffset == o &&
+		   a->left->type->etype != TSTRUCT)
+			return a->right;
+	}
+	return N;
+}
+
+/*
+ * call n, a direct call of a regcall function.
+ */
+static void
+cgen_regcall(Node *n, int *rarg)
+{
+	NodeList *l;
+	Node *a, *tmp, r, slot;
+	Type *f;
+	Iter save;
+	Prog *p, *p0;
+	int i;
+	uint32 mask;
+
+	// other calls among the arguments go first,
+	// into temporaries, and so does anything
+	// that is not a plain register argument.
+	for(l=n->list; l; l=l->next) {
+		a = l->n;
+		if(a->op != OAS || a->left->op != OINDREG || a->left->type->etype == TSTRUCT) {
+			gen(a);
+			continue;
+		}
+		if(a->right->ullman >= UINF) {
+			tmp = nod(OXXX, N, N);
+			tempname(tmp, a->right->type);
+			cgen(a->right, tmp);
+			a->right = tmp;
+		}
+	}
+
+	p0 = pc;
+	mask = 0;
+	i = 0;
+	for(f=structfirst(&save, getinarg(n->left->type)); f!=T; f=structnext(&save), i++) {
+		// regalloc never hands out X8 and up.
+		if(rarg[i] < D_X0 && reg[rarg[i]] != 0)
+			fatal("cgen_regcall: %R in use", rarg[i]);
+		reg[rarg[i]]++;
+		mask |= regcallbit(rarg[i]);
+		nodreg(&r, f->type, rarg[i]);
+		a = regcallarg(n->list, f->width);
+		if(a == N) {
+			// f(g()) with several results:
+			// they are already in the slots.
+			slot = *nodarg(f, 0);
+			a = &slot;
+		}
+		cgen(a, &r);
+	}
+
+	n->left->method = 1;
+	p = gins(ACALL, N, n->left);
+	afunclit(&p->to);
+	regkeep(p0, mask);
+
+	i = 0;
+	for(f=structfirst(&save, getinarg(n->left->type)); f!=T; f=structnext(&save), i++)
+		reg[rarg[i]]--;
+}
+
+/*
+ * a regcall returns its result in a register;
+ * store it in the result slot for those that
+ * want it in memory.
+ */
+void
+regcallspill(Node *n)
+{
+	Type *fp;
+	Iter flist;
+	Node r, a;
+	int rarg[Nregarg], rres;
+
+	if(!regcallto(n->left, rarg, &rres) || rres == D_NONE)
+		return;
+	fp = structfirst(&flist, getoutarg(n->left->type));
+	nodreg(&r, fp->type, rres);
+	a = *nodarg(fp, 0);
+	gmove(&r, &a);
+}
+
 /*
  * generate:
  *	call f
@@ -234,6 +527,7 @@ cgen_call(Node *n, int proc)
 {
 	Type *t;
 	Node nod, afun;
+	int rarg[Nregarg], rres;
 
 	if(n == N)
 		return;
@@ -245,8 +539,14 @@ cgen_call(Node *n, int proc)
 		cgen(n->left, &afun);
 	}
 
-	genlist(n->list);		// assign the args
 	t = n->left->type;
+	if(proc == 0 && regcallto(n->left, rarg, &rres)) {
+		setmaxarg(t);
+		cgen_regcall(n, rarg);
+		return;
+	}
+
+	genlist(n->list);		// assign the args
 
 	setmaxarg(t);
 
@@ -290,6 +590,8 @@ cgen_callret(Node *n, Node *res)
 	Node nod;
 	Type *fp, *t;
 	Iter flist;
+	Prog *p0;
+	int rarg[Nregarg], rres;
 
 	t = n->left->type;
 	if(t->etype == TPTR32 || t->etype == TPTR64)
@@ -299,6 +601,16 @@ cgen_callret(Node *n, Node *res)
 	if(fp == T)
 		fatal("cgen_callret: nil");
 
+	if(regcallto(n->left, rarg, &rres)) {
+		nodreg(&nod, fp->type, rres);
+		reg[rres]++;
+		p0 = pc;
+		cgen_as(res, &nod);
+		regkeep(p0, regcallbit(rres));
+		reg[rres]--;
+		return;
+	}
+
 	memset(&nod, 0, sizeof(nod));
 	nod.op = OINDREG;
 	nod.val.u.reg = D_SP;
@@ -328,6 +640,7 @@ cgen_aret(Node *n, Node *res)
 	fp = structfirst(&flist, getoutarg(t));
 	if(fp == T)
 		fatal("cgen_aret: nil");
+	regcallspill(n);
 
 	memset(&nod1, 0, sizeof(nod1));
 	nod1.op = OINDREG;
@@ -353,11 +666,16 @@ cgen_aret(Node *n, Node *res)
 void
 cgen_ret(Node *n)
 {
-	genlist(n->list);		// copy out args
-	if(hasdefer || curfn->exit)
+	if(hasdefer || curfn->exit) {
+		genlist(n->list);		// copy out args
 		gjmp(pret);
-	else
-		gins(ARET, N, N);
+		return;
+	}
+	if(!regcallretexpr(n->list)) {
+		genlist(n->list);		// copy out args
+		regcallret();
+	}
+	gins(ARET, N, N);
 }
 
 /*
@@ -1038,8 +1356,9 @@ cgen_bmul(int op, Node *nl, Node *nr, Node *res)
 void
 clearfat(Node *nl)
 {
-	uint32 w, c, q;
-	Node n1, oldn1, ax, oldax;
+	uint32 w, c, q, o;
+	Node n1, oldn1, ax, oldax, x, z, dst;
+	Type *t;
 
 	/* clear a fat object */
 	if(debug['g'])
@@ -1060,6 +1379,37 @@ clearfat(Node *nl)
 	savex(D_AX, &ax, &oldax, N, types[tptr]);
 	gconreg(AMOVQ, 0, D_AX);
 
+	if(w >= 16 && w <= MaxInlineSSE) {
+		// medium size: zero an SSE register and store
+		// it 16 bytes at a time, avoiding the startup
+		// cost of REP STOSQ.  finish the tail from AX.
+		regalloc(&x, types[TFLOAT64], N);
+		gins(APXOR, &x, &x);
+		for(o=0; o+16<=w; o+=16) {
+			nodindreg(&dst, types[TFLOAT64], D_DI);
+			dst.xoffset = o;
+			gins(AMOVOU, &x, &dst);
+		}
+		regfree(&x);
+		for(; o<w; o+=t->width) {
+			if(w-o >= 8)
+				t = types[TUINT64];
+			else if(w-o >= 4)
+				t = types[TUINT32];
+			else if(w-o >= 2)
+				t = types[TUINT16];
+			else
+				t = types[TUINT8];
+			nodreg(&z, t, D_AX);
+			nodindreg(&dst, t, D_DI);
+			dst.xoffset = o;
+			gins(optoas(OAS, t), &z, &dst);
+		}
+		restx(&n1, &oldn1);
+		restx(&ax, &oldax);
+		return;
+	}
+
 	if(q >= 4) {
 		gconreg(AMOVQ, q, D_CX);
 		gins(AREP, N, N);	// repeat
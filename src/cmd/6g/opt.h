@@ -119,6 +119,7 @@ EXTERN	struct
 	int32	ndelmov;
 	int32	nvar;
 	int32	naddr;
+	int32	ncse;
 } ostats;
 
 /*
@@ -128,6 +129,7 @@ Reg*	rega(void);
 int	rcmp(const void*, const void*);
 void	regopt(Prog*);
 void	addmove(Reg*, int, int, int);
+uint32	doregbits(int);
 Bits	mkvar(Reg*, Adr*);
 void	prop(Reg*, Bits, Bits);
 void	loopit(Reg*, int32);
@@ -164,3 +166,13 @@ int32	RtoB(int);
 int32	FtoB(int);
 int	BtoR(int32);
 int	BtoF(int32);
+
+/*
+ * cse.c
+ */
+void	cse(void);
+
+/*
+ * stack.c
+ */
+void	stackopt(Prog*);
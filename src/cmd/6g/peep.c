@@ -124,6 +124,11 @@ peep(void)
 		}
 	}
 
+	// remove recomputed values;
+	// copyprop below removes the
+	// moves that replace them
+	cse();
+
 	// constant propagation
 	// find MOV $con,R followed by
 	// another MOV $con,R without
@@ -637,6 +642,7 @@ copyu(Prog *p, Adr *v, Adr *s)
 
 	case AMOVSS:
 	case AMOVSD:
+	case AMOVOU:
 	case ACVTSD2SL:
 	case ACVTSD2SQ:
 	case ACVTSD2SS:
@@ -862,6 +868,8 @@ copyu(Prog *p, Adr *v, Adr *s)
 			return 2;
 		if(REGARG >= 0 && v->type == (uchar)REGARG)
 			return 2;
+		if(p->regused && (p->regused & doregbits(v->type)))
+			return 2;
 
 		if(s != A) {
 			if(copysub(&p->to, v, s, 1))
@@ -183,6 +183,7 @@ regopt(Prog *firstp)
 		}
 		r->prog = p;
 		p->reg = r;
+		r->regu |= p->regused;
 
 		r1 = r->p1;
 		if(r1 != R) {
@@ -272,6 +273,7 @@ regopt(Prog *firstp)
 
 		case AMOVSS:
 		case AMOVSD:
+		case AMOVOU:
 		case ACVTSD2SL:
 		case ACVTSD2SQ:
 		case ACVTSD2SS:
@@ -390,6 +392,7 @@ regopt(Prog *firstp)
 		case ASUBSD:
 		case ASUBSS:
 		case AXORPD:
+		case APXOR:
 			for(z=0; z<BITS; z++) {
 				r->set.b[z] |= bit.b[z];
 				r->use2.b[z] |= bit.b[z];
@@ -678,6 +681,7 @@ brk:
 		   ostats.ndelmov ||
 		   ostats.nvar ||
 		   ostats.naddr ||
+		   ostats.ncse ||
 		   0)
 			print("\nstats\n");
 
@@ -693,6 +697,8 @@ brk:
 			print("	%4d delmov\n", ostats.nvar);
 		if(ostats.naddr)
 			print("	%4d delmov\n", ostats.naddr);
+		if(ostats.ncse)
+			print("	%4d cse\n", ostats.ncse);
 
 		memset(&ostats, 0, sizeof(ostats));
 	}
@@ -0,0 +1,875 @@
+// Copyright 2011 The Go Authors.  All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include "gg.h"
+#include "opt.h"
+
+/*
+ * stack slot sharing.
+ *
+ * allocparams and tempname give every local
+ * and every temporary a slot of its own for
+ * the whole function (see gc/gen.c).  once the
+ * code is final, find where each slot is live
+ * and lay the frame out again, letting slots
+ * that are never live at the same time share
+ * memory.
+ *
+ * liveness is kept for each 8-byte piece of a
+ * slot, so that a value written a word at a
+ * time is dead above its first store.  the
+ * address of a slot is often loaded into a
+ * register for a block move or clear; those
+ * uses are followed until the register dies in
+ * its basic block.  a slot whose address goes
+ * anywhere else keeps memory of its own, and a
+ * slot that is never mentioned gets none.
+ */
+
+enum
+{
+	Piece	= 8,		// bytes of slot per liveness bit
+	Maxslot	= 10000,
+	Nreg	= D_R15-D_AX+1,
+};
+
+typedef	struct	Sblock	Sblock;
+typedef	struct	Sref	Sref;
+
+struct	Sblock
+{
+	int32	first;		// index of first instruction
+	int32	last;		// index of last instruction
+	Sblock*	s1;		// fall through
+	Sblock*	s2;		// branch target
+	uint32	rgen;		// registers read before set
+	uint32	rkill;		// registers set
+	uint32	rin;
+	uint32	rout;
+	uint32*	gen;		// pieces read before set
+	uint32*	kill;		// pieces set
+	uint32*	in;
+	uint32*	out;
+};
+
+struct	Sref
+{
+	int32	slot;
+	int32	lo;		// first piece
+	int32	hi;		// last piece + 1
+	uchar	set;		// pieces entirely overwritten
+};
+
+static	Prog**	code;		// instructions in order
+static	int32	ncode;
+static	Sblock*	blk;
+static	uint32*	rlive;		// registers live after each instruction
+static	int32*	piece;		// first piece of each slot
+static	int32*	pslot;		// slot of each piece
+static	int32	npiece;
+static	int	nword;		// words in a set of pieces
+static	int	cword;		// words in a set of slots
+static	uchar*	taken;		// address escapes
+static	uchar*	used;
+static	Sref*	ref;		// refs of code[i] are ref[rstart[i]:rstart[i+1]]
+static	int32*	rstart;
+static	int32	nref;
+static	uint32*	conflict;	// slots live at the same time
+static	int32	tslot[Nreg];	// slot whose address is in a register
+static	int32	toff[Nreg];	// offset of that address in the slot
+static	int	anystd;
+
+static	int32*	slotbuf;	// per slot and per bin arrays
+static	uint32*	bitbuf;		// block sets
+static	uint32*	binbuf;		// slots in each bin
+
+static	int32	mcode, mblk, mrlive, mpiece, mpslot, mtaken, mused;
+static	int32	mref, mrstart, mbits, mconflict, mslot, mbin;
+
+#define	BSET(b, i)	((b)[(i)>>5] |= 1U<<((i)&31))
+#define	BCLR(b, i)	((b)[(i)>>5] &= ~(1U<<((i)&31)))
+#define	BTST(b, i)	(((b)[(i)>>5]>>((i)&31)) & 1)
+
+/*
+ * scratch space, kept from one function to the next.
+ */
+static void*
+scratch(void *p, int32 *max, int32 n)
+{
+	if(n > *max) {
+		p = mal(n);
+		*max = n;
+	} else
+		memset(p, 0, n);
+	return p;
+}
+
+/*
+ * the slot holding frame offset o, or -1.
+ * slots are handed out at decreasing offsets.
+ */
+static int32
+lookslot(vlong o)
+{
+	int32 l, h, m;
+
+	l = 0;
+	h = nstkslot;
+	while(l < h) {
+		m = (l+h)/2;
+		if(stkslot[m].offset <= o)
+			h = m;
+		else
+			l = m+1;
+	}
+	if(l >= nstkslot || o >= stkslot[l].offset + stkslot[l].width)
+		return -1;
+	return l;
+}
+
+/*
+ * bytes touched by the memory operand
+ * of an instruction, or 0 if not known.
+ */
+static int
+opwidth(int as)
+{
+	switch(as) {
+	case AMOVB:
+	case AMOVBLSX:
+	case AMOVBLZX:
+	case AMOVBQSX:
+	case AMOVBQZX:
+	case AMOVBWSX:
+	case AMOVBWZX:
+	case AADDB:
+	case ASUBB:
+	case AANDB:
+	case AORB:
+	case AXORB:
+	case ACMPB:
+	case ATESTB:
+	case AINCB:
+	case ADECB:
+	case ANEGB:
+	case ANOTB:
+	case ASHLB:
+	case ASHRB:
+	case ASARB:
+		return 1;
+
+	case AMOVW:
+	case AMOVWLSX:
+	case AMOVWLZX:
+	case AMOVWQSX:
+	case AMOVWQZX:
+	case AADDW:
+	case ASUBW:
+	case AANDW:
+	case AORW:
+	case AXORW:
+	case ACMPW:
+	case ATESTW:
+	case AINCW:
+	case ADECW:
+	case ANEGW:
+	case ANOTW:
+	case ASHLW:
+	case ASHRW:
+	case ASARW:
+		return 2;
+
+	case AMOVL:
+	case AMOVLQSX:
+	case AMOVLQZX:
+	case AADDL:
+	case ASUBL:
+	case AANDL:
+	case AORL:
+	case AXORL:
+	case ACMPL:
+	case ATESTL:
+	case AINCL:
+	case ADECL:
+	case ANEGL:
+	case ANOTL:
+	case ASHLL:
+	case ASHRL:
+	case ASARL:
+	case AIMULL:
+	case AMOVSS:
+	case AADDSS:
+	case ASUBSS:
+	case AMULSS:
+	case ADIVSS:
+	case ACOMISS:
+	case AUCOMISS:
+	case ACVTSS2SD:
+	case ACVTSS2SL:
+	case ACVTSS2SQ:
+	case ACVTTSS2SL:
+	case ACVTTSS2SQ:
+	case ACVTSL2SD:
+	case ACVTSL2SS:
+		return 4;
+
+	case AMOVQ:
+	case AADDQ:
+	case ASUBQ:
+	case AANDQ:
+	case AORQ:
+	case AXORQ:
+	case ACMPQ:
+	case ATESTQ:
+	case AINCQ:
+	case ADECQ:
+	case ANEGQ:
+	case ANOTQ:
+	case ASHLQ:
+	case ASHRQ:
+	case ASARQ:
+	case AIMULQ:
+	case AMOVSD:
+	case AADDSD:
+	case ASUBSD:
+	case AMULSD:
+	case ADIVSD:
+	case ACOMISD:
+	case AUCOMISD:
+	case ACVTSD2SL:
+	case ACVTSD2SQ:
+	case ACVTSD2SS:
+	case ACVTTSD2SL:
+	case ACVTTSD2SQ:
+	case ACVTSQ2SD:
+	case ACVTSQ2SS:
+		return 8;
+
+	case AMOVOU:
+		return 16;
+	}
+	return 0;
+}
+
+/*
+ * does the instruction only write its destination?
+ */
+static int
+isstore(int as)
+{
+	switch(as) {
+	case AMOVB:
+	case AMOVW:
+	case AMOVL:
+	case AMOVQ:
+	case AMOVSS:
+	case AMOVSD:
+	case AMOVOU:
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * record a reference to bytes [o,o+w) of slot s;
+ * w == 0 means to the end of the slot.
+ * set means the bytes are overwritten.
+ */
+static void
+addref(int32 s, int32 o, int32 w, int set)
+{
+	Sref *r;
+	int32 width;
+
+	width = stkslot[s].width;
+	if(o < 0 || o >= width || o+w > width) {
+		// not where it should be; take all of it
+		o = 0;
+		w = 0;
+		set = 0;
+	}
+	if(w <= 0) {
+		w = width - o;
+		set = 0;
+	}
+	if(o%Piece != 0 || ((o+w)%Piece != 0 && o+w != width))
+		set = 0;
+
+	r = &ref[nref++];
+	r->slot = s;
+	r->lo = piece[s] + o/Piece;
+	r->hi = piece[s] + (o+w+Piece-1)/Piece;
+	r->set = set;
+	used[s] = 1;
+}
+
+/*
+ * a names a slot directly.
+ * returns -1 if the offset is not in a slot.
+ */
+static int
+direct(Prog *p, Addr *a, int store)
+{
+	int32 s, o;
+
+	if(a->type == D_ADDR && a->index == D_AUTO) {
+		s = lookslot(a->offset);
+		if(s < 0)
+			return -1;
+		taken[s] = 1;
+		return 0;
+	}
+	if(a->type != D_AUTO)
+		return 0;
+	s = lookslot(a->offset);
+	if(s < 0)
+		return -1;
+	if(p->as == ALEAQ || p->as == ALEAL)
+		return 0;	// see follow
+	o = a->offset - stkslot[s].offset;
+	if(a->index != D_NONE)
+		addref(s, 0, 0, 0);
+	else
+		addref(s, o, opwidth(p->as), store && isstore(p->as));
+	return 0;
+}
+
+/*
+ * the registers p reads and sets.
+ */
+static void
+regrefs(Prog *p, uint32 *use, uint32 *set)
+{
+	Adr v;
+	int r;
+
+	*use = 0;
+	*set = 0;
+	v = zprog.from;
+	for(r=0; r<Nreg; r++) {
+		v.type = D_AX+r;
+		switch(copyu(p, &v, A)) {
+		case 1:
+			*use |= 1<<r;
+			break;
+		case 2:
+		case 4:
+			*use |= 1<<r;
+			*set |= 1<<r;
+			break;
+		case 3:
+			*set |= 1<<r;
+			break;
+		}
+	}
+}
+
+/*
+ * code[i] runs with the address of slot tslot[r],
+ * plus toff[r], in register r.  record the bytes
+ * it touches through the address and return
+ * whether r still holds it afterward.  an address
+ * that goes anywhere else makes the slot taken.
+ */
+static int
+follow(int32 i, int r, int32 cx)
+{
+	Prog *p;
+	Adr v;
+	int reg, u, rep, w;
+	int32 s, o, n;
+
+	p = code[i];
+	reg = D_AX+r;
+	s = tslot[r];
+	o = toff[r];
+	v = zprog.from;
+	v.type = reg;
+	u = copyu(p, &v, A);
+	if(u == 0)
+		return 1;
+	if(u == 3)
+		return 0;
+
+	switch(p->as) {
+	case AMOVSB:
+	case AMOVSL:
+	case AMOVSQ:
+	case ASTOSB:
+	case ASTOSL:
+	case ASTOSQ:
+		if(reg != D_DI && reg != D_SI)
+			break;
+		if(reg == D_SI && (p->as == ASTOSB || p->as == ASTOSL || p->as == ASTOSQ))
+			break;
+		w = 8;
+		if(p->as == AMOVSB || p->as == ASTOSB)
+			w = 1;
+		if(p->as == AMOVSL || p->as == ASTOSL)
+			w = 4;
+		rep = i > 0 && code[i-1]->as == AREP;
+		n = 1;
+		if(rep)
+			n = cx;
+		if(o < 0 || n < 0 || anystd) {
+			addref(s, 0, 0, 0);
+			toff[r] = -1;
+		} else {
+			addref(s, o, n*w, reg == D_DI);
+			toff[r] = o + n*w;
+		}
+		return 1;
+
+	case AADDQ:
+	case ASUBQ:
+		if(p->to.type != reg || p->from.type != D_CONST)
+			break;
+		if(o >= 0) {
+			if(p->as == AADDQ)
+				toff[r] = o + p->from.offset;
+			else
+				toff[r] = o - p->from.offset;
+		}
+		return 1;
+
+	case ALEAQ:
+		if(p->from.type != D_INDIR+reg)
+			break;
+		if(p->to.type != reg || p->from.index != D_NONE)
+			goto escape;
+		if(o >= 0)
+			toff[r] = o + p->from.offset;
+		return 1;
+	}
+
+	if(p->as == ACALL || p->from.index == reg || p->to.index == reg)
+		goto escape;
+	if(p->as == ACMPQ || p->as == ATESTQ) {
+		// comparing the address is fine
+	} else if(p->from.type == reg) {
+		goto escape;
+	} else if(p->to.type == reg) {
+		if(u != 4)
+			goto escape;	// arithmetic on the address
+	} else if(p->from.type != D_INDIR+reg && p->to.type != D_INDIR+reg)
+		goto escape;	// implicit use: string op, call argument
+
+	if(p->from.type == D_INDIR+reg) {
+		if(p->from.index != D_NONE || o < 0)
+			addref(s, 0, 0, 0);
+		else
+			addref(s, o + p->from.offset, opwidth(p->as), 0);
+	}
+	if(p->to.type == D_INDIR+reg) {
+		if(p->to.index != D_NONE || o < 0)
+			addref(s, 0, 0, 0);
+		else
+			addref(s, o + p->to.offset, opwidth(p->as), isstore(p->as));
+	}
+	return p->to.type != reg || u != 4;
+
+escape:
+	taken[s] = 1;
+	return 0;
+}
+
+/*
+ * collect the slot references of the block,
+ * following addresses loaded into registers.
+ * returns -1 if the code uses the frame
+ * in a way not understood.
+ */
+static int
+blockrefs(Sblock *b)
+{
+	Prog *p;
+	int32 i, s, cx;
+	uint32 use, set;
+	int r;
+
+	for(r=0; r<Nreg; r++)
+		tslot[r] = -1;
+	cx = -1;
+	for(i=b->first; i<=b->last; i++) {
+		p = code[i];
+		rstart[i] = nref;
+		if(direct(p, &p->from, 0) < 0 || direct(p, &p->to, 1) < 0)
+			return -1;
+		for(r=0; r<Nreg; r++)
+			if(tslot[r] >= 0 && !follow(i, r, cx))
+				tslot[r] = -1;
+
+		if((p->as == ALEAQ || p->as == ALEAL) && p->from.type == D_AUTO) {
+			s = lookslot(p->from.offset);
+			if(s < 0)
+				return -1;
+			if(p->as != ALEAQ || !isregtype(p->to.type)) {
+				taken[s] = 1;
+			} else {
+				r = p->to.type - D_AX;
+				tslot[r] = s;
+				used[s] = 1;
+				toff[r] = -1;
+				if(p->from.index == D_NONE)
+					toff[r] = p->from.offset - stkslot[s].offset;
+			}
+		}
+
+		// the count for a following REP
+		if(p->as != AREP) {
+			regrefs(p, &use, &set);
+			if((p->as == AMOVQ || p->as == AMOVL) && p->to.type == D_CX && p->from.type == D_CONST)
+				cx = p->from.offset;
+			else if((set & (1<<(D_CX-D_AX))) || (i > 0 && code[i-1]->as == AREP))
+				cx = -1;
+		}
+
+		for(r=0; r<Nreg; r++)
+			if(tslot[r] >= 0 && !(rlive[i] & (1<<r)))
+				tslot[r] = -1;
+	}
+	rstart[i] = nref;
+
+	// still holding an address at the end of the block
+	for(r=0; r<Nreg; r++)
+		if(tslot[r] >= 0)
+			taken[tslot[r]] = 1;
+	return 0;
+}
+
+/*
+ * add the slots with a piece in live to the set s.
+ */
+static void
+liveslots(uint32 *live, uint32 *s)
+{
+	int32 i, k;
+	uint32 w;
+
+	for(i=0; i<nword; i++) {
+		w = live[i];
+		for(k=i*32; w; k++, w>>=1)
+			if(w & 1)
+				BSET(s, pslot[k]);
+	}
+}
+
+/*
+ * the slots in s conflict with slot t.
+ */
+static void
+addconflict(uint32 *s, int32 t)
+{
+	uint32 *row, w;
+	int32 i, k;
+
+	row = conflict + t*cword;
+	for(i=0; i<cword; i++) {
+		w = s[i];
+		row[i] |= w;
+		for(k=i*32; w; k++, w>>=1)
+			if(w & 1)
+				BSET(conflict + k*cword, t);
+	}
+}
+
+static int
+slotcmp(const void *a1, const void *a2)
+{
+	Stkslot *s1, *s2;
+
+	s1 = &stkslot[*(int32*)a1];
+	s2 = &stkslot[*(int32*)a2];
+	if(s1->width != s2->width)
+		return s2->width - s1->width;
+	return *(int32*)a1 - *(int32*)a2;
+}
+
+void
+stackopt(Prog *firstp)
+{
+	Prog *p;
+	Sblock *b;
+	Addr *a;
+	int32 i, j, k, m, ns, nb, nbin, size, s;
+	int32 *order, *bin, *binw, *binoff, *newoff;
+	uchar *binalign;
+	uint32 *bits, *live, *slive, *binset, use, set, w;
+	int change;
+
+	ns = nstkslot;
+	if(ns == 0 || ns > Maxslot)
+		return;
+
+	/*
+	 * pieces of each slot
+	 */
+	piece = scratch(piece, &mpiece, (ns+1)*sizeof(piece[0]));
+	npiece = 0;
+	for(s=0; s<ns; s++) {
+		piece[s] = npiece;
+		npiece += (stkslot[s].width + Piece-1) / Piece;
+	}
+	piece[ns] = npiece;
+	pslot = scratch(pslot, &mpslot, (npiece+1)*sizeof(pslot[0]));
+	for(s=0; s<ns; s++)
+		for(k=piece[s]; k<piece[s+1]; k++)
+			pslot[k] = s;
+	nword = (npiece+31)/32;
+	cword = (ns+31)/32;
+	taken = scratch(taken, &mtaken, ns);
+	used = scratch(used, &mused, ns);
+
+	/*
+	 * basic blocks; a leader is marked
+	 * by pointing its reg at firstp.
+	 */
+	ncode = 0;
+	anystd = 0;
+	for(p=firstp; p!=P; p=p->link) {
+		p->reg = nil;
+		ncode++;
+	}
+	for(p=firstp; p!=P; p=p->link) {
+		if(p->as == ASTD)
+			anystd = 1;
+		if(p->to.type == D_BRANCH) {
+			if(p->to.branch == P)
+				return;
+			p->to.branch->reg = firstp;
+		}
+		if(p->link != P)
+		if(p->to.type == D_BRANCH || p->as == AJMP || p->as == ARET)
+			p->link->reg = firstp;
+	}
+	code = scratch(code, &mcode, ncode*sizeof(code[0]));
+	nb = 0;
+	i = 0;
+	for(p=firstp; p!=P; p=p->link) {
+		if(p == firstp || p->reg != nil)
+			nb++;
+		code[i++] = p;
+	}
+	blk = scratch(blk, &mblk, nb*sizeof(blk[0]));
+	b = nil;
+	for(i=0; i<ncode; i++) {
+		p = code[i];
+		if(i == 0 || p->reg != nil) {
+			b = (b == nil)? blk: b+1;
+			b->first = i;
+		}
+		b->last = i;
+		p->reg = b;
+	}
+	for(b=blk; b<blk+nb; b++) {
+		p = code[b->last];
+		if(p->as != AJMP && p->as != ARET && b+1 < blk+nb)
+			b->s1 = b+1;
+		if(p->to.type == D_BRANCH) {
+			b->s2 = p->to.branch->reg;
+			if(b->s2 < blk || b->s2 >= blk+nb)
+				goto out;	// branch out of the function
+		}
+	}
+
+	/*
+	 * registers live after each instruction
+	 */
+	for(b=blk; b<blk+nb; b++) {
+		for(i=b->first; i<=b->last; i++) {
+			regrefs(code[i], &use, &set);
+			b->rgen |= use & ~b->rkill;
+			b->rkill |= set;
+		}
+	}
+	do {
+		change = 0;
+		for(b=blk+nb-1; b>=blk; b--) {
+			w = 0;
+			if(b->s1)
+				w |= b->s1->rin;
+			if(b->s2)
+				w |= b->s2->rin;
+			b->rout = w;
+			w = b->rgen | (w & ~b->rkill);
+			if(w != b->rin) {
+				b->rin = w;
+				change = 1;
+			}
+		}
+	} while(change);
+	rlive = scratch(rlive, &mrlive, ncode*sizeof(rlive[0]));
+	for(b=blk; b<blk+nb; b++) {
+		w = b->rout;
+		for(i=b->last; i>=b->first; i--) {
+			rlive[i] = w;
+			regrefs(code[i], &use, &set);
+			w = (w & ~set) | use;
+		}
+	}
+
+	/*
+	 * slot references
+	 */
+	ref = scratch(ref, &mref, (4*ncode+4)*sizeof(ref[0]));
+	rstart = scratch(rstart, &mrstart, (ncode+1)*sizeof(rstart[0]));
+	nref = 0;
+	for(b=blk; b<blk+nb; b++)
+		if(blockrefs(b) < 0)
+			goto out;
+
+	/*
+	 * pieces live into and out of each block
+	 */
+	bitbuf = scratch(bitbuf, &mbits, (4*nb+1)*nword*sizeof(uint32));
+	bits = bitbuf;
+	for(b=blk; b<blk+nb; b++) {
+		b->gen = bits;
+		b->kill = bits + nword;
+		b->in = bits + 2*nword;
+		b->out = bits + 3*nword;
+		bits += 4*nword;
+		for(i=b->first; i<=b->last; i++) {
+			for(k=rstart[i]; k<rstart[i+1]; k++)
+				if(!ref[k].set)
+					for(j=ref[k].lo; j<ref[k].hi; j++)
+						if(!BTST(b->kill, j))
+							BSET(b->gen, j);
+			for(k=rstart[i]; k<rstart[i+1]; k++)
+				if(ref[k].set)
+					for(j=ref[k].lo; j<ref[k].hi; j++)
+						BSET(b->kill, j);
+		}
+	}
+	live = bits;
+	do {
+		change = 0;
+		for(b=blk+nb-1; b>=blk; b--) {
+			for(j=0; j<nword; j++) {
+				w = 0;
+				if(b->s1)
+					w |= b->s1->in[j];
+				if(b->s2)
+					w |= b->s2->in[j];
+				b->out[j] = w;
+				w = b->gen[j] | (w & ~b->kill[j]);
+				if(w != b->in[j]) {
+					b->in[j] = w;
+					change = 1;
+				}
+			}
+		}
+	} while(change);
+
+	/*
+	 * slots live at the same time conflict.
+	 * it is enough to look where each slot
+	 * is mentioned and at the function entry.
+	 */
+	conflict = scratch(conflict, &mconflict, (ns+1)*cword*sizeof(uint32));
+	slive = conflict + ns*cword;
+	for(b=blk; b<blk+nb; b++) {
+		memmove(live, b->out, nword*sizeof(uint32));
+		for(i=b->last; i>=b->first; i--) {
+			if(rstart[i] == rstart[i+1])
+				continue;
+			memset(slive, 0, cword*sizeof(uint32));
+			liveslots(live, slive);
+			for(k=rstart[i]; k<rstart[i+1]; k++)
+				if(ref[k].set)
+					for(j=ref[k].lo; j<ref[k].hi; j++)
+						BCLR(live, j);
+			for(k=rstart[i]; k<rstart[i+1]; k++)
+				if(!ref[k].set)
+					for(j=ref[k].lo; j<ref[k].hi; j++)
+						BSET(live, j);
+			liveslots(live, slive);
+			for(k=rstart[i]; k<rstart[i+1]; k++)
+				addconflict(slive, ref[k].slot);
+		}
+	}
+	memset(slive, 0, cword*sizeof(uint32));
+	liveslots(blk->in, slive);
+	for(s=0; s<ns; s++)
+		if(BTST(slive, s))
+			addconflict(slive, s);
+
+	/*
+	 * place the biggest slots first, each in the first
+	 * bin it fits without conflict.  taken slots keep
+	 * their own memory; unused slots get none.
+	 */
+	slotbuf = scratch(slotbuf, &mslot, 6*ns*sizeof(int32));
+	order = slotbuf;
+	bin = order + ns;
+	newoff = bin + ns;
+	binw = newoff + ns;
+	binoff = binw + ns;
+	binalign = (uchar*)(binoff + ns);
+	binbuf = scratch(binbuf, &mbin, ns*cword*sizeof(uint32));
+	k = 0;
+	for(s=0; s<ns; s++)
+		if(used[s] && !taken[s] && stkslot[s].width > 0)
+			order[k++] = s;
+	qsort(order, k, sizeof(order[0]), slotcmp);
+	nbin = 0;
+	for(i=0; i<k; i++) {
+		s = order[i];
+		for(j=0; j<nbin; j++) {
+			if(stkslot[s].width > binw[j] || stkslot[s].align > binalign[j])
+				continue;
+			binset = binbuf + j*cword;
+			for(m=0; m<cword; m++)
+				if(binset[m] & conflict[s*cword+m])
+					break;
+			if(m == cword)
+				break;
+		}
+		if(j == nbin) {
+			binw[j] = stkslot[s].width;
+			binalign[j] = stkslot[s].align;
+			nbin++;
+		}
+		BSET(binbuf + j*cword, s);
+		bin[s] = j;
+	}
+
+	size = 0;
+	for(s=0; s<ns; s++) {
+		if(!taken[s] || stkslot[s].width == 0)
+			continue;
+		size += stkslot[s].width;
+		size = rnd(size, stkslot[s].align);
+		newoff[s] = -size;
+	}
+	for(j=0; j<nbin; j++) {
+		size += binw[j];
+		size = rnd(size, binalign[j]);
+		binoff[j] = -size;
+	}
+	if(size >= stksize)
+		goto out;
+	for(i=0; i<k; i++) {
+		s = order[i];
+		newoff[s] = binoff[bin[s]];
+	}
+
+	for(p=firstp; p!=P; p=p->link) {
+		for(a=&p->from;; a=&p->to) {
+			if(a->type == D_AUTO || (a->type == D_ADDR && a->index == D_AUTO)) {
+				s = lookslot(a->offset);
+				a->offset += newoff[s] - stkslot[s].offset;
+			}
+			if(a == &p->to)
+				break;
+		}
+	}
+	if(debug['R'])
+		print("\n%S: stack %d shared into %d\n", curfn->nname->sym, stksize, size);
+	stksize = size;
+
+out:
+	for(p=firstp; p!=P; p=p->link)
+		p->reg = nil;
+}
@@ -41,10 +41,24 @@ Options new in this version:
 -L dir1 -L dir2
 	Search for libraries (package files) in dir1, dir2, etc.
 	The default is the single location $GOROOT/pkg/$GOOS_amd64.
+-P profile
+	Lay out the code using a CPU profile written by runtime/pprof.
+	The functions that got samples are placed first, each caller
+	next to the callee it calls most, and blocks that never ran or
+	that end in a panic are moved after the rest of their function.
+	The samples are symbolized through the Go symbol and line tables
+	of the profiled binary, which must be an ELF file built from the
+	same sources.
+-B binary
+	Name the binary that wrote the -P profile.  The default is the
+	output file, which is read before it is overwritten.
 -r dir1:dir2:...
 	Set the dynamic linker search path when using ELF.
 -V
 	Print the linker version.
+-Y
+	Print the leaf functions whose stack split check was dropped
+	because their frames fit in the space every caller leaves free.
 
 
 */
@@ -133,6 +133,7 @@ struct	Sym
 	uchar	special;
 	uchar	stkcheck;
 	uchar	hide;
+	uchar	leafref;	// how a leaf is reached; see leafsplit
 	int32	dynid;
 	int32	sig;
 	int32	plt;
@@ -183,7 +184,7 @@ enum
 	MINSIZ		= 8,
 	STRINGSZ	= 200,
 	MINLC		= 1,
-	MAXIO		= 8192,
+	MAXIO		= 64*1024,
 	MAXHIST		= 20,				/* limit of path elements for history symbols */
 
 	Yxxx		= 0,
@@ -70,7 +70,7 @@ Header headers[] = {
 void
 usage(void)
 {
-	fprint(2, "usage: 6l [-options] [-E entry] [-H head] [-I interpreter] [-L dir] [-T text] [-R rnd] [-r path] [-o out] main.6\n");
+	fprint(2, "usage: 6l [-options] [-E entry] [-H head] [-I interpreter] [-L dir] [-T text] [-R rnd] [-r path] [-P profile [-B binary]] [-o out] main.6\n");
 	exits("usage");
 }
 
@@ -78,6 +78,7 @@ void
 main(int argc, char *argv[])
 {
 	int c;
+	char *prof, *profbin;
 
 	Binit(&bso, 1, OWRITE);
 	cout = -1;
@@ -90,6 +91,8 @@ main(int argc, char *argv[])
 	INITDAT = -1;
 	INITRND = -1;
 	INITENTRY = 0;
+	prof = nil;
+	profbin = nil;
 
 	ARGBEGIN {
 	default:
@@ -126,6 +129,12 @@ main(int argc, char *argv[])
 	case 'r':
 		rpath = EARGF(usage());
 		break;
+	case 'P':
+		prof = EARGF(usage());
+		break;
+	case 'B':
+		profbin = EARGF(usage());
+		break;
 	case 'V':
 		print("%cl version %s\n", thechar, getgoversion());
 		errorexit();
@@ -134,6 +143,11 @@ main(int argc, char *argv[])
 	if(argc != 1)
 		usage();
 
+	// the profiled binary is usually the one about to be
+	// overwritten, so read it before libinit creates outfile.
+	if(prof != nil)
+		readprof(prof, profbin != nil ? profbin : outfile);
+
 	libinit();
 
 	if(HEADTYPE == -1)
@@ -258,6 +272,7 @@ main(int argc, char *argv[])
 			doprof1();
 		else
 			doprof2();
+	proforder();
 	span();
 	if(HEADTYPE == Hwindows)
 		dope();
@@ -282,60 +297,108 @@ main(int argc, char *argv[])
 	errorexit();
 }
 
+enum
+{
+	ProgSlab = 1024,
+	ProgBytes = 40,	/* bytes of object file per Prog kept, counting ANAME and ADATA */
+};
+
+static Prog *progslab;
+static int nprogslab;
+
+/*
+ * Progs come from slabs.  Ldobj1 makes sure there is a slab
+ * big enough for all of an object's instructions before
+ * decoding them.
+ */
+static void
+progs(int n)
+{
+	if(nprogslab >= n)
+		return;
+	if(n < ProgSlab)
+		n = ProgSlab;
+	progslab = mal(n*sizeof(Prog));
+	nprogslab = n;
+}
+
+static Prog*
+newprog(void)
+{
+	if(nprogslab == 0)
+		progs(ProgSlab);
+	nprogslab--;
+	return progslab++;
+}
+
+/*
+ * Give back p, the last Prog returned by newprog.
+ */
+static void
+unprog(Prog *p)
+{
+	if(p != progslab-1)
+		return;
+	memset(p, 0, sizeof *p);
+	progslab--;
+	nprogslab++;
+}
+
 static Sym*
-zsym(char *pn, Biobuf *f, Sym *h[])
+zsym(char *pn, Objbuf *b, Sym *h[])
 {	
 	int o;
 	
-	o = BGETC(f);
-	if(o < 0 || o >= NSYM || h[o] == nil)
+	o = OGETC(b);
+	if(o >= NSYM || h[o] == nil)
 		mangle(pn);
 	return h[o];
 }
 
 static void
-zaddr(char *pn, Biobuf *f, Adr *a, Sym *h[])
+zaddr(char *pn, Objbuf *b, Adr *a, Sym *h[])
 {
 	int t;
 	int32 l;
 	Sym *s;
 	Auto *u;
 
-	t = BGETC(f);
+	t = OGETC(b);
 	a->index = D_NONE;
 	a->scale = 0;
 	if(t & T_INDEX) {
-		a->index = BGETC(f);
-		a->scale = BGETC(f);
+		a->index = OGETC(b);
+		a->scale = OGETC(b);
 	}
 	a->offset = 0;
 	if(t & T_OFFSET) {
-		a->offset = Bget4(f);
+		a->offset = OGET4(b);
 		if(t & T_64) {
 			a->offset &= 0xFFFFFFFFULL;
-			a->offset |= (vlong)Bget4(f) << 32;
+			a->offset |= (vlong)OGET4(b) << 32;
 		}
 	}
 	a->sym = S;
 	if(t & T_SYM)
-		a->sym = zsym(pn, f, h);
+		a->sym = zsym(pn, b, h);
 	a->type = D_NONE;
 	if(t & T_FCONST) {
-		a->ieee.l = Bget4(f);
-		a->ieee.h = Bget4(f);
+		a->ieee.l = OGET4(b);
+		a->ieee.h = OGET4(b);
 		a->type = D_FCONST;
 	} else
 	if(t & T_SCONST) {
-		Bread(f, a->scon, NSNAME);
+		memmove(a->scon, b->p, NSNAME);
+		b->p += NSNAME;
 		a->type = D_SCONST;
 	}
 	if(t & T_TYPE)
-		a->type = BGETC(f);
+		a->type = OGETC(b);
 	if(a->type < 0 || a->type >= D_SIZE)
 		mangle(pn);
 	adrgotype = S;
 	if(t & T_GOTYPE)
-		adrgotype = zsym(pn, f, h);
+		adrgotype = zsym(pn, b, h);
 	s = a->sym;
 	t = a->type;
 	if(t == D_INDIR+D_GS)
@@ -396,10 +459,14 @@ ldobj1(Biobuf *f, char *pkg, int64 len, char *pn)
 	vlong eof;
 	char src[1024];
 	Prog *lastp;
+	Objbuf ob, *b;
 
 	lastp = nil;
 	ntext = 0;
-	eof = Boffset(f) + len;
+	b = &ob;
+	objinit(b, f, len);
+	eof = b->off + len;
+	progs(len/ProgBytes);
 	src[0] = 0;
 
 newloop:
@@ -411,16 +478,12 @@ newloop:
 	mode = 64;
 
 loop:
-	if(f->state == Bracteof || Boffset(f) >= eof)
+	if(objrec(b) <= 0)
 		goto eof;
-	o = BGETC(f);
-	if(o == Beof)
-		goto eof;
-	o |= BGETC(f) << 8;
+	o = OGETC(b);
+	o |= OGETC(b) << 8;
 	if(o <= AXXX || o >= ALAST) {
-		if(o < 0)
-			goto eof;
-		diag("%s:#%lld: opcode out of range: %#ux", pn, Boffset(f), o);
+		diag("%s:#%lld: opcode out of range: %#ux", pn, OOFFSET(b), o);
 		print("	probably not a .6 file\n");
 		errorexit();
 	}
@@ -428,20 +491,15 @@ loop:
 	if(o == ANAME || o == ASIGNAME) {
 		sig = 0;
 		if(o == ASIGNAME)
-			sig = Bget4(f);
-		v = BGETC(f);	/* type */
-		o = BGETC(f);	/* sym */
+			sig = OGET4(b);
+		v = OGETC(b);	/* type */
+		o = OGETC(b);	/* sym */
 		r = 0;
 		if(v == D_STATIC)
 			r = version;
-		name = Brdline(f, '\0');
-		if(name == nil) {
-			if(Blinelen(f) > 0) {
-				fprint(2, "%s: name too long\n", pn);
-				errorexit();
-			}
+		name = objname(b);
+		if(name == nil)
 			goto eof;
-		}
 		x = expandpkg(name, pkg);
 		s = lookup(x, r);
 		if(x != name)
@@ -482,16 +540,16 @@ loop:
 		goto loop;
 	}
 
-	p = mal(sizeof(*p));
+	p = newprog();
 	p->as = o;
-	p->line = Bget4(f);
+	p->line = OGET4(b);
 	p->back = 2;
 	p->mode = mode;
 	p->ft = 0;
 	p->tt = 0;
-	zaddr(pn, f, &p->from, h);
+	zaddr(pn, b, &p->from, h);
 	fromgotype = adrgotype;
-	zaddr(pn, f, &p->to, h);
+	zaddr(pn, b, &p->to, h);
 	
 	switch(p->as) {
 	case ATEXT:
@@ -526,8 +584,8 @@ loop:
 			cursym->autom = curauto;
 		curauto = 0;
 		cursym = nil;
-		if(Boffset(f) == eof)
-			return;
+		if(OOFFSET(b) == eof)
+			goto out;
 		goto newloop;
 
 	case AGLOBL:
@@ -568,7 +626,7 @@ loop:
 			errorexit();
 		}
 		savedata(s, p, pn);
-		unmal(p, sizeof *p);
+		unprog(p);
 		goto loop;
 
 	case AGOK:
@@ -580,13 +638,13 @@ loop:
 		s = p->from.sym;
 		if(s->text != nil) {
 			diag("%s: %s: redefinition", pn, s->name);
-			return;
+			goto out;
 		}
 		if(ntext++ == 0 && s->type != 0 && s->type != SXREF) {
 			/* redefinition, so file has probably been seen before */
 			if(debug['v'])
 				Bprint(&bso, "skipping: %s: redefinition: %s", pn, s->name);
-			return;
+			goto out;
 		}
 		if(cursym != nil && cursym->text) {
 			histtoauto();
@@ -719,6 +777,8 @@ loop:
 
 eof:
 	diag("truncated object file: %s", pn);
+out:
+	objterm(b);
 }
 
 Prog*
@@ -726,7 +786,7 @@ prg(void)
 {
 	Prog *p;
 
-	p = mal(sizeof(*p));
+	p = newprog();
 
 	*p = zprg;
 	return p;
@@ -49,19 +49,46 @@ brchain(Prog *p)
 	return P;
 }
 
+/*
+ * with a profile, blocks that never ran or that end
+ * in a panic are laid out after the rest of their function.
+ */
+static	char*	noretname[] = {
+	"runtime.panic",
+	"runtime.panicindex",
+	"runtime.panicslice",
+	"runtime.panicstring",
+	"runtime.throw",
+	"runtime.throwinit",
+	"runtime.throwreturn",
+};
+static	Sym*	noret[nelem(noretname)];
+static	Prog**	coldq;
+static	int	ncoldq;
+static	int	mcoldq;
+
 void
 follow(void)
 {
 	Prog *firstp, *lastp;
+	int i;
 
 	if(debug['v'])
 		Bprint(&bso, "%5.2f follow\n", cputime());
 	Bflush(&bso);
 	
+	if(proflayout)
+		for(i=0; i<nelem(noret); i++)
+			noret[i] = rlookup(noretname[i], 0);
+
 	for(cursym = textp; cursym != nil; cursym = cursym->next) {
 		firstp = prg();
 		lastp = firstp;
+		ncoldq = 0;
 		xfol(cursym->text, &lastp);
+		for(i=0; i<ncoldq; i++)
+			if(!coldq[i]->mark)
+				xfol(coldq[i], &lastp);
 		lastp->link = nil;
 		cursym->text = firstp->link;
 	}
@@ -105,6 +132,52 @@ pushpop(int a)
 	return 0;
 }
 
+static int
+jcc(int a)
+{
+	return a >= AJCC && a <= AJPS && a != AJCXZ && a != AJMP;
+}
+
+/*
+ * is the straight-line code starting at p cold?
+ * it is if it calls a function that never returns,
+ * or if none of its lines has a sample.
+ */
+static int
+cold(Prog *p)
+{
+	int i, j, hot;
+
+	if(!proflayout || p == P || p->mark)
+		return 0;
+	hot = 0;
+	for(i=0; i<32 && p != P; i++, p = p->link) {
+		if(p->as == ACALL && p->to.sym != S)
+			for(j=0; j<nelem(noret); j++)
+				if(p->to.sym == noret[j])
+					return 1;
+		if(!hot && p->as != ANOP && proflinesamples(cursym, p->line) > 0)
+			hot = 1;
+		if(nofollow(p->as) || (p->pcond != P && p->as != ACALL))
+			break;
+	}
+	return !hot;
+}
+
+static void
+defercold(Prog *p)
+{
+	if(ncoldq >= mcoldq) {
+		mcoldq = mcoldq*2 + 64;
+		coldq = realloc(coldq, mcoldq*sizeof coldq[0]);
+		if(coldq == nil) {
+			diag("out of memory");
+			errorexit();
+		}
+	}
+	coldq[ncoldq++] = p;
+}
+
 static void
 xfol(Prog *p, Prog **last)
 {
@@ -199,12 +272,23 @@ loop:
 			p->link = p->pcond;
 			p->pcond = q;
 		}
+		if(jcc(a) && cold(q) && !cold(brchain(p->pcond))) {
+			/* make the hot path the fall through */
+			p->as = relinv(a);
+			p->link = p->pcond;
+			p->pcond = q;
+		}
 		xfol(p->link, last);
 		q = brchain(p->pcond);
 		if(q->mark) {
 			p->pcond = q;
 			return;
 		}
+		if(cold(q)) {
+			p->pcond = q;
+			defercold(q);
+			return;
+		}
 		p = q;
 		goto loop;
 	}
@@ -387,6 +471,96 @@ morename[] =
 Prog*	pmorestack[nelem(morename)];
 Sym*	symmorestack[nelem(morename)];
 
+enum
+{
+	LeafNosplit = 1<<0,	// called or jumped to from nosplit code
+	LeafAddr = 1<<1,	// address taken
+};
+
+/*
+ * find how each function is reached.
+ * the stack check in ../ld/lib.c:/^dostkcheck
+ * follows direct calls but assumes that an
+ * indirect call reaches a splitting function.
+ */
+static void
+leafrefs(void)
+{
+	Sym *s, *t;
+	Prog *p;
+	int i;
+
+	for(s = textp; s != nil; s = s->next)
+	for(p = s->text; p != P; p = p->link) {
+		if(p->as == ATEXT)
+			continue;
+		if((p->as == ACALL || p->as == AJMP) && p->to.type == D_BRANCH && p->to.sym != S) {
+			if(p->to.sym != s && (s->text->from.scale & NOSPLIT))
+				p->to.sym->leafref |= LeafNosplit;
+			if(p->as == AJMP && p->to.sym != s)
+				p->to.sym->leafref |= LeafNosplit;
+		} else
+		if(p->to.sym != S)
+			p->to.sym->leafref |= LeafAddr;
+		if(p->from.sym != S)
+			p->from.sym->leafref |= LeafAddr;
+	}
+	for(s = allsym; s != S; s = s->allsym)
+	for(i = 0; i < s->nr; i++) {
+		t = s->r[i].sym;
+		if(t != S)
+			t->leafref |= LeafAddr;
+	}
+}
+
+/*
+ * can the function at p, with a frame of autoffset
+ * bytes, do without the stack split check?
+ *
+ * a leaf can, if its frame fits in what every caller
+ * guarantees: a splitting caller leaves StackLimit
+ * bytes after its own check, less the return address.
+ * nosplit callers and indirect calls are only known
+ * to leave room for the callee to call morestack, so
+ * a leaf reached that way must need no more than a
+ * call would.  dostkcheck checks the result.
+ */
+static int
+leafsplit(Prog *p, int32 autoffset)
+{
+	Prog *q;
+
+	if(debug['K'] || debug['p'])
+		return 0;
+	if(autoffset > StackLimit - PtrSize)
+		return 0;
+	if(cursym->leafref && autoffset > PtrSize)
+		return 0;
+	for(q = p->link; q != P; q = q->link) {
+		switch(q->as) {
+		case ACALL:
+		case APUSHL:
+		case APUSHFL:
+		case APUSHQ:
+		case APUSHFQ:
+		case APUSHW:
+		case APUSHFW:
+		case APOPL:
+		case APOPFL:
+		case APOPQ:
+		case APOPFQ:
+		case APOPW:
+		case APOPFW:
+			return 0;
+		case AJMP:
+			if(q->to.type != D_BRANCH || q->to.sym != S)
+				return 0;
+			break;
+		}
+	}
+	return 1;
+}
+
 void
 dostkoff(void)
 {
@@ -401,6 +575,7 @@ dostkoff(void)
 			diag("morestack trampoline not defined - %s", morename[i]);
 		pmorestack[i] = symmorestack[i]->text;
 	}
+	leafrefs();
 
 	autoffset = 0;
 	deltasp = 0;
@@ -416,6 +591,11 @@ dostkoff(void)
 
 		q = P;
 		q1 = P;
+		if(!(p->from.scale & NOSPLIT) && leafsplit(p, autoffset)) {
+			p->from.scale |= NOSPLIT;
+			if(debug['Y'])
+				Bprint(&bso, "%s: nosplit leaf, frame %d\n", cursym->name, autoffset);
+		}
 		if((p->from.scale & NOSPLIT) && autoffset >= StackSmall)
 			diag("nosplit func likely to overflow stack");
 
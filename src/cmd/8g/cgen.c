@@ -1216,8 +1216,11 @@ sgen(Node *n, Node *res, int32 w)
 		gins(ACLD, N, N);
 	} else {
 		gins(ACLD, N, N);	// paranoia.  TODO(rsc): remove?
-		// normal direction
-		if(q >= 4) {
+		// normal direction.
+		// REP MOVSL has a high startup cost, so medium-sized
+		// copies are unrolled.  8l has no SSE moves, so unlike
+		// 6g there is no MOVOU path here.
+		if(q >= MaxInlineMovs) {
 			gconreg(AMOVL, q, D_CX);
 			gins(AREP, N, N);	// repeat
 			gins(AMOVSL, N, N);	// MOVL *(SI)+,*(DI)+
@@ -53,6 +53,11 @@ enum
 	Fpop2 = 1<<2,
 };
 
+enum
+{
+	MaxInlineMovs	= 16,	// fat copies or clears of fewer words use unrolled MOVSL/STOSL
+};
+
 EXTERN	Biobuf*	bout;
 EXTERN	int32	dynloc;
 EXTERN	uchar	reg[D_NONE];
@@ -141,7 +141,7 @@ clearfat(Node *nl)
 	nodreg(&n1, types[tptr], D_DI);
 	agen(nl, &n1);
 
-	if(q >= 4) {
+	if(q >= MaxInlineMovs) {
 		gconreg(AMOVL, q, D_CX);
 		gins(AREP, N, N);	// repeat
 		gins(ASTOSL, N, N);	// STOL AL,*(DI)+
@@ -331,58 +331,106 @@ main(int argc, char *argv[])
 	errorexit();
 }
 
+enum
+{
+	ProgSlab = 1024,
+	ProgBytes = 40,	/* bytes of object file per Prog kept, counting ANAME and ADATA */
+};
+
+static Prog *progslab;
+static int nprogslab;
+
+/*
+ * Progs come from slabs.  Ldobj1 makes sure there is a slab
+ * big enough for all of an object's instructions before
+ * decoding them.
+ */
+static void
+progs(int n)
+{
+	if(nprogslab >= n)
+		return;
+	if(n < ProgSlab)
+		n = ProgSlab;
+	progslab = mal(n*sizeof(Prog));
+	nprogslab = n;
+}
+
+static Prog*
+newprog(void)
+{
+	if(nprogslab == 0)
+		progs(ProgSlab);
+	nprogslab--;
+	return progslab++;
+}
+
+/*
+ * Give back p, the last Prog returned by newprog.
+ */
+static void
+unprog(Prog *p)
+{
+	if(p != progslab-1)
+		return;
+	memset(p, 0, sizeof *p);
+	progslab--;
+	nprogslab++;
+}
+
 static Sym*
-zsym(char *pn, Biobuf *f, Sym *h[])
+zsym(char *pn, Objbuf *b, Sym *h[])
 {	
 	int o;
 	
-	o = Bgetc(f);
-	if(o < 0 || o >= NSYM || h[o] == nil)
+	o = OGETC(b);
+	if(o >= NSYM || h[o] == nil)
 		mangle(pn);
 	return h[o];
 }
 
 static void
-zaddr(char *pn, Biobuf *f, Adr *a, Sym *h[])
+zaddr(char *pn, Objbuf *b, Adr *a, Sym *h[])
 {
 	int t;
 	int32 l;
 	Sym *s;
 	Auto *u;
 
-	t = Bgetc(f);
+	t = OGETC(b);
 	a->index = D_NONE;
 	a->scale = 0;
 	if(t & T_INDEX) {
-		a->index = Bgetc(f);
-		a->scale = Bgetc(f);
+		a->index = OGETC(b);
+		a->scale = OGETC(b);
 	}
 	a->type = D_NONE;
 	a->offset = 0;
 	if(t & T_OFFSET)
-		a->offset = Bget4(f);
+		a->offset = OGET4(b);
 	a->offset2 = 0;
 	if(t & T_OFFSET2) {
-		a->offset2 = Bget4(f);
+		a->offset2 = OGET4(b);
 		a->type = D_CONST2;
 	}
 	a->sym = S;
 	if(t & T_SYM)
-		a->sym = zsym(pn, f, h);
+		a->sym = zsym(pn, b, h);
 	if(t & T_FCONST) {
-		a->ieee.l = Bget4(f);
-		a->ieee.h = Bget4(f);
+		a->ieee.l = OGET4(b);
+		a->ieee.h = OGET4(b);
 		a->type = D_FCONST;
 	} else
 	if(t & T_SCONST) {
-		Bread(f, a->scon, NSNAME);
+		memmove(a->scon, b->p, NSNAME);
+		b->p += NSNAME;
 		a->type = D_SCONST;
 	}
 	if(t & T_TYPE)
-		a->type = Bgetc(f);
+		a->type = OGETC(b);
 	adrgotype = S;
 	if(t & T_GOTYPE)
-		adrgotype = zsym(pn, f, h);
+		adrgotype = zsym(pn, b, h);
 
 	t = a->type;
 	if(t == D_INDIR+D_GS)
@@ -438,10 +486,14 @@ ldobj1(Biobuf *f, char *pkg, int64 len, char *pn)
 	char *name, *x;
 	char src[1024];
 	Prog *lastp;
+	Objbuf ob, *b;
 
 	lastp = nil;
 	ntext = 0;
-	eof = Boffset(f) + len;
+	b = &ob;
+	objinit(b, f, len);
+	eof = b->off + len;
+	progs(len/ProgBytes);
 	src[0] = 0;
 
 
@@ -453,16 +505,12 @@ newloop:
 	skip = 0;
 
 loop:
-	if(f->state == Bracteof || Boffset(f) >= eof)
+	if(objrec(b) <= 0)
 		goto eof;
-	o = Bgetc(f);
-	if(o == Beof)
-		goto eof;
-	o |= Bgetc(f) << 8;
+	o = OGETC(b);
+	o |= OGETC(b) << 8;
 	if(o <= AXXX || o >= ALAST) {
-		if(o < 0)
-			goto eof;
-		diag("%s:#%lld: opcode out of range: %#ux", pn, Boffset(f), o);
+		diag("%s:#%lld: opcode out of range: %#ux", pn, OOFFSET(b), o);
 		print("	probably not a .%c file\n", thechar);
 		errorexit();
 	}
@@ -470,20 +518,15 @@ loop:
 	if(o == ANAME || o == ASIGNAME) {
 		sig = 0;
 		if(o == ASIGNAME)
-			sig = Bget4(f);
-		v = Bgetc(f);	/* type */
-		o = Bgetc(f);	/* sym */
+			sig = OGET4(b);
+		v = OGETC(b);	/* type */
+		o = OGETC(b);	/* sym */
 		r = 0;
 		if(v == D_STATIC)
 			r = version;
-		name = Brdline(f, '\0');
-		if(name == nil) {
-			if(Blinelen(f) > 0) {
-				fprint(2, "%s: name too long\n", pn);
-				errorexit();
-			}
+		name = objname(b);
+		if(name == nil)
 			goto eof;
-		}
 		x = expandpkg(name, pkg);
 		s = lookup(x, r);
 		if(x != name)
@@ -524,15 +567,15 @@ loop:
 		goto loop;
 	}
 
-	p = mal(sizeof(*p));
+	p = newprog();
 	p->as = o;
-	p->line = Bget4(f);
+	p->line = OGET4(b);
 	p->back = 2;
 	p->ft = 0;
 	p->tt = 0;
-	zaddr(pn, f, &p->from, h);
+	zaddr(pn, b, &p->from, h);
 	fromgotype = adrgotype;
-	zaddr(pn, f, &p->to, h);
+	zaddr(pn, b, &p->to, h);
 
 	if(debug['W'])
 		print("%P\n", p);
@@ -558,8 +601,8 @@ loop:
 			cursym->autom = curauto;
 		curauto = 0;
 		cursym = nil;
-		if(Boffset(f) == eof)
-			return;
+		if(OOFFSET(b) == eof)
+			goto out;
 		goto newloop;
 
 	case AGLOBL:
@@ -600,7 +643,7 @@ loop:
 			errorexit();
 		}
 		savedata(s, p, pn);
-		unmal(p, sizeof *p);
+		unprog(p);
 		goto loop;
 
 	case AGOK:
@@ -612,13 +655,13 @@ loop:
 		s = p->from.sym;
 		if(s->text != nil) {
 			diag("%s: %s: redefinition", pn, s->name);
-			return;
+			goto out;
 		}
 		if(ntext++ == 0 && s->type != 0 && s->type != SXREF) {
 			/* redefinition, so file has probably been seen before */
 			if(debug['v'])
 				diag("skipping: %s: redefinition: %s", pn, s->name);
-			return;
+			goto out;
 		}
 		if(cursym != nil && cursym->text) {
 			histtoauto();
@@ -722,6 +765,8 @@ loop:
 
 eof:
 	diag("truncated object file: %s", pn);
+out:
+	objterm(b);
 }
 
 Prog*
@@ -729,7 +774,7 @@ prg(void)
 {
 	Prog *p;
 
-	p = mal(sizeof(Prog));
+	p = newprog();
 	*p = zprg;
 	return p;
 }
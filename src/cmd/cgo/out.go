@@ -541,6 +541,11 @@ func (p *Package) writeExports(fgo2, fc, fm *os.File) {
 			fmt.Fprint(fgo2, ")\n")
 			fmt.Fprint(fgo2, "}\n")
 		}
+
+		// C calls goname through the stack convention;
+		// taking its value keeps 6g from giving it
+		// register arguments.
+		fmt.Fprintf(fgo2, "var _ = %s\n", goname)
 	}
 }
 
@@ -12,9 +12,23 @@ cov prints the line numbers of sections of code in the binary that
 were not executed.   With no arguments it assumes the command "6.out".
 
 Usage: cov [-lsv] [-g substring] [-m minlines] [6.out args]
+       cov -c [-lsv] [-g substring] [-m minlines] countfile...
+
+Tracing a program with breakpoints makes it run very slowly.  Instead,
+the packages of interest can be compiled with 6g -C (for example, with
+GCFLAGS=-C in the environment of make or gotest), which inserts a counter
+at the start of each run of straight-line statements.  If $GOCOVER names
+a file when such a program exits, the counts are appended to it.  Only
+Linux writes the counts so far; on other systems such a program prints
+an error and exits with status 2 instead.  Given the -c flag, cov adds
+up the counts in the named files, which may hold the output of many
+runs, and prints the runs of statements that never executed; with -v it
+prints every run and its count.
 
 The options are:
 
+	-c
+		read count files written by programs compiled with 6g -C
 	-l
 		print full path names instead of paths relative to the current directory
 	-s
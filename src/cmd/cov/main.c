@@ -21,6 +21,7 @@ void
 usage(void)
 {
 	fprint(2, "usage: cov [-lsv] [-g substring] [-m minlines] [6.out args...]\n");
+	fprint(2, "       cov -c [-lsv] [-g substring] [-m minlines] countfile...\n");
 	fprint(2, "-g specifies pattern of interesting functions or files\n");
 	exits("usage");
 }
@@ -46,6 +47,7 @@ int ncwd;
 int minlines = -1000;
 
 Tree breakpoints;	// code ranges not run
+Tree blocks;		// counted blocks, for -c
 
 /*
  * comparison for Range structures
@@ -421,12 +423,126 @@ go(void)
 	}
 }
 
+/*
+ * a block of statements counted by code
+ * compiled with 6g -C, as recorded in a
+ * count file ($GOCOVER; see runtime/cover.c).
+ */
+typedef struct Block Block;
+struct Block
+{
+	char *file;
+	int line1;
+	int line2;
+	int index;
+	uvlong count;
+};
+
+/*
+ * comparison for Block structures.
+ * like rangecmp, positive if a comes first.
+ */
+int
+blockcmp(void *va, void *vb)
+{
+	Block *a = va, *b = vb;
+	int c;
+
+	c = strcmp(b->file, a->file);
+	if(c != 0)
+		return c;
+	if(a->line1 != b->line1)
+		return a->line1 < b->line1 ? 1 : -1;
+	if(a->index != b->index)
+		return a->index < b->index ? 1 : -1;
+	if(a->line2 != b->line2)
+		return a->line2 < b->line2 ? 1 : -1;
+	return 0;
+}
+
+/*
+ * add the counts in file to the blocks tree.
+ * each line is
+ *	file:line1,line2 index count
+ * and a block may appear many times,
+ * once for each run of the program.
+ */
+void
+readcounts(char *file)
+{
+	Biobuf *b;
+	Block key, *n;
+	char *p, *f[3], *q;
+	int lineno;
+
+	if((b = Bopen(file, OREAD)) == nil)
+		sysfatal("open %s: %r", file);
+	for(lineno=1; (p = Brdstr(b, '\n', 1)) != nil; lineno++) {
+		q = nil;
+		if(tokenize(p, f, nelem(f)) == 3)
+			q = strrchr(f[0], ':');
+		if(q == nil || strchr(q, ',') == nil)
+			sysfatal("%s:%d: malformed count line", file, lineno);
+		*q++ = 0;
+		key.file = f[0];
+		key.line1 = atoi(q);
+		key.line2 = atoi(strchr(q, ',')+1);
+		key.index = atoi(f[1]);
+		n = treeget(&blocks, &key);
+		if(n == nil) {
+			n = malloc(sizeof *n);
+			if(n == nil)
+				sysfatal("out of memory");
+			*n = key;
+			n->file = strdup(key.file);
+			n->count = 0;
+			treeput(&blocks, n, n);
+		}
+		n->count += strtoull(f[2], 0, 10);
+		free(p);
+	}
+	Bterm(b);
+}
+
+/*
+ * print the blocks that never ran,
+ * or with -v, every block and its count.
+ */
+void
+walkblocks(TreeNode *t)
+{
+	Block *n;
+
+	if(t == nil)
+		return;
+	walkblocks(t->left);
+	n = t->key;
+	if((n->count == 0 || chatty)
+	&& n->line2+1-n->line1 >= minlines
+	&& (substring == nil || strstr(n->file, substring))) {
+		if(n->line1 != n->line2)
+			print("%s:%d,%d", shortname(n->file), n->line1, n->line2);
+		else
+			print("%s:%d", shortname(n->file), n->line1);
+		if(chatty)
+			print(" %llud", n->count);
+		print("\n");
+		if(doshowsrc && n->count == 0)
+			showsrc(n->file, n->line1, n->line2);
+	}
+	walkblocks(t->right);
+}
+
 void
 main(int argc, char **argv)
 {
-	int n;
+	int n, counts;
 
+	counts = 0;
 	ARGBEGIN{
+	case 'c':
+		counts = 1;
+		break;
 	case 'g':
 		substring = EARGF(usage());
 		break;
@@ -449,6 +565,16 @@ main(int argc, char **argv)
 	getwd(cwd, sizeof cwd);
 	ncwd = strlen(cwd);
 
+	if(counts) {
+		if(argc == 0)
+			usage();
+		blocks.cmp = blockcmp;
+		for(; argc > 0; argc--, argv++)
+			readcounts(argv[0]);
+		walkblocks(blocks.root);
+		exits(0);
+	}
+
 	if(argc == 0) {
 		*--argv = "6.out";
 		argc++;
@@ -0,0 +1,346 @@
+// Copyright 2011 The Go Authors.  All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/*
+ * code coverage counters (-C).
+ *
+ * each straight-line run of statements gets a uint32
+ * counter, cover·count[i], which is incremented at the
+ * start of the run.  a run ends at a label and after any
+ * statement that branches or has a body of its own.
+ * the package init passes cover·desc to runtime.coverregister,
+ * and the runtime writes the counts out when the program
+ * exits (see runtime/cover.c); cov -c reads them.
+ */
+
+#include	"go.h"
+
+typedef struct Cover Cover;
+struct Cover
+{
+	int32	line0;	// first and last statement of the run
+	int32	line1;
+};
+
+static	Cover*	cover;
+static	int	ncover;
+static	int	mcover;
+static	int	covstart;	// next statement begins a run
+static	int	covcur;		// run being extended
+
+static	NodeList*	covlist(NodeList*);
+
+static Node*
+covcounter(int32 lno)
+{
+	Node *n, *a;
+
+	if(ncover >= mcover) {
+		mcover = 2*mcover + 64;
+		cover = realloc(cover, mcover*sizeof cover[0]);
+		if(cover == nil)
+			fatal("out of memory");
+	}
+	covcur = ncover++;
+	cover[covcur].line0 = lno;
+	cover[covcur].line1 = lno;
+
+	n = newname(lookup("cover·count"));
+	n->class = PEXTERN;
+	n->type = types[TUINT32];
+	n->xoffset = covcur*4;
+
+	a = nod(OASOP, n, nodintconst(1));
+	a->etype = OADD;
+	a->lineno = lno;
+	return a;
+}
+
+/*
+ * a nested body is a run of its own,
+ * and so is whatever follows the statement
+ * that holds it.
+ */
+static NodeList*
+covbody(NodeList *l, int32 lno)
+{
+	covstart = 1;
+	if(l == nil)
+		l = list1(covcounter(lno));
+	else
+		l = covlist(l);
+	covstart = 1;
+	return l;
+}
+
+static void
+covstmt(Node *n)
+{
+	NodeList *l;
+
+	switch(n->op) {
+	case OIF:
+		n->nbody = covbody(n->nbody, n->lineno);
+		if(n->nelse != nil)
+			n->nelse = covbody(n->nelse, n->lineno);
+		break;
+
+	case OFOR:
+	case ORANGE:
+		n->nbody = covbody(n->nbody, n->lineno);
+		break;
+
+	case OSWITCH:
+	case OSELECT:
+		for(l=n->list; l; l=l->next)
+			l->n->nbody = covbody(l->n->nbody, l->n->lineno);
+		break;
+
+	case OGOTO:
+	case ORETURN:
+	case OBREAK:
+	case OCONTINUE:
+		covstart = 1;
+		break;
+	}
+}
+
+/*
+ * a label on a for, switch or select must stay
+ * next to its statement; gen matches them by pc.
+ * the counter goes at the front of the statement's
+ * init instead, which gen emits after the label,
+ * so a goto to the label counts too.
+ */
+static int
+looplabel(Node *n)
+{
+	if(n->right == N)
+		return 0;
+	switch(n->right->op) {
+	case OFOR:
+	case ORANGE:
+	case OSWITCH:
+	case OSELECT:
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * compound statements carry the line
+ * where they end; find where they start.
+ * names carry the line of their declaration.
+ */
+static int32
+stmtline(Node *n)
+{
+	Node *c[7];
+	int32 lno;
+	int i;
+
+	if(n->op == OLABEL && n->right != N)
+		n = n->right;
+	lno = n->lineno;
+	switch(n->op) {
+	case OIF:
+	case OFOR:
+	case ORANGE:
+	case OSWITCH:
+	case OSELECT:
+		c[0] = n->left;
+		c[1] = n->right;
+		c[2] = n->ntest;
+		c[3] = n->nincr;
+		c[4] = n->ninit ? n->ninit->n : N;
+		c[5] = n->nbody ? n->nbody->n : N;
+		c[6] = n->list ? n->list->n : N;	// first case
+		for(i=0; i<nelem(c); i++) {
+			if(c[i] == N || c[i]->lineno <= 0 || c[i]->lineno >= lno)
+				continue;
+			switch(c[i]->op) {
+			case ONAME:
+			case ONONAME:
+			case OLITERAL:
+			case OTYPE:
+			case OPACK:
+				continue;
+			}
+			lno = c[i]->lineno;
+		}
+		break;
+	}
+	return lno;
+}
+
+static NodeList*
+covlist(NodeList *l)
+{
+	NodeList *out;
+	Node *n, *labeled;
+	int32 lno;
+
+	out = nil;
+	labeled = N;
+	for(; l; l=l->next) {
+		n = l->n;
+		if(n == N)
+			continue;
+		if(n->op == OLABEL) {
+			if(looplabel(n))
+				labeled = n->right;
+			out = list(out, n);
+			covstart = 1;
+			continue;
+		}
+		if(n->op == OBLOCK) {
+			n->list = covlist(n->list);
+			out = list(out, n);
+			continue;
+		}
+		lno = stmtline(n);
+		if(covstart) {
+			if(n == labeled)
+				n->ninit = concat(list1(covcounter(lno)), n->ninit);
+			else
+				out = list(out, covcounter(lno));
+			covstart = 0;
+		}
+		if(lno > cover[covcur].line1)
+			cover[covcur].line1 = lno;
+		covstmt(n);
+		out = list(out, n);
+	}
+	return out;
+}
+
+/*
+ * add counters to the body of fn,
+ * before it is type checked.
+ */
+void
+covfunc(Node *fn)
+{
+	if(!debug['C'] || compiling_runtime || fn->nbody == nil)
+		return;
+	covstart = 1;
+	fn->nbody = covlist(fn->nbody);
+}
+
+/*
+ * cover·desc, for the runtime to find the counters.
+ */
+Node*
+covdesc(void)
+{
+	Node *n;
+
+	n = newname(lookup("cover·desc"));
+	n->class = PEXTERN;
+	n->type = types[TUINT8];
+	return n;
+}
+
+/*
+ * the file and line of lno, with the file made
+ * absolute; buf holds 1000 bytes.
+ */
+static void
+covfile(char *buf, int32 lno, int32 *line)
+{
+	char name[1000], *p;
+
+	snprint(name, sizeof name, "%+L", lno);
+	p = strrchr(name, ':');
+	*line = 0;
+	if(p != nil) {
+		*p++ = 0;
+		*line = atoi(p);
+	}
+	if(p == nil || name[0] == '/') {
+		snprint(buf, 1000, "%s", name);
+		return;
+	}
+	if(strlen(pathname)+1+strlen(name) >= 1000)
+		fatal("coverage: path too long: %s/%s", pathname, name);
+	snprint(buf, 1000, "%s/%s", pathname, name);
+}
+
+/*
+ * the counters and cover·desc are written at
+ * run time, so they cannot go in read-only data
+ * the way ggloblsym would put them.
+ */
+static void
+covglobl(Sym *s, int32 width)
+{
+	Node *n;
+
+	n = newname(s);
+	n->class = PEXTERN;
+	ggloblnod(n, width);
+}
+
+/*
+ * emit the counters and the tables describing them:
+ *	cover·count	[n]uint32
+ *	cover·pos	[n][3]uint32: file index, first line, last line
+ *	cover·files	[nfile]*string
+ *	cover·desc	{next, n, &cover·count, &cover·pos, nfile, &cover·files}
+ * layout must match Cover in runtime/cover.c.
+ */
+void
+covtables(void)
+{
+	Sym *count, *pos, *files, *desc;
+	char buf[1000], **file;
+	int i, j, nfile, opos, ofile, off;
+	int32 line0, line1;
+
+	if(!debug['C'] || compiling_runtime)
+		return;
+
+	count = lookup("cover·count");
+	pos = lookup("cover·pos");
+	files = lookup("cover·files");
+	desc = lookup("cover·desc");
+
+	file = mal((ncover+1)*sizeof file[0]);
+	nfile = 0;
+	opos = 0;
+	ofile = 0;
+	for(i=0; i<ncover; i++) {
+		covfile(buf, cover[i].line0, &line0);
+		covfile(buf, cover[i].line1, &line1);
+		for(j=0; j<nfile; j++)
+			if(strcmp(file[j], buf) == 0)
+				break;
+		if(j == nfile) {
+			file[nfile] = strdup(buf);
+			ofile = dgostringptr(files, ofile, file[nfile]);
+			nfile++;
+		}
+		opos = duint32(pos, opos, j);
+		opos = duint32(pos, opos, line0);
+		opos = duint32(pos, opos, line1);
+	}
+
+	off = duintptr(desc, 0, 0);
+	off = duintptr(desc, off, ncover);
+	if(ncover > 0) {
+		covglobl(count, ncover*4);
+		ggloblsym(pos, opos, 0);
+		ggloblsym(files, ofile, 0);
+		off = dsymptr(desc, off, count, 0);
+		off = dsymptr(desc, off, pos, 0);
+		off = duintptr(desc, off, nfile);
+		off = dsymptr(desc, off, files, 0);
+	} else {
+		off = duintptr(desc, off, 0);
+		off = duintptr(desc, off, 0);
+		off = duintptr(desc, off, 0);
+		off = duintptr(desc, off, 0);
+	}
+	covglobl(desc, off);
+}
@@ -1231,6 +1231,7 @@ funccompile(Node *n, int isclosure)
 	curfn = nil;
 
 	stksize = 0;
+	nstkslot = 0;
 	dclcontext = PAUTO;
 	funcdepth = n->funcdepth + 1;
 	compile(n);
@@ -35,6 +35,11 @@ Flags:
 		output file, default file.6 for 6g, etc.
 	-e
 		normally the compiler quits after 10 errors; -e prints all errors
+	-F
+		pass all arguments on the stack.  Otherwise 6g passes the arguments
+		of unexported functions that the package only calls directly in
+		registers.  It cannot see calls from the package's assembly or C
+		files, so Make.pkg adds -F for packages that have any.
 	-L
 		show entire file path when printing line numbers in errors
 	-I dir1 -I dir2
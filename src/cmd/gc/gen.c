@@ -62,6 +62,7 @@ allocparams(void)
 		if(thechar == '5')
 			stksize = rnd(stksize, widthptr);
 		n->xoffset = -stksize;
+		addstkslot(n->xoffset, w, n->type->align);
 	}
 	lineno = lno;
 }
@@ -704,4 +705,26 @@ tempname(Node *n, Type *t)
 		stksize = rnd(stksize, widthptr);
 	n->xoffset = -stksize;
 	n->pun = anyregalloc();
+	addstkslot(n->xoffset, w, t->align);
+}
+
+/*
+ * record a slot given out of the current frame.
+ */
+void
+addstkslot(int32 offset, int32 width, int align)
+{
+	Stkslot *s;
+
+	if(nstkslot >= maxstkslot) {
+		maxstkslot = 2*maxstkslot + 100;
+		s = mal(maxstkslot * sizeof(*s));
+		if(nstkslot > 0)
+			memmove(s, stkslot, nstkslot * sizeof(*s));
+		stkslot = s;
+	}
+	s = &stkslot[nstkslot++];
+	s->offset = offset;
+	s->width = width;
+	s->align = align;
 }
@@ -217,6 +217,7 @@ struct	Node
 	uchar	pun;		// don't registerize variable ONAME
 	uchar	readonly;
 	uchar	implicit;	// don't show in printout
+	uchar	regcall;	// ONAME PFUNC only called directly; see regcall.c
 
 	// most nodes
 	Node*	left;
@@ -624,6 +625,19 @@ struct	Magic
 	int	ua;	// output - adder
 };
 
+/*
+ * stack slots handed out by allocparams
+ * and tempname for the current function.
+ * the back end may lay them out again.
+ */
+typedef	struct	Stkslot	Stkslot;
+struct	Stkslot
+{
+	int32	offset;		// xoffset given out
+	int32	width;
+	uchar	align;
+};
+
 typedef struct	Prog Prog;
 
 struct	Label
@@ -754,6 +768,9 @@ EXTERN	NodeList*	lastconst;
 EXTERN	Node*	lasttype;
 EXTERN	int32	maxarg;
 EXTERN	int32	stksize;		// stack size for current frame
+EXTERN	Stkslot*	stkslot;		// slots of current frame
+EXTERN	int32	nstkslot;
+EXTERN	int32	maxstkslot;
 EXTERN	int32	blockgen;		// max block number
 EXTERN	int32	block;			// current block number
 EXTERN	int	hasdefer;		// flag that curfn has defer statetment
@@ -850,6 +867,13 @@ void	complexmul(Node *nl, Node *nr, Node *res);
 int	complexop(Node *n, Node *res);
 void	nodfconst(Node *n, Type *t, Mpflt* fval);
 
+/*
+ *	cover.c
+ */
+Node*	covdesc(void);
+void	covfunc(Node *fn);
+void	covtables(void);
+
 /*
  *	dcl.c
  */
@@ -905,6 +929,7 @@ Type*	pkgtype(Sym *s);
 /*
  *	gen.c
  */
+void	addstkslot(int32 offset, int32 width, int align);
 void	allocparams(void);
 void	cgen_as(Node *nl, Node *nr);
 void	cgen_callmeth(Node *n, int proc);
@@ -1029,6 +1054,11 @@ Type*	methodfunc(Type *f, Type*);
 Node*	typename(Type *t);
 Sym*	typesym(Type *t);
 
+/*
+ *	regcall.c
+ */
+void	regcalls(NodeList *all);
+
 /*
  *	select.c
  */
@@ -38,6 +38,8 @@ renameinit(Node *n)
  *			throw();			(5)
  *		}
  *		initdone· = 1;				(6)
+ *		// if compiled with -C
+ *			coverregister(&cover·desc)	(6a)
  *		// over all matching imported symbols
  *			<pkg>.init()			(7)
  *		{ <init stmts> }			(8)
@@ -106,7 +108,7 @@ fninit(NodeList *n)
 	}
 
 	n = initfix(n);
-	if(!anyinit(n))
+	if(!anyinit(n) && (!debug['C'] || compiling_runtime))
 		return;
 
 	r = nil;
@@ -146,6 +148,13 @@ fninit(NodeList *n)
 	a = nod(OAS, gatevar, nodintconst(1));
 	r = list(r, a);
 
+	// (6a)
+	if(debug['C'] && !compiling_runtime) {
+		a = nod(OCALL, syslook("coverregister", 0), N);
+		a->list = list1(nod(OADDR, covdesc(), N));
+		r = list(r, a);
+	}
+
 	// (7)
 	for(h=0; h<NHASH; h++)
 	for(s = hash[h]; s != S; s = s->link) {
@@ -76,6 +76,8 @@ usage(void)
 	print("gc: usage: %cg [flags] file.go...\n", thechar);
 	print("flags:\n");
 	// -A is allow use of "any" type, for bootstrapping
+	print("  -C insert code coverage counters\n");
+	print("  -F pass all arguments on the stack\n");
 	print("  -I DIR search for packages in DIR\n");
 	print("  -d print declarations\n");
 	print("  -e no limit on number of errors printed\n");
@@ -208,7 +210,7 @@ main(int argc, char *argv[])
 		linehist(infile, 0, 0);
 
 		curio.infile = infile;
-		curio.bin = Bopen(infile, OREAD);
+		curio.bin = Bopen(infile, OREAD|OMMAP);
 		if(curio.bin == nil) {
 			print("open %s: %r\n", infile);
 			errorexit();
@@ -251,16 +253,21 @@ main(int argc, char *argv[])
 			typecheck(&l->n, Etop);
 	resumetypecopy();
 	resumecheckwidth();
+	regcalls(xtop);
 	for(l=xtop; l; l=l->next)
-		if(l->n->op == ODCLFUNC)
+		if(l->n->op == ODCLFUNC) {
+			covfunc(l->n);
 			funccompile(l->n, 0);
+		}
 	if(nerrors == 0)
 		fninit(xtop);
 	while(closures) {
 		l = closures;
 		closures = nil;
-		for(; l; l=l->next)
+		for(; l; l=l->next) {
+			covfunc(l->n);
 			funccompile(l->n, 1);
+		}
 	}
 	dclchecks();
 
@@ -456,7 +463,7 @@ importfile(Val *f, int line)
 	}
 	importpkg = mkpkg(path);
 
-	imp = Bopen(namebuf, OREAD);
+	imp = Bopen(namebuf, OREAD|OMMAP);
 	if(imp == nil) {
 		yyerror("can't open import: %Z: %r", f->u.sval);
 		errorexit();
@@ -1317,7 +1324,7 @@ getc(void)
 		if(c != 0)
 			curio.cp++;
 	} else
-		c = Bgetc(curio.bin);
+		c = BGETC(curio.bin);
 
 	switch(c) {
 	case 0:
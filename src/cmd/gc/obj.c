@@ -11,15 +11,30 @@
 static	void	outhist(Biobuf *b);
 static	void	dumpglobls(void);
 
+/*
+ * the object is written through one large buffer,
+ * so that even huge packages take few write calls.
+ */
+enum
+{
+	Objbufsize = 1<<20,
+};
+
+static	Biobuf	objbuf;
+
 void
 dumpobj(void)
 {
-	bout = Bopen(outfile, OWRITE);
-	if(bout == nil) {
+	int fd;
+
+	fd = create(outfile, OWRITE, 0664);
+	if(fd < 0) {
 		flusherrors();
 		print("can't create %s: %r\n", outfile);
 		errorexit();
 	}
+	bout = &objbuf;
+	Binits(bout, fd, OWRITE, mal(Objbufsize), Objbufsize);
 
 	Bprint(bout, "go object %s %s %s\n", getgoos(), thestring, getgoversion());
 	Bprint(bout, "  exports automatically generated from\n");
@@ -35,9 +50,15 @@ dumpobj(void)
 
 	dumpglobls();
 	dumptypestructs();
+	covtables();
 	dumpdata();
 	dumpfuncs();
 
+	if(Bflush(bout) < 0 || close(fd) < 0) {
+		flusherrors();
+		print("writing %s: %r\n", outfile);
+		errorexit();
+	}
 	Bterm(bout);
 }
 
@@ -68,8 +89,8 @@ dumpglobls(void)
 void
 Bputname(Biobuf *b, Sym *s)
 {
-	Bprint(b, "%s", s->pkg->prefix);
-	Bputc(b, '.');
+	Bwrite(b, s->pkg->prefix, strlen(s->pkg->prefix));
+	BPUTC(b, '.');
 	Bwrite(b, s->name, strlen(s->name)+1);
 }
 
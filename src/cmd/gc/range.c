@@ -16,6 +16,10 @@ typecheckrange(Node *n)
 	Node *v1, *v2;
 	NodeList *ll;
 
+	// a range statement has no init of its own,
+	// but the coverage counter can go there (see cover.c).
+	typechecklist(n->ninit, Etop);
+
 	// delicate little dance.  see typecheckas2
 	for(ll=n->list; ll; ll=ll->next)
 		if(ll->n->defn != n)
@@ -213,6 +217,14 @@ walkrange(Node *n)
 		break;
 
 	case TSTRING:
+		// for hv1 < len(ha) {
+		//	ohv1 = hv1
+		//	hv2 = int(ha[hv1])
+		//	if hv2 < Runeself { hv1++ } else { hv1, hv2 = stringiter2(ha, hv1) }
+		//	v1, v2 = ohv1, hv2
+		//	...
+		// }
+		// ASCII bytes, the common case, are decoded without a call.
 		ohv1 = nod(OXXX, N, N);
 		tempname(ohv1, types[TINT]);
 
@@ -220,20 +232,35 @@ walkrange(Node *n)
 		tempname(hv1, types[TINT]);
 		init = list(init, nod(OAS, hv1, N));
 
+		hv2 = nod(OXXX, N, N);
+		tempname(hv2, types[TINT]);
+
+		n->ntest = nod(OLT, hv1, nod(OLEN, ha, N));
+
+		body = list1(nod(OAS, ohv1, hv1));
+		tmp = nod(OINDEX, ha, hv1);
+		tmp->etype = 1;	// no bounds check
+		a = nod(OCONV, tmp, N);
+		a->type = types[TINT];
+		body = list(body, nod(OAS, hv2, a));
+
+		a = nod(OIF, N, N);
+		a->ntest = nod(OLT, hv2, nodintconst(Runeself));
+		tmp = nod(OASOP, hv1, nodintconst(1));
+		tmp->etype = OADD;
+		a->nbody = list1(tmp);
 		if(v2 == N)
-			a = nod(OAS, hv1, mkcall("stringiter", types[TINT], nil, ha, hv1));
+			tmp = nod(OAS, hv1, mkcall("stringiter", types[TINT], nil, ha, hv1));
 		else {
-			hv2 = nod(OXXX, N, N);
-			tempname(hv2, types[TINT]);
-			a = nod(OAS2, N, N);
-			a->list = list(list1(hv1), hv2);
+			tmp = nod(OAS2, N, N);
+			tmp->list = list(list1(hv1), hv2);
 			fn = syslook("stringiter2", 0);
-			a->rlist = list1(mkcall1(fn, getoutargx(fn->type), nil, ha, hv1));
+			tmp->rlist = list1(mkcall1(fn, getoutargx(fn->type), nil, ha, hv1));
 		}
-		n->ntest = nod(ONE, hv1, nodintconst(0));
-		n->ntest->ninit = list(list1(nod(OAS, ohv1, hv1)), a);
+		a->nelse = list1(tmp);
+		body = list(body, a);
 
-		body = list1(nod(OAS, v1, ohv1));
+		body = list(body, nod(OAS, v1, ohv1));
 		if(v2 != N)
 			body = list(body, nod(OAS, v2, hv2));
 		break;
@@ -0,0 +1,136 @@
+// Copyright 2011 The Go Authors.  All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/*
+ * find the functions that may take their
+ * arguments in registers (6g only).
+ *
+ * a function keeps the stack convention if
+ * anything but a direct call can reach it:
+ * other packages, go and defer statements,
+ * function values, reflection and cgo exports
+ * (cgo refers to them by value).  what is left
+ * are unexported plain functions of this
+ * package that are only ever called directly.
+ * the back end decides which of those have
+ * signatures that fit the registers, using
+ * the same rule for the caller and the callee.
+ *
+ * calls from the package's own assembly or
+ * C files are not visible here; Make.pkg
+ * compiles packages that have them with -F.
+ *
+ * this runs before the function bodies are
+ * type checked, so names declared later in
+ * the package are still ONONAME.
+ */
+
+#include	"go.h"
+
+static	void	regref(Node*, int);
+
+static void
+regreflist(NodeList *l)
+{
+	for(; l; l=l->next)
+		regref(l->n, 0);
+}
+
+/*
+ * n is used; called is set if n is
+ * the function in a direct call.
+ */
+static void
+regref(Node *n, int called)
+{
+	Node *f;
+
+	if(n == N)
+		return;
+
+	switch(n->op) {
+	case ONONAME:
+		f = n->sym ? n->sym->def : N;
+		if(f != N && f->op == ONAME && f->class == PFUNC && !called)
+			f->regcall = 0;
+		return;
+
+	case ONAME:
+		if(n->class == PFUNC && !called)
+			n->regcall = 0;
+		return;
+
+	case OLITERAL:
+	case OTYPE:
+	case OPACK:
+		return;
+
+	case OCALL:
+	case OCALLFUNC:
+		regref(n->left, 1);
+		regreflist(n->list);
+		return;
+
+	case OPROC:
+	case ODEFER:
+		// the runtime calls these
+		// through the stack convention.
+		f = n->left;
+		if(f != N && (f->op == OCALL || f->op == OCALLFUNC)) {
+			regref(f->left, 0);
+			regreflist(f->list);
+			return;
+		}
+		break;
+	}
+
+	regref(n->left, 0);
+	regref(n->right, 0);
+	regreflist(n->list);
+	regreflist(n->rlist);
+	regreflist(n->ninit);
+	regref(n->ntest, 0);
+	regref(n->nincr, 0);
+	regreflist(n->nbody);
+	regreflist(n->nelse);
+}
+
+static int
+regcandidate(Node *fn)
+{
+	Node *n;
+	char *name;
+
+	n = fn->nname;
+	if(n == N || n->op != ONAME || n->class != PFUNC || n->sym == S)
+		return 0;
+	if(fn->nbody == nil || fn->type == T || fn->type->thistuple > 0)
+		return 0;
+	name = n->sym->name;
+	if(exportname(name) || strncmp(name, "init", 4) == 0 || isblank(n))
+		return 0;
+	if(strcmp(name, "main") == 0 && strcmp(localpkg->name, "main") == 0)
+		return 0;
+	return 1;
+}
+
+void
+regcalls(NodeList *all)
+{
+	NodeList *l;
+
+	if(thechar != '6' || debug['F'] || compiling_runtime)
+		return;
+
+	for(l=all; l; l=l->next)
+		if(l->n->op == ODCLFUNC && regcandidate(l->n))
+			l->n->nname->regcall = 1;
+
+	for(l=all; l; l=l->next) {
+		if(l->n->op == ODCLFUNC)
+			regreflist(l->n->nbody);
+		else
+			regref(l->n, 0);
+	}
+}
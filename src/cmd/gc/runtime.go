@@ -15,6 +15,7 @@ func panicindex()
 func panicslice()
 func throwreturn()
 func throwinit()
+func coverregister(*uint8)
 
 func panic(interface{})
 func recover(*int32) interface{}
@@ -41,6 +42,7 @@ func append()
 func appendslice(typ *byte, x any, y []any) any
 
 func cmpstring(string, string) int
+func eqstring(string, string) bool
 func slicestring(string, int, int) string
 func slicestring1(string, int) string
 func intstring(int64) string
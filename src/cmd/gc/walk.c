@@ -1293,11 +1293,20 @@ walkexpr(Node **np, NodeList **init)
 			n->right = cheapexpr(n->right, init);
 		}
 
-		// sys_cmpstring(s1, s2) :: 0
-		r = mkcall("cmpstring", types[TINT], init,
-			conv(n->left, types[TSTRING]),
-			conv(n->right, types[TSTRING]));
-		r = nod(n->etype, r, nodintconst(0));
+		if(n->etype == OEQ || n->etype == ONE) {
+			// sys_eqstring(s1, s2)
+			r = mkcall("eqstring", types[TBOOL], init,
+				conv(n->left, types[TSTRING]),
+				conv(n->right, types[TSTRING]));
+			if(n->etype == ONE)
+				r = nod(ONOT, r, N);
+		} else {
+			// sys_cmpstring(s1, s2) :: 0
+			r = mkcall("cmpstring", types[TINT], init,
+				conv(n->left, types[TSTRING]),
+				conv(n->right, types[TSTRING]));
+			r = nod(n->etype, r, nodintconst(0));
+		}
 
 		// quick check of len before full compare for == or !=
 		if(n->etype == OEQ || n->etype == ONE) {
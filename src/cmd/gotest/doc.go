@@ -52,8 +52,10 @@ The resulting test binary, called (for amd64) 6.out, has several flags.
 
 Usage:
 	6.out [-test.v] [-test.run pattern] [-test.bench pattern] \
-		[-test.cpuprofile=cpu.out] \
-		[-test.memprofile=mem.out] [-test.memprofilerate=1]
+		[-test.cpuprofile=cpu.out] [-test.trace=trace.out] \
+		[-test.memprofile=mem.out] [-test.memprofilerate=1] \
+		[-test.blockprofile=block.out] [-test.blockprofilerate=1] \
+		[-test.cpu=1,2,4]
 
 The -test.v flag causes the tests to be logged as they run.  The
 -test.run flag causes only those tests whose names match the regular
@@ -63,7 +65,11 @@ If all specified tests pass, 6.out prints the word PASS and exits with
 a 0 exit code.  If any tests fail, it prints error details, the word
 FAIL, and exits with a non-zero code.  The -test.bench flag is
 analogous to the -test.run flag, but applies to benchmarks.  No
-benchmarks run by default.
+benchmarks run by default.  Each benchmark prints one line,
+	name	iterations	time ns/op
+separated by tabs.  The -test.cpu flag gives a comma-separated list of
+GOMAXPROCS values; each benchmark is run once for each value, and the
+value is appended to its name, as in BenchmarkChanSync-4, unless it is 1.
 
 The -test.cpuprofile flag causes the testing software to write a CPU
 profile to the specified file before exiting.
@@ -81,6 +87,17 @@ the environment variable GOGC=off to disable the garbage collector,
 provided the test can run in the available memory without garbage
 collection.
 
+The -test.blockprofile flag causes the testing software to write a
+contention profile, recording where goroutines blocked on channels,
+semaphores and runtime locks and for how long, to the specified file
+when all tests are complete.  The -test.blockprofilerate flag sets
+runtime.BlockProfileRate; the default when -test.blockprofile is
+given is 1, recording every blocking event.
+
+The -test.trace flag causes the testing software to write an execution
+trace, which the gotrace command summarizes, to the specified file
+before exiting.
+
 Use -test.run or -test.bench to limit profiling to a particular test
 or benchmark.
 
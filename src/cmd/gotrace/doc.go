@@ -0,0 +1,30 @@
+// Copyright 2011 The Go Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/*
+
+Gotrace summarizes execution traces written by runtime/pprof.StartTrace
+or by the -test.trace flag of gotest.
+
+Usage:
+
+	gotrace [flag] binary trace.out
+
+The binary is the program that wrote the trace; it is used to translate
+program counters in the trace into function names.
+
+By default gotrace prints a summary: the length of the trace, the garbage
+collections that ran during it, and, for the goroutines started at each
+go statement, how long they spent running, waiting for a cpu, blocked
+(by reason) and in system calls.  Time spent waiting for a cpu or blocked
+is the usual explanation for a slow request.
+
+The flags are:
+	-timeline
+		Print every event, in time order, instead of the summary.
+	-g id
+		Only consider the goroutine with the given id.
+
+*/
+package documentation
@@ -0,0 +1,379 @@
+// Copyright 2011 The Go Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+// Gotrace summarizes execution traces.
+// See doc.go for more information.
+package main
+
+import (
+	"debug/elf"
+	"debug/gosym"
+	"flag"
+	"fmt"
+	"io/ioutil"
+	"os"
+	"sort"
+	"strings"
+)
+
+var (
+	timeline = flag.Bool("timeline", false, "print every event instead of a summary")
+	goid     = flag.Uint64("g", 0, "only consider the goroutine with this id")
+)
+
+var symtab *gosym.Table
+
+func usage() {
+	fmt.Fprintf(os.Stderr, "usage: gotrace [flag] binary trace.out\n")
+	flag.PrintDefaults()
+	os.Exit(2)
+}
+
+func fatal(format string, args ...interface{}) {
+	fmt.Fprintf(os.Stderr, "gotrace: "+format+"\n", args...)
+	os.Exit(1)
+}
+
+func main() {
+	flag.Usage = usage
+	flag.Parse()
+	if flag.NArg() != 2 {
+		usage()
+	}
+
+	var err os.Error
+	symtab, err = loadSymbols(flag.Arg(0))
+	if err != nil {
+		fmt.Fprintf(os.Stderr, "gotrace: %s: %s; printing raw pcs\n", flag.Arg(0), err)
+	}
+	data, err := ioutil.ReadFile(flag.Arg(1))
+	if err != nil {
+		fatal("%s", err)
+	}
+	t, err := Parse(data)
+	if err != nil {
+		fatal("%s: %s", flag.Arg(1), err)
+	}
+	if len(t.Events) == 0 {
+		fatal("%s: trace has no events", flag.Arg(1))
+	}
+
+	if *timeline {
+		printTimeline(t)
+	} else {
+		printSummary(t)
+	}
+}
+
+func loadSymbols(file string) (*gosym.Table, os.Error) {
+	f, err := elf.Open(file)
+	if err != nil {
+		return nil, err
+	}
+	defer f.Close()
+	text := f.Section(".text")
+	sym := f.Section(".gosymtab")
+	pcln := f.Section(".gopclntab")
+	if text == nil || sym == nil || pcln == nil {
+		return nil, os.NewError("no Go symbol table")
+	}
+	symdat, err := sym.Data()
+	if err != nil {
+		return nil, err
+	}
+	pclndat, err := pcln.Data()
+	if err != nil {
+		return nil, err
+	}
+	return gosym.NewTable(symdat, gosym.NewLineTable(pclndat, text.Addr))
+}
+
+// frame describes the function containing the return address pc.
+func frame(pc uint64) string {
+	if symtab != nil {
+		if file, line, fn := symtab.PCToLine(pc - 1); fn != nil {
+			return fmt.Sprintf("%s %s:%d", fn.Name, file, line)
+		}
+	}
+	return fmt.Sprintf("%#x", pc)
+}
+
+// site describes the first frame of a stack outside the runtime,
+// which is the code that caused the event.
+func site(t *Trace, stk uint64) string {
+	pcs := t.Stacks[stk]
+	for _, pc := range pcs {
+		if symtab == nil {
+			break
+		}
+		if fn := symtab.PCToFunc(pc - 1); fn != nil && !strings.HasPrefix(fn.Name, "runtime.") {
+			return frame(pc)
+		}
+	}
+	if len(pcs) > 0 {
+		return frame(pcs[0])
+	}
+	return "?"
+}
+
+func ms(ns int64) string {
+	return fmt.Sprintf("%.3fms", float64(ns)/1e6)
+}
+
+func printTimeline(t *Trace) {
+	t0 := t.Events[0].Ts
+	for _, ev := range t.Events {
+		if *goid != 0 && (ev.G != *goid || ev.Type == EvGCStart || ev.Type == EvGCDone) {
+			continue
+		}
+		fmt.Printf("%12.6f M%-3d ", float64(ev.Ts-t0)/1e6, ev.M)
+		switch ev.Type {
+		case EvGCStart:
+			fmt.Printf("%-6s %s\n", "", evNames[ev.Type])
+		case EvGCDone:
+			fmt.Printf("%-6s %-10s heap %d KB\n", "", evNames[ev.Type], ev.Arg>>10)
+		default:
+			fmt.Printf("G%-5d %-10s", ev.G, evNames[ev.Type])
+			switch ev.Type {
+			case EvGoState:
+				fmt.Printf(" status %d", ev.Arg)
+			case EvGoCreate:
+				fmt.Printf(" by G%d at %s", ev.Arg, site(t, ev.Stk))
+			case EvGoBlock:
+				fmt.Printf(" %s at %s", blockName(ev.Arg), site(t, ev.Stk))
+			case EvGoUnblock:
+				fmt.Printf(" by G%d at %s", ev.Arg, site(t, ev.Stk))
+			}
+			fmt.Printf("\n")
+		}
+	}
+}
+
+func blockName(reason uint64) string {
+	if reason < uint64(len(blockNames)) {
+		return blockNames[reason]
+	}
+	return "other"
+}
+
+// Goroutine states, for the summary.
+const (
+	stRunnable = iota
+	stRunning
+	stBlocked
+	stSyscall
+	stDead
+)
+
+type G struct {
+	id      uint64
+	site    string
+	state   int
+	reason  uint64
+	since   int64
+	woken   bool // unblocked before its GoBlock event was recorded
+	running int64
+	waiting int64 // runnable, waiting for a cpu
+	blocked []int64
+	syscall int64
+}
+
+// set accounts for the time g spent in its current state
+// and moves it to state st at time ts.
+func (g *G) set(st int, ts int64, s *summary) {
+	d := ts - g.since
+	switch g.state {
+	case stRunning:
+		g.running += d
+	case stRunnable:
+		g.waiting += d
+		s.noteWait(g, g.since, d)
+	case stBlocked:
+		g.blocked[g.reason] += d
+	case stSyscall:
+		g.syscall += d
+	}
+	g.state = st
+	g.since = ts
+}
+
+type wait struct {
+	g     *G
+	start int64
+	d     int64
+}
+
+type summary struct {
+	gs      map[uint64]*G
+	waits   []wait // longest waits for a cpu
+	gcs     int
+	gcstart int64
+	gcpause int64
+	gcmax   int64
+	heap    uint64
+}
+
+const maxWaits = 10
+
+func (s *summary) noteWait(g *G, start, d int64) {
+	if len(s.waits) == maxWaits && d <= s.waits[maxWaits-1].d {
+		return
+	}
+	if len(s.waits) < maxWaits {
+		s.waits = append(s.waits, wait{})
+	}
+	i := len(s.waits) - 1
+	for ; i > 0 && s.waits[i-1].d < d; i-- {
+		s.waits[i] = s.waits[i-1]
+	}
+	s.waits[i] = wait{g, start, d}
+}
+
+func (s *summary) g(id uint64, site string, st int, ts int64) *G {
+	g := s.gs[id]
+	if g == nil {
+		g = &G{id: id, site: site, state: st, since: ts, blocked: make([]int64, len(blockNames)+1)}
+		s.gs[id] = g
+	}
+	return g
+}
+
+func printSummary(t *Trace) {
+	s := &summary{gs: make(map[uint64]*G)}
+	start, end := t.Events[0].Ts, t.Events[len(t.Events)-1].Ts
+	for _, ev := range t.Events {
+		switch ev.Type {
+		case EvGCStart:
+			s.gcstart = ev.Ts
+			continue
+		case EvGCDone:
+			d := ev.Ts - s.gcstart
+			s.gcs++
+			s.gcpause += d
+			if d > s.gcmax {
+				s.gcmax = d
+			}
+			s.heap = ev.Arg
+			continue
+		case EvGoState:
+			if s.gs[ev.G] != nil {
+				continue
+			}
+			st := stRunnable
+			switch ev.Arg {
+			case Grunning:
+				st = stRunning
+			case Gsyscall:
+				st = stSyscall
+			case Gwaiting:
+				st = stBlocked
+			}
+			g := s.g(ev.G, "(existing at start of trace)", st, ev.Ts)
+			g.reason = uint64(len(blockNames))
+			continue
+		case EvGoCreate:
+			s.g(ev.G, site(t, ev.Stk), stRunnable, ev.Ts)
+			continue
+		}
+
+		g := s.g(ev.G, "(existing at start of trace)", stRunning, start)
+		switch ev.Type {
+		case EvGoStart:
+			g.set(stRunning, ev.Ts, s)
+		case EvGoSched, EvGoSysBlock:
+			g.set(stRunnable, ev.Ts, s)
+		case EvGoEnd:
+			g.set(stDead, ev.Ts, s)
+		case EvGoBlock:
+			// A goroutine can be woken between deciding to
+			// block and recording the event.
+			if g.woken {
+				g.woken = false
+				g.set(stRunnable, ev.Ts, s)
+				break
+			}
+			g.set(stBlocked, ev.Ts, s)
+			g.reason = ev.Arg
+			if g.reason > uint64(len(blockNames)) {
+				g.reason = uint64(len(blockNames))
+			}
+		case EvGoUnblock:
+			if g.state == stBlocked {
+				g.set(stRunnable, ev.Ts, s)
+			} else if g.state == stRunning {
+				g.woken = true
+			}
+		case EvGoSysCall:
+			g.set(stSyscall, ev.Ts, s)
+		case EvGoSysExit:
+			if g.state == stSyscall {
+				g.set(stRunning, ev.Ts, s)
+			}
+		}
+	}
+	for _, g := range s.gs {
+		g.set(stDead, end, s)
+	}
+
+	fmt.Printf("trace: %s, %d goroutines\n", ms(end-start), len(s.gs))
+	if s.gcs > 0 {
+		fmt.Printf("gc: %d collections, %s total pause, %s max, %d KB heap after last\n",
+			s.gcs, ms(s.gcpause), ms(s.gcmax), s.heap>>10)
+	}
+
+	// Group goroutines by creation site.
+	sites := make(map[string]*G)
+	counts := make(map[string]int)
+	var list []*G
+	for _, g := range s.gs {
+		if *goid != 0 && g.id != *goid {
+			continue
+		}
+		sum := sites[g.site]
+		if sum == nil {
+			sum = &G{site: g.site, blocked: make([]int64, len(g.blocked))}
+			sites[g.site] = sum
+			list = append(list, sum)
+		}
+		counts[g.site]++
+		sum.running += g.running
+		sum.waiting += g.waiting
+		sum.syscall += g.syscall
+		for i, d := range g.blocked {
+			sum.blocked[i] += d
+		}
+	}
+	sort.Sort(byRunning(list))
+
+	fmt.Printf("\ngoroutines by creation site:\n")
+	fmt.Printf("%6s %12s %12s %12s %12s  %s\n", "count", "running", "runnable", "blocked", "syscall", "site")
+	for _, sum := range list {
+		var blocked int64
+		var why []string
+		for i, d := range sum.blocked {
+			blocked += d
+			if d > 0 {
+				why = append(why, blockName(uint64(i))+" "+ms(d))
+			}
+		}
+		fmt.Printf("%6d %12s %12s %12s %12s  %s\n", counts[sum.site],
+			ms(sum.running), ms(sum.waiting), ms(blocked), ms(sum.syscall), sum.site)
+		if len(why) > 0 {
+			fmt.Printf("%6s blocked: %s\n", "", strings.Join(why, ", "))
+		}
+	}
+
+	if len(s.waits) > 0 && *goid == 0 {
+		fmt.Printf("\nlongest waits for a cpu:\n")
+		for _, w := range s.waits {
+			fmt.Printf("%12s at %12s G%-5d %s\n", ms(w.d), ms(w.start-start), w.g.id, w.g.site)
+		}
+	}
+}
+
+type byRunning []*G
+
+func (x byRunning) Len() int           { return len(x) }
+func (x byRunning) Swap(i, j int)      { x[i], x[j] = x[j], x[i] }
+func (x byRunning) Less(i, j int) bool { return x[i].running > x[j].running }
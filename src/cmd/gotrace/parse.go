@@ -0,0 +1,184 @@
+// Copyright 2011 The Go Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+package main
+
+import (
+	"bytes"
+	"fmt"
+	"os"
+	"sort"
+)
+
+// Event types, as listed in ../../pkg/runtime/runtime.h.
+const (
+	EvNone = iota
+	EvBatch
+	EvStack
+	EvGoState
+	EvGoCreate
+	EvGoStart
+	EvGoSched
+	EvGoEnd
+	EvGoBlock
+	EvGoUnblock
+	EvGoSysCall
+	EvGoSysExit
+	EvGoSysBlock
+	EvGCStart
+	EvGCDone
+	EvCount
+)
+
+var evNames = [EvCount]string{
+	EvGoState:    "GoState",
+	EvGoCreate:   "GoCreate",
+	EvGoStart:    "GoStart",
+	EvGoSched:    "GoSched",
+	EvGoEnd:      "GoEnd",
+	EvGoBlock:    "GoBlock",
+	EvGoUnblock:  "GoUnblock",
+	EvGoSysCall:  "GoSysCall",
+	EvGoSysExit:  "GoSysExit",
+	EvGoSysBlock: "GoSysBlock",
+	EvGCStart:    "GCStart",
+	EvGCDone:     "GCDone",
+}
+
+// Number of arguments after the time delta.
+var evArgs = [EvCount]int{
+	EvGoState:    2,
+	EvGoCreate:   3,
+	EvGoStart:    1,
+	EvGoSched:    1,
+	EvGoEnd:      1,
+	EvGoBlock:    3,
+	EvGoUnblock:  3,
+	EvGoSysCall:  1,
+	EvGoSysExit:  1,
+	EvGoSysBlock: 1,
+	EvGCStart:    0,
+	EvGCDone:     1,
+}
+
+// Block reasons, the argument of EvGoBlock.
+var blockNames = []string{
+	"chan send",
+	"chan recv",
+	"select",
+	"sync",
+	"finalizer wait",
+}
+
+// Goroutine states, the argument of EvGoState.
+const (
+	Gidle = iota
+	Grunnable
+	Grunning
+	Gsyscall
+	Gwaiting
+)
+
+const header = "go trace 1\n"
+
+// An Event is a decoded trace event.
+type Event struct {
+	Ts   int64 // nanoseconds
+	M    int
+	Type byte
+	G    uint64
+	Arg  uint64 // EvGoState status, EvGoCreate parent, EvGoBlock reason, EvGoUnblock waker, EvGCDone heap
+	Stk  uint64 // stack id, or 0
+	seq  int    // position in trace, to break timestamp ties
+}
+
+// A Trace is a decoded trace, with the events in time order.
+type Trace struct {
+	Events []*Event
+	Stacks map[uint64][]uint64
+}
+
+type byTime []*Event
+
+func (x byTime) Len() int      { return len(x) }
+func (x byTime) Swap(i, j int) { x[i], x[j] = x[j], x[i] }
+func (x byTime) Less(i, j int) bool {
+	if x[i].Ts != x[j].Ts {
+		return x[i].Ts < x[j].Ts
+	}
+	return x[i].seq < x[j].seq
+}
+
+// Parse decodes a trace.
+func Parse(data []byte) (*Trace, os.Error) {
+	if !bytes.HasPrefix(data, []byte(header)) {
+		return nil, fmt.Errorf("not a trace (bad header)")
+	}
+	data = data[len(header):]
+
+	var err os.Error
+	next := func() uint64 {
+		var v uint64
+		for shift := uint(0); shift < 64; shift += 7 {
+			if len(data) == 0 {
+				break
+			}
+			b := data[0]
+			data = data[1:]
+			v |= uint64(b&0x7f) << shift
+			if b < 0x80 {
+				return v
+			}
+		}
+		err = fmt.Errorf("truncated or corrupt trace")
+		return 0
+	}
+
+	t := &Trace{Stacks: make(map[uint64][]uint64)}
+	var ts int64
+	mid := -1
+	for len(data) > 0 && err == nil {
+		typ := data[0]
+		data = data[1:]
+		switch {
+		case typ == EvBatch:
+			mid = int(next())
+			ts = int64(next())
+		case typ == EvStack:
+			id := next()
+			n := next()
+			if n > uint64(len(data)) {
+				return nil, fmt.Errorf("corrupt stack %d", id)
+			}
+			stk := make([]uint64, n)
+			for i := range stk {
+				stk[i] = next()
+			}
+			t.Stacks[id] = stk
+		case typ > EvStack && typ < EvCount:
+			if mid < 0 {
+				return nil, fmt.Errorf("event before first batch")
+			}
+			ts += int64(next())
+			ev := &Event{Ts: ts, M: mid, Type: typ, seq: len(t.Events)}
+			var args [3]uint64
+			for i := 0; i < evArgs[typ]; i++ {
+				args[i] = next()
+			}
+			if typ == EvGCDone {
+				ev.Arg = args[0]
+			} else {
+				ev.G, ev.Arg, ev.Stk = args[0], args[1], args[2]
+			}
+			t.Events = append(t.Events, ev)
+		default:
+			return nil, fmt.Errorf("unknown event type %d", typ)
+		}
+	}
+	if err != nil {
+		return nil, err
+	}
+	sort.Sort(byTime(t.Events))
+	return t, nil
+}
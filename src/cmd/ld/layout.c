@@ -0,0 +1,731 @@
+// Copyright 2011 The Go Authors.  All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+// Profile-guided code layout.
+//
+// readprof reads a CPU profile written by runtime/pprof together
+// with the binary that wrote it, and symbolizes every sample through
+// that binary's own Go symbol table and pc/line table.  The samples
+// are kept by function name and absolute line number, which is how
+// the new link can find them again as long as the sources have not
+// changed.  They are used twice:
+//
+//	- follow asks proflinesamples whether a block ran, and lays out
+//	  blocks that did not (and blocks that end in a panic) after the
+//	  hot code of their function;
+//	- proforder moves the functions that got samples to the front of
+//	  the text segment, placing each caller next to the callee it
+//	  calls most (the greedy chain merging of Pettis and Hansen,
+//	  PLDI 1990), so that the hot code shares few pages and cache sets.
+
+#include	"l.h"
+#include	"../ld/lib.h"
+
+enum
+{
+	NPHASH = 4093,
+	ColdMin = 50,	// samples a function needs before unsampled lines count as cold
+};
+
+typedef struct Pfunc Pfunc;
+typedef struct Ptext Ptext;
+typedef struct Pline Pline;
+typedef struct Pedge Pedge;
+
+struct Pfunc
+{
+	char*	name;
+	int32	self;		// samples whose pc is in the function
+	int32	total;		// frames of the function in all samples
+	Pfunc*	hash;
+
+	// in this link
+	Sym*	sym;
+	int32	index;		// position of sym in textp
+	int	used;		// has samples or call edges
+
+	// chain merging
+	Pfunc*	head;		// first function in the chain
+	Pfunc*	tail;		// last function, kept in the head
+	Pfunc*	next;
+	int32	weight;		// samples in the chain, kept in the head
+};
+
+struct Ptext
+{
+	uvlong	entry;
+	Pfunc*	f;
+};
+
+struct Pline
+{
+	Pfunc*	f;
+	int32	line;
+	int32	n;
+	Pline*	hash;
+};
+
+struct Pedge
+{
+	Pfunc*	from;
+	Pfunc*	to;
+	int32	n;
+	Pedge*	hash;
+	Pedge*	link;
+};
+
+static	Pfunc*	pfhash[NPHASH];
+static	Pline*	plhash[NPHASH];
+static	Pedge*	pehash[NPHASH];
+static	Pedge*	pedges;
+static	int32	npedge;
+
+static	Ptext*	ptext;
+static	int32	nptext;
+static	uvlong	ptextend;
+
+static	uvlong*	lnpc;
+static	int32*	lnline;
+static	int32	nln;
+
+static	int32	nsample;
+
+static uint32
+strhash(char *s)
+{
+	uint32 h;
+
+	h = 0;
+	while(*s)
+		h = h*3 + *(uchar*)s++;
+	return h % NPHASH;
+}
+
+static Pfunc*
+pflookup(char *name, int creat)
+{
+	Pfunc *f;
+	uint32 h;
+
+	h = strhash(name);
+	for(f = pfhash[h]; f != nil; f = f->hash)
+		if(strcmp(f->name, name) == 0)
+			return f;
+	if(!creat)
+		return nil;
+	f = mal(sizeof *f);
+	f->name = name;
+	f->hash = pfhash[h];
+	pfhash[h] = f;
+	return f;
+}
+
+static void
+addline(Pfunc *f, int32 line, int32 n)
+{
+	Pline *l;
+	uint32 h;
+
+	h = ((uintptr)f*31 + line) % NPHASH;
+	for(l = plhash[h]; l != nil; l = l->hash)
+		if(l->f == f && l->line == line) {
+			l->n += n;
+			return;
+		}
+	l = mal(sizeof *l);
+	l->f = f;
+	l->line = line;
+	l->n = n;
+	l->hash = plhash[h];
+	plhash[h] = l;
+}
+
+static void
+addedge(Pfunc *from, Pfunc *to, int32 n)
+{
+	Pedge *e;
+	uint32 h;
+
+	h = ((uintptr)from*31 + (uintptr)to) % NPHASH;
+	for(e = pehash[h]; e != nil; e = e->hash)
+		if(e->from == from && e->to == to) {
+			e->n += n;
+			return;
+		}
+	e = mal(sizeof *e);
+	e->from = from;
+	e->to = to;
+	e->n = n;
+	e->hash = pehash[h];
+	pehash[h] = e;
+	e->link = pedges;
+	pedges = e;
+	npedge++;
+}
+
+static uchar*
+readall(char *file, vlong *len)
+{
+	int fd;
+	vlong n;
+	uchar *b;
+
+	fd = open(file, OREAD);
+	if(fd < 0)
+		return nil;
+	n = seek(fd, 0, 2);
+	if(n < 0 || seek(fd, 0, 0) < 0 || (uint32)n != n) {
+		close(fd);
+		return nil;
+	}
+	b = mal(n+1);
+	if(readn(fd, b, n) != n) {
+		close(fd);
+		return nil;
+	}
+	close(fd);
+	*len = n;
+	return b;
+}
+
+/*
+ * find the Go symbol table and pc/line table in an ELF binary.
+ */
+static int
+elfgosyms(uchar *b, vlong len, int *ptrsize, int *quant, uchar **sym, vlong *nsym, uchar **ln, vlong *nln)
+{
+	int i, shnum, shentsize, shstrndx;
+	uvlong shoff, off, size, stroff;
+	uchar *sh, *name;
+
+	if(len < 64 || memcmp(b, "\177ELF", 4) != 0 || b[5] != 1)
+		return 0;
+	*quant = 1;
+	if(le16(b+18) == 40)	// EM_ARM
+		*quant = 4;
+	switch(b[4]) {
+	default:
+		return 0;
+	case 1:
+		*ptrsize = 4;
+		shoff = le32(b+32);
+		shentsize = le16(b+46);
+		shnum = le16(b+48);
+		shstrndx = le16(b+50);
+		break;
+	case 2:
+		*ptrsize = 8;
+		shoff = le64(b+40);
+		shentsize = le16(b+58);
+		shnum = le16(b+60);
+		shstrndx = le16(b+62);
+		break;
+	}
+	if(shstrndx >= shnum || shoff + shnum*shentsize > len)
+		return 0;
+
+	sh = b + shoff + shstrndx*shentsize;
+	if(*ptrsize == 8)
+		stroff = le64(sh+24);
+	else
+		stroff = le32(sh+16);
+
+	*sym = nil;
+	*nsym = 0;
+	*ln = nil;
+	*nln = 0;
+	for(i=0; i<shnum; i++) {
+		sh = b + shoff + i*shentsize;
+		if(*ptrsize == 8) {
+			off = le64(sh+24);
+			size = le64(sh+32);
+		} else {
+			off = le32(sh+16);
+			size = le32(sh+20);
+		}
+		if(stroff + le32(sh) >= len || off + size > len)
+			continue;
+		name = b + stroff + le32(sh);
+		if(strcmp((char*)name, ".gosymtab") == 0) {
+			*sym = b + off;
+			*nsym = size;
+		}
+		if(strcmp((char*)name, ".gopclntab") == 0) {
+			*ln = b + off;
+			*nln = size;
+		}
+	}
+	return *sym != nil && *ln != nil && *nsym > 0 && *nln > 0;
+}
+
+static int
+ptextcmp(const void *va, const void *vb)
+{
+	Ptext *a, *b;
+
+	a = (Ptext*)va;
+	b = (Ptext*)vb;
+	if(a->entry < b->entry)
+		return -1;
+	if(a->entry > b->entry)
+		return 1;
+	return 0;
+}
+
+/*
+ * collect the text symbols of the Go symbol table,
+ * in the format written by putsymb.
+ */
+static void
+loadsyms(uchar *p, vlong len)
+{
+	uchar *ep;
+	char *name;
+	uvlong v;
+	int t, mtext;
+
+	ep = p + len;
+	mtext = 0;
+	while(p+5 <= ep) {
+		v = be32(p);
+		t = p[4];
+		p += 5;
+		if((t & 0x80) == 0)
+			break;
+		t &= 0x7f;
+		if(t == 'z' || t == 'Z') {
+			p++;
+			while(p+2 <= ep && (p[0] != 0 || p[1] != 0))
+				p += 2;
+			p += 2;
+			name = nil;
+		} else {
+			name = (char*)p;
+			while(p < ep && *p != 0)
+				p++;
+			p++;
+		}
+		p += 4;	// go type
+		if(p > ep)
+			break;
+		if(t != 'T' && t != 't')
+			continue;
+		if(strcmp(name, "etext") == 0) {
+			ptextend = v;
+			continue;
+		}
+		if(strcmp(name, "text") == 0)
+			continue;
+		if(nptext >= mtext) {
+			mtext = mtext*2 + 1024;
+			ptext = realloc(ptext, mtext*sizeof ptext[0]);
+			if(ptext == nil) {
+				diag("out of memory");
+				errorexit();
+			}
+		}
+		ptext[nptext].entry = v;
+		ptext[nptext].f = pflookup(name, 1);
+		nptext++;
+	}
+	qsort(ptext, nptext, sizeof ptext[0], ptextcmp);
+	if(ptextend == 0 && nptext > 0)
+		ptextend = ptext[nptext-1].entry + 4096;
+}
+
+/*
+ * decode the pc/line table the way the runtime's splitpcln does.
+ */
+static void
+loadpcln(uchar *p, vlong len, int quant)
+{
+	uchar *ep;
+	uvlong pc;
+	int32 line, mln;
+
+	if(nptext == 0)
+		return;
+	ep = p + len;
+	pc = ptext[0].entry;
+	line = 0;
+	mln = 0;
+	for(;;) {
+		while(p < ep && *p > 128)
+			pc += quant * (*p++ - 128);
+		if(p >= ep)
+			break;
+		if(*p == 0) {
+			if(p+5 > ep)
+				break;
+			line += be32(p+1);
+			p += 5;
+		} else if(*p <= 64)
+			line += *p++;
+		else
+			line -= *p++ - 64;
+		if(nln >= mln) {
+			mln = mln*2 + 4096;
+			lnpc = realloc(lnpc, mln*sizeof lnpc[0]);
+			lnline = realloc(lnline, mln*sizeof lnline[0]);
+			if(lnpc == nil || lnline == nil) {
+				diag("out of memory");
+				errorexit();
+			}
+		}
+		lnpc[nln] = pc;
+		lnline[nln] = line;
+		nln++;
+		pc += quant;
+	}
+}
+
+static Pfunc*
+pcfunc(uvlong pc)
+{
+	int32 lo, hi, m;
+
+	if(nptext == 0 || pc < ptext[0].entry || pc >= ptextend)
+		return nil;
+	lo = 0;
+	hi = nptext;
+	while(hi - lo > 1) {
+		m = (lo+hi)/2;
+		if(ptext[m].entry <= pc)
+			lo = m;
+		else
+			hi = m;
+	}
+	return ptext[lo].f;
+}
+
+static int32
+pcline(uvlong pc)
+{
+	int32 lo, hi, m;
+
+	if(nln == 0 || pc < lnpc[0])
+		return 0;
+	lo = 0;
+	hi = nln;
+	while(hi - lo > 1) {
+		m = (lo+hi)/2;
+		if(lnpc[m] <= pc)
+			lo = m;
+		else
+			hi = m;
+	}
+	return lnline[lo];
+}
+
+/*
+ * the profile is a sequence of machine words:
+ * a header 0, 3, 0, period, 0, then one record
+ * count, n, pc[0], ..., pc[n-1] per distinct stack.
+ * pc[0] is where the signal arrived; the others are
+ * return addresses, which are looked up one byte back
+ * so that they land in the calling instruction.
+ * frames outside the text segment, like the profiling
+ * labels set by runtime/pprof, are skipped.
+ */
+static void
+loadsamples(uchar *b, vlong len, int ptrsize)
+{
+	uvlong *w, pc;
+	vlong i, n, nw;
+	int32 c, k;
+	Pfunc *f, *callee;
+
+	nw = len/ptrsize;
+	w = mal(nw*sizeof w[0]);
+	for(i=0; i<nw; i++) {
+		if(ptrsize == 8)
+			w[i] = le64(b + i*8);
+		else
+			w[i] = le32(b + i*4);
+	}
+	if(nw < 5 || w[0] != 0 || w[1] != 3) {
+		diag("not a cpu profile");
+		errorexit();
+	}
+	for(i=5; i+2 <= nw; i += 2+n) {
+		c = w[i];
+		n = w[i+1];
+		if(i+2+n > nw)
+			break;
+		if(c == 0)
+			continue;
+		nsample += c;
+		callee = nil;
+		for(k=0; k<n; k++) {
+			pc = w[i+2+k];
+			if(k > 0)
+				pc--;
+			f = pcfunc(pc);
+			if(f == nil) {
+				callee = nil;
+				continue;
+			}
+			if(k == 0)
+				f->self += c;
+			f->total += c;
+			addline(f, pcline(pc), c);
+			if(callee != nil && callee != f)
+				addedge(f, callee, c);
+			callee = f;
+		}
+	}
+}
+
+void
+readprof(char *prof, char *bin)
+{
+	uchar *b, *pb, *sym, *ln;
+	vlong n, np, nsym, nln;
+	int ptrsize, quant;
+
+	if(debug['v'])
+		Bprint(&bso, "%5.2f readprof\n", cputime());
+	Bflush(&bso);
+
+	pb = readall(prof, &np);
+	if(pb == nil) {
+		diag("cannot read profile %s: %r", prof);
+		errorexit();
+	}
+	b = readall(bin, &n);
+	if(b == nil) {
+		diag("cannot read profiled binary %s: %r", bin);
+		errorexit();
+	}
+	if(!elfgosyms(b, n, &ptrsize, &quant, &sym, &nsym, &ln, &nln)) {
+		print("warning: %s has no Go symbols or is not ELF; ignoring profile %s\n", bin, prof);
+		return;
+	}
+	loadsyms(sym, nsym);
+	loadpcln(ln, nln, quant);
+	loadsamples(pb, np, ptrsize);
+	proflayout = nsample > 0;
+	if(debug['v'])
+		Bprint(&bso, "%5.2f profile: %d samples, %d functions, %d call edges\n",
+			cputime(), nsample, nptext, npedge);
+	Bflush(&bso);
+}
+
+/*
+ * samples in s, counting those taken in its callees,
+ * or 0 if the profile does not know s.
+ */
+int32
+profsamples(Sym *s)
+{
+	Pfunc *f;
+
+	f = pflookup(s->name, 0);
+	if(f == nil)
+		return 0;
+	return f->total;
+}
+
+/*
+ * samples that were at line in s, or in a call made from it.
+ * lines of functions with too few samples to tell are all hot.
+ */
+int32
+proflinesamples(Sym *s, int32 line)
+{
+	Pfunc *f;
+	Pline *l;
+
+	f = pflookup(s->name, 0);
+	if(f == nil || f->total < ColdMin)
+		return 1;
+	for(l = plhash[((uintptr)f*31 + line) % NPHASH]; l != nil; l = l->hash)
+		if(l->f == f && l->line == line)
+			return l->n;
+	return 0;
+}
+
+static int
+edgecmp(const void *va, const void *vb)
+{
+	Pedge *a, *b;
+
+	a = *(Pedge**)va;
+	b = *(Pedge**)vb;
+	if(a->n != b->n)
+		return b->n - a->n;
+	if(a->from->index != b->from->index)
+		return a->from->index - b->from->index;
+	return a->to->index - b->to->index;
+}
+
+static int
+chaincmp(const void *va, const void *vb)
+{
+	Pfunc *a, *b;
+
+	a = *(Pfunc**)va;
+	b = *(Pfunc**)vb;
+	if(a->weight != b->weight)
+		return b->weight - a->weight;
+	return a->index - b->index;
+}
+
+/*
+ * the runtime and the debuggers find the source file of a
+ * function through the file history ('z' symbols) written
+ * just before the first function of each object.  a function
+ * moved away from that one gets its own copy of the history.
+ */
+static int
+hashist(Sym *s)
+{
+	Auto *a;
+
+	for(a = s->autom; a != nil; a = a->link)
+		if(a->type == D_FILE || a->type == D_FILE1)
+			return 1;
+	return 0;
+}
+
+static void
+copyhist(Sym *from, Sym *to)
+{
+	Auto *a, *u, *first, **l;
+
+	l = &first;
+	for(a = from->autom; a != nil; a = a->link) {
+		if(a->type != D_FILE && a->type != D_FILE1)
+			continue;
+		u = mal(sizeof *u);
+		*u = *a;
+		*l = u;
+		l = &u->link;
+	}
+	*l = to->autom;
+	to->autom = first;
+}
+
+void
+proforder(void)
+{
+	Sym *s, **fn, **hist, *h;
+	Pfunc *f, *g, *a, *b, **chain;
+	Pedge *e, **edge;
+	int32 i, n, nfn, nout, nchain, nhot, *out;
+	uchar *done;
+
+	if(!proflayout)
+		return;
+	if(debug['v'])
+		Bprint(&bso, "%5.2f proforder\n", cputime());
+	Bflush(&bso);
+
+	nfn = 0;
+	for(s = textp; s != nil; s = s->next)
+		nfn++;
+	if(nfn == 0)
+		return;
+	fn = mal(nfn*sizeof fn[0]);
+	hist = mal(nfn*sizeof hist[0]);
+	out = mal(nfn*sizeof out[0]);
+	done = mal(nfn);
+
+	// number the functions and find the profile entry of each.
+	h = nil;
+	i = 0;
+	for(s = textp; s != nil; s = s->next) {
+		if(hashist(s))
+			h = s;
+		fn[i] = s;
+		hist[i] = h;
+		f = pflookup(s->name, 0);
+		if(f != nil && f->sym == nil && s->text != nil) {
+			f->sym = s;
+			f->index = i;
+			f->used = f->self > 0;
+		}
+		i++;
+	}
+
+	// each function starts as a chain of its own.
+	edge = mal(npedge*sizeof edge[0]);
+	n = 0;
+	for(e = pedges; e != nil; e = e->link) {
+		if(e->from->sym == nil || e->to->sym == nil)
+			continue;
+		e->from->used = 1;
+		e->to->used = 1;
+		edge[n++] = e;
+	}
+	nchain = 0;
+	for(i=0; i<NPHASH; i++)
+		for(f = pfhash[i]; f != nil; f = f->hash)
+			if(f->sym != nil && f->used) {
+				f->head = f;
+				f->tail = f;
+				f->weight = f->self;
+				nchain++;
+			}
+
+	// join the chains of caller and callee,
+	// heaviest call edges first.
+	qsort(edge, n, sizeof edge[0], edgecmp);
+	for(i=0; i<n; i++) {
+		a = edge[i]->from->head;
+		b = edge[i]->to->head;
+		if(a == b)
+			continue;
+		for(g = b; g != nil; g = g->next)
+			g->head = a;
+		a->tail->next = b;
+		a->tail = b->tail;
+		a->weight += b->weight;
+		nchain--;
+	}
+
+	// hottest chains first, then everything else in the old order.
+	chain = mal(nchain*sizeof chain[0]);
+	nchain = 0;
+	for(i=0; i<NPHASH; i++)
+		for(f = pfhash[i]; f != nil; f = f->hash)
+			if(f->sym != nil && f->used && f->head == f)
+				chain[nchain++] = f;
+	qsort(chain, nchain, sizeof chain[0], chaincmp);
+	nout = 0;
+	for(i=0; i<nchain; i++)
+		for(f = chain[i]; f != nil; f = f->next) {
+			out[nout++] = f->index;
+			done[f->index] = 1;
+		}
+	nhot = nout;
+	for(i=0; i<nfn; i++)
+		if(!done[i])
+			out[nout++] = i;
+
+	// keep the file history in front of every function that needs it,
+	// and relink textp in the new order.
+	h = nil;
+	textp = nil;
+	etextp = nil;
+	for(i=0; i<nout; i++) {
+		s = fn[out[i]];
+		if(hist[out[i]] != h) {
+			h = hist[out[i]];
+			if(h != nil && h != s)
+				copyhist(h, s);
+		}
+		if(etextp != nil)
+			etextp->next = s;
+		else
+			textp = s;
+		etextp = s;
+	}
+	etextp->next = nil;
+
+	if(debug['v'])
+		Bprint(&bso, "%5.2f proforder: %d hot functions in %d chains\n",
+			cputime(), nhot, nchain);
+	Bflush(&bso);
+}
@@ -259,6 +259,9 @@ loadlib(void)
 			Bprint(&bso, "%5.2f autolib: %s (from %s)\n", cputime(), library[i].file, library[i].objref);
 		objfile(library[i].file, library[i].pkg);
 	}
+	if(debug['v'])
+		Bprint(&bso, "%5.2f ldobj1: %d objects, %lld bytes, %.2fs\n",
+			cputime(), nobjload, objloadbytes, objloadtime);
 	
 	// We've loaded all the code now.
 	// If there are no dynamic libraries needed, gcc disables dynamic linking.
@@ -311,7 +314,7 @@ objfile(char *file, char *pkg)
 	if(debug['v'])
 		Bprint(&bso, "%5.2f ldobj: %s (%s)\n", cputime(), file, pkg);
 	Bflush(&bso);
-	f = Bopen(file, 0);
+	f = Bopen(file, OREAD|OMMAP);
 	if(f == nil) {
 		diag("cannot open file: %s", file);
 		errorexit();
@@ -394,6 +397,7 @@ ldobj(Biobuf *f, char *pkg, int64 len, char *pn, int whence)
 	uint32 magic;
 	vlong import0, import1, eof;
 	char *t;
+	double t0;
 
 	eof = Boffset(f) + len;
 
@@ -476,7 +480,11 @@ ldobj(Biobuf *f, char *pkg, int64 len, char *pn, int whence)
 	ldpkg(f, pkg, import1 - import0 - 2, pn, whence);	// -2 for !\n
 	Bseek(f, import1, 0);
 
+	t0 = cputime();
 	ldobj1(f, pkg, eof - Boffset(f), pn);
+	nobjload++;
+	objloadbytes += eof - import1;
+	objloadtime += cputime() - t0;
 	return;
 
 eof:
@@ -787,6 +795,90 @@ zerosig(char *sp)
 	s->sig = 0;
 }
 
+/*
+ * Load the len bytes of instructions at the current offset of f
+ * into b, straight from the buffer if f holds them all, as it does
+ * when the file is mapped.
+ */
+void
+objinit(Objbuf *b, Biobuf *f, int64 len)
+{
+	int32 n;
+
+	b->off = Boffset(f);
+	b->alloc = nil;
+	b->base = Bgetp(f, len);
+	if(b->base == nil) {
+		if((int32)len != len) {
+			diag("object file too large");
+			errorexit();
+		}
+		b->alloc = malloc(len);
+		if(b->alloc == nil) {
+			diag("out of memory");
+			errorexit();
+		}
+		n = Bread(f, b->alloc, len);
+		if(n < 0)
+			n = 0;
+		b->base = b->alloc;
+		len = n;
+	}
+	b->p = b->base;
+	b->ep = b->base + len;
+}
+
+/*
+ * Prepare to decode a record and return the number of
+ * bytes left, which is negative if the last record
+ * was truncated.
+ */
+int
+objrec(Objbuf *b)
+{
+	int n;
+
+	n = b->ep - b->p;
+	if(n < Objmaxrec && b->base != b->tail) {
+		if(n > 0)
+			memmove(b->tail, b->p, n);
+		else
+			n = 0;
+		memset(b->tail+n, 0, sizeof b->tail - n);
+		b->off += b->p - b->base;
+		b->base = b->tail;
+		b->p = b->tail;
+		b->ep = b->tail + n;
+	}
+	return n;
+}
+
+/*
+ * Return the NUL-terminated name at b->p and move past it,
+ * or nil if there is none before the end of the data.
+ */
+char*
+objname(Objbuf *b)
+{
+	uchar *p, *q;
+
+	p = b->p;
+	if(p >= b->ep)
+		return nil;
+	q = memchr(p, 0, b->ep - p);
+	if(q == nil)
+		return nil;
+	b->p = q+1;
+	return (char*)p;
+}
+
+void
+objterm(Objbuf *b)
+{
+	free(b->alloc);
+	b->alloc = nil;
+}
+
 int32
 Bget4(Biobuf *f)
 {
@@ -74,6 +74,32 @@ struct Library
 // A section further describes the pieces of that block for
 // use in debuggers and such.
 
+// An Objbuf holds the instructions of an object file in memory
+// for ldobj1 to decode.  Before each record ldobj1 calls objrec,
+// which moves the last few records to the zero-padded tail so that
+// a record that runs off the end decodes as zeros instead of
+// reading past the data.  Only ANAME's symbol name can be longer
+// than Objmaxrec, and objname reads it with a bounds check.
+enum
+{
+	Objmaxrec = 128,
+};
+
+typedef struct Objbuf Objbuf;
+struct Objbuf
+{
+	uchar*	p;	// next byte
+	uchar*	ep;	// end of data
+	uchar*	base;	// data, at file offset off
+	vlong	off;
+	uchar*	alloc;	// copy of the data, if it could not be mapped
+	uchar	tail[2*Objmaxrec];
+};
+
+#define	OGETC(b)	(*(b)->p++)
+#define	OGET4(b)	((b)->p += 4, (int32)((b)->p[-4] | (b)->p[-3]<<8 | (b)->p[-2]<<16 | (uint32)(b)->p[-1]<<24))
+#define	OOFFSET(b)	((b)->off + ((b)->p - (b)->base))
+
 typedef struct Segment Segment;
 typedef struct Section Section;
 
@@ -124,6 +150,12 @@ EXTERN	char*	thestring;
 EXTERN	int	ndynexp;
 EXTERN	int	havedynamic;
 
+EXTERN	int	proflayout;
+
+EXTERN	int	nobjload;
+EXTERN	vlong	objloadbytes;
+EXTERN	double	objloadtime;
+
 EXTERN	Segment	segtext;
 EXTERN	Segment	segdata;
 EXTERN	Segment	segsym;
@@ -158,6 +190,10 @@ void	Lflag(char *arg);
 void	usage(void);
 void	adddynrel(Sym*, Reloc*);
 void	ldobj1(Biobuf *f, char*, int64 len, char *pn);
+void	objinit(Objbuf*, Biobuf*, int64);
+int	objrec(Objbuf*);
+char*	objname(Objbuf*);
+void	objterm(Objbuf*);
 void	ldobj(Biobuf*, char*, int64, char*, int);
 void	ldelf(Biobuf*, char*, int64, char*);
 void	ldmacho(Biobuf*, char*, int64, char*);
@@ -203,6 +239,10 @@ void	dostkcheck(void);
 void	undef(void);
 void	doweak(void);
 void	setpersrc(Sym*);
+void	readprof(char*, char*);
+int32	profsamples(Sym*);
+int32	proflinesamples(Sym*, int32);
+void	proforder(void);
 
 int	pathchar(void);
 void*	mal(uint32);
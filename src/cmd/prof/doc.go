@@ -41,6 +41,25 @@ Flag -t sets the maximum real time to sample, in seconds, and -d
 sets the sampling interval in milliseconds.  The default is to sample
 every 100ms until the program completes.
 
+Flag -i (Linux only) samples from inside the process instead of stopping
+it: prof asks the Go runtime to turn on its CPU profiler, reads the
+profile it sends, and symbolizes the program counters itself.  The
+program does not pause, so this mode is cheap enough to use on a live
+server, but it counts only time spent running, as the profiler in
+runtime/pprof does, and it cannot print registers.  The program must have
+been started with $GOPROFCTL set to a non-empty value, which makes the
+runtime listen for prof on the FIFO /tmp/goprof.<pid>.  The FIFO has
+mode 0600, so only the program's own user can profile it; the runtime
+will not listen if something else already exists at that path, and it
+removes the FIFO when the program exits.  On other systems the runtime
+prints a warning and ignores $GOPROFCTL.  The runtime's goroutine that
+waits on the FIFO keeps the deadlock check from firing: with $GOPROFCTL
+set, a program whose goroutines are all asleep hangs instead of exiting
+with "all goroutines are asleep - deadlock!".  The default interval for
+-i is 10ms.
+
+	prof -i -p pid [-t total_secs] [-d delta_msec]
+
 For reasons of disambiguation it is installed as 6prof although it also serves
 as an 8prof and a 5prof.
 
@@ -4,6 +4,9 @@
 
 #include <u.h>
 #include <time.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/time.h>
 #include <libc.h>
 #include <bio.h>
 #include <ctype.h>
@@ -46,6 +49,13 @@ int stacks;		// print stack traces
 
 int pid;		// main process pid
 
+// In-process sampling (-i): the program's own SIGPROF handler takes
+// the samples and the runtime sends us its CPU profile log, which
+// we symbolize here.  See $GOROOT/src/pkg/runtime/linux/profctl.c.
+int inprocess;
+uchar *logdata;	// the log, in the program's word size and byte order
+long nlogdata;
+
 int nthread;	// number of threads
 int thread[32];	// thread pids
 Map *map[32];	// thread maps
@@ -55,6 +65,8 @@ Usage(void)
 {
 	fprint(2, "Usage: prof -p pid [-t total_secs] [-d delta_msec]\n");
 	fprint(2, "       prof [-t total_secs] [-d delta_msec] 6.out args ...\n");
+	fprint(2, "       prof -i -p pid [-t total_secs] [-d delta_msec]\n");
+	fprint(2, "\t-i: sample in the process, which must run with $GOPROFCTL set\n");
 	fprint(2, "\tformats (default -h):\n");
 	fprint(2, "\t\t-P file.prof: write [c]pprof output to file.prof\n");
 	fprint(2, "\t\t-h: histograms\n");
@@ -382,7 +394,7 @@ bad:
 }
 
 void
-addtohistogram(uvlong pc, uvlong callerpc, uvlong sp)
+addcount(uvlong pc, uvlong callerpc, uint count)
 {
 	int h;
 	PC *x;
@@ -390,18 +402,24 @@ addtohistogram(uvlong pc, uvlong callerpc, uvlong sp)
 	h = (pc + callerpc*101) % Ncounters;
 	for(x = counters[h]; x != NULL; x = x->next) {
 		if(x->pc == pc && x->callerpc == callerpc) {
-			x->count++;
+			x->count += count;
 			return;
 		}
 	}
 	x = malloc(sizeof(PC));
 	x->pc = pc;
 	x->callerpc = callerpc;
-	x->count = 1;
+	x->count = count;
 	x->next = counters[h];
 	counters[h] = x;
 }
 
+void
+addtohistogram(uvlong pc, uvlong callerpc, uvlong sp)
+{
+	addcount(pc, callerpc, 1);
+}
+
 void
 addppword(uvlong pc)
 {
@@ -580,6 +598,165 @@ samples(void)
 	}
 }
 
+vlong
+msec(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, nil);
+	return (vlong)tv.tv_sec*1000 + tv.tv_usec/1000;
+}
+
+// Ask the runtime in process pid to profile itself and
+// read the log it sends until total_sec have passed.
+void
+inprocsamples(void)
+{
+	char ctlpath[100], datapath[100];
+	int ctlfd, datafd, n, timeout;
+	long alloc;
+	vlong deadline;
+	struct pollfd pfd;
+	struct stat st;
+
+	snprint(ctlpath, sizeof ctlpath, "/tmp/goprof.%d", pid);
+	snprint(datapath, sizeof datapath, "/tmp/goprof.%d.%d", pid, getpid());
+	remove(datapath);
+	if(mkfifo(datapath, 0600) < 0) {
+		fprint(2, "prof: can't make %s: %r\n", datapath);
+		exit(1);
+	}
+
+	// The open blocks until the runtime's control goroutine
+	// is waiting for us.
+	if(stat(ctlpath, &st) < 0 || !S_ISFIFO(st.st_mode)) {
+		fprint(2, "prof: no %s; is pid %d a Go program run with $GOPROFCTL set?\n", ctlpath, pid);
+		remove(datapath);
+		exit(1);
+	}
+	ctlfd = open(ctlpath, OWRITE);
+	if(ctlfd < 0) {
+		fprint(2, "prof: can't open %s: %r\n", ctlpath);
+		remove(datapath);
+		exit(1);
+	}
+	fprint(ctlfd, "%d %s\n", 1000/delta_msec, datapath);
+	datafd = open(datapath, OREAD);
+	remove(datapath);
+	if(datafd < 0) {
+		fprint(2, "prof: can't open %s: %r\n", datapath);
+		exit(1);
+	}
+
+	// Closing ctlfd ends the profile; the runtime then
+	// flushes the rest of the log and closes its end.
+	deadline = 0;
+	if(total_sec > 0)
+		deadline = msec() + total_sec*1000LL;
+	alloc = 0;
+	for(;;) {
+		if(ctlfd >= 0 && deadline != 0) {
+			timeout = deadline - msec();
+			pfd.fd = datafd;
+			pfd.events = POLLIN;
+			if(timeout <= 0 || poll(&pfd, 1, timeout) == 0) {
+				close(ctlfd);
+				ctlfd = -1;
+				continue;
+			}
+		}
+		if(nlogdata == alloc) {
+			alloc = 2*alloc + 64*1024;
+			logdata = realloc(logdata, alloc);
+			if(logdata == nil) {
+				fprint(2, "prof: realloc failed: %r\n");
+				exit(2);
+			}
+		}
+		n = read(datafd, logdata+nlogdata, alloc-nlogdata);
+		if(n <= 0)
+			break;
+		nlogdata += n;
+	}
+	if(ctlfd >= 0)
+		close(ctlfd);
+	close(datafd);
+	if(nlogdata == 0) {
+		fprint(2, "prof: pid %d sent no profile; is it profiling itself already?\n", pid);
+		exit(1);
+	}
+	if(pprof)
+		ppmaps();
+}
+
+uvlong
+logword(uchar *p)
+{
+	int i;
+	uvlong w;
+
+	w = 0;
+	for(i = mach->szaddr-1; i >= 0; i--)
+		w = w<<8 | p[i];
+	return w;
+}
+
+// Feed the traces in logdata to the usual reports.
+// Unlike samples, we have only the program counters,
+// and each trace comes with a count.
+void
+inproctraces(void)
+{
+	char buf[1024];
+	uchar *p, *e;
+	uvlong count, n, i, j, *pc;
+	int sz;
+
+	sz = mach->szaddr;
+	p = logdata + 5*sz;	// skip header
+	e = logdata + nlogdata;
+	pc = nil;
+	while(p+2*sz <= e) {
+		count = logword(p);
+		n = logword(p+sz);
+		p += 2*sz;
+		if(p+n*sz > e)
+			break;
+		pc = realloc(pc, (n+1)*sizeof pc[0]);
+		for(i = 0; i < n; i++)
+			pc[i] = logword(p+i*sz);
+		pc[n] = 0;
+		p += n*sz;
+
+		nsample += count;
+		nsamplethread += count;
+		if(histograms && (stacks || pprof)) {
+			for(i = 0; i < n; i++)
+				addcount(pc[i], pc[i+1], count);
+		} else if(histograms && n > 0)
+			addcount(pc[0], 0, count);
+		for(j = 0; j < count; j++) {
+			if(have_syms > 0 && linenums && fileline(buf, sizeof buf, pc[0]))
+				fprint(2, "%s\n", buf);
+			if(have_syms > 0 && functions) {
+				symoff(buf, sizeof(buf), pc[0], CANY);
+				fprint(2, "%s\n", buf);
+			}
+			if(stacks && have_syms > 0) {
+				for(i = 0; i < n; i++) {
+					symoff(buf, sizeof(buf), pc[i], CANY);
+					fprint(2, "%s", buf);
+					if(linenums && fileline(buf, sizeof buf, pc[i]))
+						fprint(2, " %s", buf);
+					fprint(2, "\n");
+				}
+				fprint(2, "\n");
+			}
+		}
+	}
+	free(pc);
+}
+
 typedef struct Func Func;
 struct Func
 {
@@ -678,6 +855,8 @@ dumphistogram()
 	}
 }
 
+void pptrailer(void);
+
 typedef struct Trace Trace;
 struct Trace {
 	int	count;
@@ -695,6 +874,12 @@ dumppprof()
 
 	if(!pprof)
 		return;
+	if(inprocess) {
+		// The runtime's log is a pprof profile without the trailer.
+		Bwrite(pproffd, logdata, nlogdata);
+		pptrailer();
+		return;
+	}
 	e = ppdata + nppdata;
 	// Create list of traces.  First, count the traces
 	ntrace = 0;
@@ -751,6 +936,12 @@ dumppprof()
 			arch->ppword(tp->pc[i]);
 		}
 	}
+	pptrailer();
+}
+
+void
+pptrailer(void)
+{
 	// 3) Binary trailer
 	arch->ppword(0);	// must be zero
 	arch->ppword(1);	// must be one
@@ -800,9 +991,10 @@ detach(void)
 int
 main(int argc, char *argv[])
 {
-	int i;
+	int i, dflag;
 	char *ppfile;
 
+	dflag = 0;
 	ARGBEGIN{
 	case 'P':
 		pprof =1;
@@ -815,6 +1007,7 @@ main(int argc, char *argv[])
 		break;
 	case 'd':
 		delta_msec = atoi(EARGF(Usage()));
+		dflag = 1;
 		break;
 	case 't':
 		total_sec = atoi(EARGF(Usage()));
@@ -828,6 +1021,9 @@ main(int argc, char *argv[])
 	case 'h':
 		histograms = 1;
 		break;
+	case 'i':
+		inprocess = 1;
+		break;
 	case 'l':
 		linenums = 1;
 		break;
@@ -842,6 +1038,12 @@ main(int argc, char *argv[])
 	}ARGEND
 	if(pid <= 0 && argc == 0)
 		Usage();
+	if(inprocess && (pid <= 0 || registers))
+		Usage();
+	if(inprocess && !dflag)
+		delta_msec = 10;	// sampling is cheap in the process
+	if(delta_msec <= 0)
+		delta_msec = 1;
 	if(functions+linenums+registers+stacks+pprof == 0)
 		histograms = 1;
 	if(!machbyname("amd64")) {
@@ -872,6 +1074,17 @@ main(int argc, char *argv[])
 		fprint(2, "prof: crack header for %s: %r\n", file);
 		exit(1);
 	}
+	if(inprocess) {
+		if(setarch() < 0) {
+			fprint(2, "prof: can't identify binary architecture for %s\n", file);
+			exit(1);
+		}
+		inprocsamples();
+		inproctraces();
+		dumphistogram();
+		dumppprof();
+		exit(0);
+	}
 	if(pid <= 0)
 		pid = startprocess(argv);
 	attachproc(pid, &fhdr);	// initializes thread list
@@ -0,0 +1,80 @@
+/*
+ * The authors of this software are Rob Pike and Ken Thompson,
+ * with contributions from Mike Burrows and Sean Dorward.
+ *
+ *     Copyright (c) 2002-2006 by Lucent Technologies.
+ *     Portions Copyright (c) 2004 Google Inc.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose without fee is hereby granted, provided that this entire notice
+ * is included in all copies of any software which is or includes a copy
+ * or modification of this software and in all copies of the supporting
+ * documentation for such software.
+ * THIS SOFTWARE IS BEING PROVIDED "AS IS", WITHOUT ANY EXPRESS OR IMPLIED
+ * WARRANTY.  IN PARTICULAR, NEITHER THE AUTHORS NOR LUCENT TECHNOLOGIES
+ * NOR GOOGLE INC MAKE ANY REPRESENTATION OR WARRANTY OF ANY KIND CONCERNING
+ * THE MERCHANTABILITY OF THIS SOFTWARE OR ITS FITNESS FOR ANY PARTICULAR PURPOSE.
+ */
+
+/*
+ * Bprint throughput, for lines like those of
+ * 6g -S and 6l -v.  Build with
+ *	gcc -I$GOROOT/include bench.c $GOROOT/lib/libbio.a $GOROOT/lib/lib9.a
+ * and run with an optional line count; output goes to /dev/null.
+ */
+
+#include <u.h>
+#include <time.h>
+#include <libc.h>
+#include <bio.h>
+
+static double
+now(void)
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static void
+bench(char *name, Biobuf *b, int n, int which)
+{
+	double t;
+	int i;
+
+	t = now();
+	for(i=0; i<n; i++){
+		switch(which){
+		case 0:
+			Bprint(b, "%.5d (%s:%d)\tMOVQ\t%d(SP),AX\n", i, "x.go", i/10, i&255);
+			break;
+		case 1:
+			Bprint(b, "%#llux %#x %p\n", (uvlong)i<<20, i, (void*)b);
+			break;
+		case 2:
+			Bprint(b, "%s %s %s\n", "runtime.mallocgc", "runtime.memmove", "main.main");
+			break;
+		}
+	}
+	Bflush(b);
+	t = now() - t;
+	fprint(2, "%s\t%d lines\t%.0f ns/line\n", name, n, t*1e9/n);
+}
+
+int
+main(int argc, char *argv[])
+{
+	Biobuf b;
+	int fd, n;
+
+	n = 1000000;
+	if(argc > 1)
+		n = atoi(argv[1]);
+	fd = open("/dev/null", OWRITE);
+	if(fd < 0)
+		sysfatal("open /dev/null: %r");
+	Binit(&b, fd, OWRITE);
+	bench("listing", &b, n, 0);
+	bench("hex", &b, n, 1);
+	bench("strings", &b, n, 2);
+	Bterm(&b);
+	exits(0);
+}
@@ -172,7 +172,15 @@ __fmtcpy(Fmt *f, const void *vm, int n, int sz)
 			return -1;
 		t = (char*)f->to;
 		s = (char*)f->stop;
-		for(nc = n; nc > 0; nc--){
+		nc = n;
+		if(n == sz && t + n <= s){
+			/* room for all of it: copy the ascii without checking for space */
+			while(nc > 0 && *(uchar*)m < Runeself){
+				*t++ = *m++;
+				nc--;
+			}
+		}
+		for(; nc > 0; nc--){
 			r = *(uchar*)m;
 			if(r < Runeself)
 				m++;
@@ -278,7 +286,12 @@ fmtstrcpy(Fmt *f, char *s)
 #endif
 		return __fmtcpy(f, s, j, i);
 	}
-	return __fmtcpy(f, s, utflen(s), strlen(s));
+	/* count the ascii prefix, which is usually all of it, in one pass */
+	for(i=0; *(uchar*)(s+i) && *(uchar*)(s+i) < Runeself; i++)
+		;
+	if(s[i] == 0)
+		return __fmtcpy(f, s, i, i);
+	return __fmtcpy(f, s, i+utflen(s+i), i+strlen(s+i));
 }
 
 /* fmt out a null terminated utf string */
@@ -439,9 +452,34 @@ __ifmt(Fmt *f)
 	n = 0;	/* in runes */
 	excess = 0;	/* number of bytes > number runes */
 	ndig = 0;
-	len = utflen(thousands);
-	bytelen = strlen(thousands);
-	if(isv){
+	len = 0;
+	bytelen = 0;
+	if(fl & FmtApost){
+		len = utflen(thousands);
+		bytelen = strlen(thousands);
+	}
+	if(!(fl & (FmtComma|FmtApost))){
+		/*
+		 * no separators: divide by a constant
+		 * or shift, not by the variable base.
+		 */
+		if(base == 10){
+			if(isv)
+				for(; vu; vu /= 10, n++)
+					*p-- = '0' + vu%10;
+			else
+				for(; u; u /= 10, n++)
+					*p-- = '0' + u%10;
+		}else{
+			i = base == 16 ? 4 : base == 8 ? 3 : 1;
+			if(isv)
+				for(; vu; vu >>= i, n++)
+					*p-- = conv[vu & (base-1)];
+			else
+				for(; u; u >>= i, n++)
+					*p-- = conv[u & (base-1)];
+		}
+	}else if(isv){
 		while(vu){
 			i = vu % base;
 			vu /= base;
@@ -22,7 +22,8 @@
 
 enum
 {
-	Maxfmt = 64
+	Maxfmt = 64,
+	Nascii = 128
 };
 
 typedef struct Convfmt Convfmt;
@@ -36,7 +37,15 @@ static struct
 {
 	/* lock by calling __fmtlock, __fmtunlock */
 	int	nfmt;
-	Convfmt	fmt[Maxfmt];
+	Convfmt	fmt[Maxfmt];	/* verbs outside ascii */
+
+	/*
+	 * the ascii verbs, which are nearly all of them,
+	 * are looked up by indexing; fmtfmt reads the
+	 * table without the lock once it has been set up.
+	 */
+	volatile	Fmts	ascii[Nascii];
+	volatile	int	ready;
 } fmtalloc;
 
 static Convfmt knownfmt[] = {
@@ -86,6 +95,22 @@ static Convfmt knownfmt[] = {
 
 int	(*fmtdoquote)(int);
 
+/*
+ * __fmtlock() must be set
+ */
+static void
+__fmtsetup(void)
+{
+	Convfmt *p;
+
+	if(fmtalloc.ready)
+		return;
+	for(p=knownfmt; p->c; p++)
+		if(fmtalloc.ascii[p->c] == nil)
+			fmtalloc.ascii[p->c] = p->fmt;
+	fmtalloc.ready = 1;
+}
+
 /*
  * __fmtlock() must be set
  */
@@ -99,6 +124,12 @@ __fmtinstall(int c, Fmts f)
 	if(!f)
 		f = __badfmt;
 
+	__fmtsetup();
+	if(c < Nascii){
+		fmtalloc.ascii[c] = f;
+		return 0;
+	}
+
 	ep = &fmtalloc.fmt[fmtalloc.nfmt];
 	for(p=fmtalloc.fmt; p<ep; p++)
 		if(p->c == c)
@@ -131,6 +162,19 @@ static Fmts
 fmtfmt(int c)
 {
 	Convfmt *p, *ep;
+	Fmts f;
+
+	if(c >= 0 && c < Nascii){
+		if(!fmtalloc.ready){
+			__fmtlock();
+			__fmtsetup();
+			__fmtunlock();
+		}
+		f = fmtalloc.ascii[c];
+		if(f == nil)
+			return __badfmt;
+		return f;
+	}
 
 	ep = &fmtalloc.fmt[fmtalloc.nfmt];
 	for(p=fmtalloc.fmt; p<ep; p++)
@@ -140,16 +184,6 @@ fmtfmt(int c)
 			return p->fmt;
 		}
 
-	/* is this a predefined format char? */
-	__fmtlock();
-	for(p=knownfmt; p->c; p++)
-		if(p->c == c){
-			__fmtinstall(p->c, p->fmt);
-			__fmtunlock();
-			return p->fmt;
-		}
-	__fmtunlock();
-
 	return __badfmt;
 }
 
@@ -166,6 +200,9 @@ __fmtdispatch(Fmt *f, void *fmt, int isrunes)
 		if(isrunes){
 			r = *(Rune*)fmt;
 			fmt = (Rune*)fmt + 1;
+		}else if(*(uchar*)fmt < Runeself){
+			r = *(uchar*)fmt;
+			fmt = (char*)fmt + 1;
 		}else{
 			fmt = (char*)fmt + chartorune(&rune, (char*)fmt);
 			r = rune;
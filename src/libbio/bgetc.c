@@ -43,6 +43,13 @@ loop:
 			bp->state = Bractive;
 		return Beof;
 	}
+	if(bp->mapped) {
+		/*
+		 * the whole file is already in the buffer
+		 */
+		bp->state = Bracteof;
+		return Beof;
+	}
 	/*
 	 * get next buffer, try to keep Bungetsize
 	 * characters pre-catenated from the previous
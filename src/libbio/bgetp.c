@@ -0,0 +1,29 @@
+// Copyright 2011 The Go Authors.  All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include	<u.h>
+#include	<libc.h>
+#include	<bio.h>
+
+/*
+ * Bgetp returns a pointer to the next n bytes of bp and
+ * consumes them, if they are already in the buffer.
+ * Otherwise it returns 0 and consumes nothing; the caller
+ * should fall back to Bread.  The bytes are valid until the
+ * buffer is next refilled.  For a file
+ * opened with OMMAP the whole file is in the buffer, so Bgetp
+ * never fails short of the end of the file and the bytes stay
+ * valid until Bterm.
+ */
+void*
+Bgetp(Biobuf *bp, long n)
+{
+	void *p;
+
+	if(bp->state != Bractive || n < 0 || n > -bp->icount)
+		return 0;
+	p = bp->ebuf + bp->icount;
+	bp->icount += n;
+	return p;
+}
@@ -26,6 +26,10 @@ THE SOFTWARE.
 #include	<u.h>
 #include	<libc.h>
 #include	<bio.h>
+#ifndef _WIN32
+#include	<sys/mman.h>
+#include	<sys/stat.h>
+#endif
 
 enum
 {
@@ -80,6 +84,53 @@ install(Biobuf *bp)
 	}
 }
 
+/*
+ * Map all of the regular file open on bp and make the mapping
+ * the buffer, as though the file had just been read in one piece.
+ * Bgetc, Bread and Brdline then never refill and Bseek only
+ * moves icount.  The mapping is private and writable because
+ * callers may write into the buffer, as after Brdline.
+ * Anything that cannot be mapped keeps the ordinary buffer.
+ */
+static
+void
+bmap(Biobuf *bp)
+{
+#ifndef _WIN32
+	struct stat st;
+	void *v;
+
+	if(fstat(bp->fid, &st) < 0 || !S_ISREG(st.st_mode))
+		return;
+	if(st.st_size <= 0 || (int)st.st_size != st.st_size)
+		return;
+	if(lseek(bp->fid, 0, 1) != 0)
+		return;
+	v = mmap(0, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, bp->fid, 0);
+	if(v == MAP_FAILED)
+		return;
+	bp->bbuf = v;
+	bp->bsize = st.st_size;
+	bp->ebuf = bp->bbuf + bp->bsize;
+	bp->gbuf = bp->bbuf;
+	bp->icount = -bp->bsize;
+	bp->offset = bp->bsize;
+	bp->mapped = 1;
+#endif
+}
+
+static
+void
+bunmap(Biobuf *bp)
+{
+#ifndef _WIN32
+	if(bp->mapped) {
+		munmap(bp->bbuf, bp->bsize);
+		bp->mapped = 0;
+	}
+#endif
+}
+
 int
 Binits(Biobuf *bp, int f, int mode, unsigned char *p, int size)
 {
@@ -87,7 +138,7 @@ Binits(Biobuf *bp, int f, int mode, unsigned char *p, int size)
 	p += Bungetsize;	/* make room for Bungets */
 	size -= Bungetsize;
 
-	switch(mode&~(ORCLOSE|OTRUNC)) {
+	switch(mode&~(ORCLOSE|OTRUNC|OMMAP)) {
 	default:
 		fprint(2, "Bopen: unknown mode %d\n", mode);
 		return Beof;
@@ -113,6 +164,9 @@ Binits(Biobuf *bp, int f, int mode, unsigned char *p, int size)
 	bp->rdline = 0;
 	bp->offset = 0;
 	bp->runesize = 0;
+	bp->mapped = 0;
+	if((mode&(OWRITE|OMMAP)) == OMMAP)
+		bmap(bp);
 	return 0;
 }
 
@@ -142,7 +196,7 @@ Bopen(char *name, int mode)
 	Biobuf *bp;
 	int f;
 
-	switch(mode&~(ORCLOSE|OTRUNC)) {
+	switch(mode&~(ORCLOSE|OTRUNC|OMMAP)) {
 	default:
 		fprint(2, "Bopen: unknown mode %d\n", mode);
 		return 0;
@@ -170,6 +224,7 @@ Bterm(Biobuf *bp)
 
 	deinstall(bp);
 	Bflush(bp);
+	bunmap(bp);
 	if(bp->flag == Bmagic) {
 		bp->flag = 0;
 		close(bp->fid);
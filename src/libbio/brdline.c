@@ -59,6 +59,14 @@ Brdline(Biobuf *bp, int delim)
 		return ip;
 	}
 
+	/*
+	 * a mapped file has nothing more to read
+	 */
+	if(bp->mapped) {
+		bp->rdline = i;
+		return 0;
+	}
+
 	/*
 	 * copy data to beginning of buffer
 	 */
@@ -43,7 +43,7 @@ Bread(Biobuf *bp, void *ap, long count)
 		if(n > c)
 			n = c;
 		if(n == 0) {
-			if(bp->state != Bractive)
+			if(bp->state != Bractive || bp->mapped)
 				break;
 			i = read(bp->fid, bp->bbuf, bp->bsize);
 			if(i <= 0) {
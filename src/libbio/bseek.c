@@ -57,6 +57,22 @@ Bseek(Biobuf *bp, vlong offset, int base)
 			base = 0;
 		}
 
+		/*
+		 * a mapped file is all in the buffer;
+		 * seeks past the end stop at the end
+		 */
+		if(bp->mapped) {
+			if(base == 2)
+				n += bp->bsize;
+			if(n < 0)
+				return Beof;
+			if(n > bp->bsize)
+				n = bp->bsize;
+			bp->icount = n - bp->bsize;
+			bp->gbuf = bp->bbuf;
+			return n;
+		}
+
 		/*
 		 * try to seek within buffer
 		 */
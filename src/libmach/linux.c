@@ -35,6 +35,7 @@
 #include <sys/signal.h>
 #include <sys/wait.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <libc.h>
 #include <bio.h>
 #include <mach.h>
@@ -125,6 +126,32 @@ static LinuxThread **thr;
 static int nthr;
 static int mthr;
 
+// Memory reads go through /proc/pid/mem with pread,
+// which can read many words in one system call, and
+// are cached a page at a time in the Map.  Every ctlproc
+// call that might change a thread's state increments
+// stopgen, which empties every cache.  A write through the map
+// drops the pages it touches.
+// Reads fall back to PTRACE_PEEKDATA if /proc/pid/mem
+// can't be opened or read.
+enum
+{
+	CachePages = 16,
+	CachePageSize = 4096,
+	CacheMax = 4*CachePageSize,	// larger reads bypass the cache
+};
+
+struct Pagecache
+{
+	int gen;
+	int next;	// slot to fill next
+	uvlong addr[CachePages];
+	int valid[CachePages];
+	uchar data[CachePages][CachePageSize];
+};
+
+static int stopgen;
+
 static int realpid(int pid);
 
 enum
@@ -458,6 +485,8 @@ Map*
 attachproc(int pid, Fhdr *fp)
 {
 	Map *map;
+	int fd;
+	char buf[64];
 
 	if(pid == 0) {
 		fprint(2, "attachproc(0)\n");
@@ -471,12 +500,20 @@ attachproc(int pid, Fhdr *fp)
 	if (!map)
 		return 0;
 	map->pid = pid;
+	snprint(buf, sizeof buf, "/proc/%d/mem", pid);
+	fd = open(buf, OREAD);
+	if(fd >= 0) {
+		fcntl(fd, F_SETFD, FD_CLOEXEC);
+		map->cache = malloc(sizeof *map->cache);
+		if(map->cache)
+			memset(map->cache, 0, sizeof *map->cache);
+	}
 	if(mach->regsize)
 		setmap(map, -1, 0, mach->regsize, 0, "regs", ptraceregrw);
 //	if(mach->fpregsize)
 //		setmap(map, -1, mach->regsize, mach->regsize+mach->fpregsize, 0, "fpregs", ptraceregrw);
-	setmap(map, -1, fp->txtaddr, fp->txtaddr+fp->txtsz, fp->txtaddr, "*text", ptracesegrw);
-	setmap(map, -1, fp->dataddr, mach->utop, fp->dataddr, "*data", ptracesegrw);
+	setmap(map, fd, fp->txtaddr, fp->txtaddr+fp->txtsz, fp->txtaddr, "*text", ptracesegrw);
+	setmap(map, fd, fp->dataddr, mach->utop, fp->dataddr, "*data", ptracesegrw);
 	return map;
 }
 
@@ -484,6 +521,14 @@ void
 detachproc(Map *m)
 {
 	LinuxThread *t;
+	int i;
+
+	for(i=0; i<m->nsegs; i++)
+		if(m->seg[i].inuse && m->seg[i].rw == ptracesegrw && m->seg[i].fd >= 0) {
+			close(m->seg[i].fd);
+			break;	// all share one fd
+		}
+	free(m->cache);
 
 	t = findthread(m->pid);
 	if(t != nil) {
@@ -673,6 +718,7 @@ ctlproc(int pid, char *msg)
 		werrstr("not attached to pid %d", pid);
 		return -1;
 	}
+	stopgen++;
 	if(t->state == Exited) {
 		werrstr("pid %d has exited", pid);
 		return -1;
@@ -793,9 +839,71 @@ ptraceerr:
 	return -1;
 }
 
+// Read n bytes at addr from /proc/pid/mem, open on fd,
+// through map's page cache.
+static int
+memread(Map *map, int fd, uvlong addr, void *v, uint n)
+{
+	Pagecache *c;
+	uvlong page;
+	uint off, m;
+	int i;
+
+	c = map->cache;
+	if(c == nil || n > CacheMax)
+		return pread(fd, v, n, addr) == n ? 0 : -1;
+	if(c->gen != stopgen) {
+		memset(c->valid, 0, sizeof c->valid);
+		c->gen = stopgen;
+	}
+	while(n > 0) {
+		page = addr & ~(uvlong)(CachePageSize-1);
+		for(i=0; i<CachePages; i++)
+			if(c->valid[i] && c->addr[i] == page)
+				break;
+		if(i == CachePages) {
+			i = c->next;
+			c->next = (i+1) % CachePages;
+			c->valid[i] = 0;
+			if(pread(fd, c->data[i], CachePageSize, page) != CachePageSize)
+				return -1;
+			c->addr[i] = page;
+			c->valid[i] = 1;
+		}
+		off = addr - page;
+		m = CachePageSize - off;
+		if(m > n)
+			m = n;
+		memmove(v, c->data[i]+off, m);
+		v = (char*)v + m;
+		addr += m;
+		n -= m;
+	}
+	return 0;
+}
+
+// Drop the cached pages that a write of n bytes at addr touches.
+static void
+uncache(Map *map, uvlong addr, uint n)
+{
+	Pagecache *c;
+	int i;
+
+	c = map->cache;
+	if(c == nil)
+		return;
+	for(i=0; i<CachePages; i++)
+		if(c->valid[i] && c->addr[i] < addr+n && addr < c->addr[i]+CachePageSize)
+			c->valid[i] = 0;
+}
+
 static int
 ptracesegrw(Map *map, Seg *seg, uvlong addr, void *v, uint n, int isr)
 {
+	if(isr && seg->fd >= 0 && memread(map, seg->fd, addr, v, n) == 0)
+		return 0;
+	if(!isr)
+		uncache(map, addr, n);
 	return ptracerw(isr ? PTRACE_PEEKDATA : PTRACE_POKEDATA, PTRACE_PEEKDATA,
 		isr, map->pid, addr, v, n);
 }
@@ -37,6 +37,7 @@
 typedef	struct txtsym Txtsym;
 typedef	struct file File;
 typedef	struct hist Hist;
+typedef	struct pcck Pcck;
 
 struct txtsym {				/* Text Symbol table */
 	int 	n;			/* number of local vars */
@@ -60,6 +61,16 @@ struct file {				/* Per input file header to history stack */
 	Hist	*hist;			/* history stack */
 };
 
+struct pcck {				/* Checkpoint in a pc-line or pc-sp table */
+	uvlong	pc;			/* pc before decoding c */
+	vlong	val;			/* line or sp before decoding c */
+	uchar	*c;			/* next table entry */
+};
+
+enum {
+	PCCKGAP = 64,			/* table entries between checkpoints */
+};
+
 static	int	debug = 0;
 
 static	Sym	**autos;		/* Base of auto variables */
@@ -84,6 +95,16 @@ static	Txtsym	*txt;			/* Base of text symbol table */
 static	uvlong	txtstart;		/* start of text segment */
 static	uvlong	txtend;			/* end of text segment */
 static	uvlong	firstinstr;		/* as found from symtab; needed for amd64 */
+static	int32	nhash;			/* size of name hash tables, a power of 2 */
+static	int32	*txthash;		/* text symbols by name hash: first index */
+static	int32	*txtnext;		/* next text symbol index in hash chain */
+static	int32	*globhash;		/* globals by name hash: first index */
+static	int32	*globnext;		/* next global index in hash chain */
+static	Pcck	*lineck;		/* pc-line table checkpoints */
+static	int32	nlineck;
+static	uvlong	lineckpc;		/* pc at start of pc-line table */
+static	Pcck	*spck;			/* pc-sp table checkpoints */
+static	int32	nspck;
 
 static void	cleansyms(void);
 static int32	decodename(Biobuf*, Sym*);
@@ -97,6 +118,10 @@ static int	hcomp(Hist*, short*);
 static int	hline(File*, short*, int32*);
 static void	printhist(char*, Hist*, int);
 static int	buildtbls(void);
+static void	buildhash(void);
+static Pcck*	findck(Pcck*, int32, uvlong);
+static Pcck*	mkck(uchar*, uchar*, uvlong, int, int32*);
+static uint32	symhash(char*);
 static int	symcomp(const void*, const void*);
 static int	symerrmsg(int, char*);
 static int	txtcomp(const void*, const void*);
@@ -347,6 +372,18 @@ cleansyms(void)
 	if(pcline)
 		free(pcline);
 	pcline = 0;
+	free(txthash);
+	free(txtnext);
+	free(globhash);
+	free(globnext);
+	txthash = txtnext = globhash = globnext = 0;
+	nhash = 0;
+	free(lineck);
+	lineck = 0;
+	nlineck = 0;
+	free(spck);
+	spck = 0;
+	nspck = 0;
 }
 
 /*
@@ -357,6 +394,12 @@ textseg(uvlong base, Fhdr *fp)
 {
 	txtstart = base;
 	txtend = base+fp->txtsz;
+	free(lineck);				/* checkpoints start at txtstart */
+	lineck = 0;
+	nlineck = 0;
+	free(spck);
+	spck = 0;
+	nspck = 0;
 }
 
 /*
@@ -538,9 +581,70 @@ buildtbls(void)
 				tp = txt;
 		}
 	}
+	buildhash();
 	return 1;
 }
 
+/*
+ * hash a symbol name so that names equal under cdotstrcmp
+ * hash alike: center dot hashes as '_'.
+ */
+static uint32
+symhash(char *s)
+{
+	uint32 h;
+
+	h = 0;
+	for(; *s; s++) {
+		if((s[0]&0xFF) == 0xc2 && (s[1]&0xFF) == 0xb7) {
+			h = h*31 + '_';
+			s++;
+		} else
+			h = h*31 + (s[0]&0xFF);
+	}
+	return h;
+}
+
+/*
+ *	index the sorted text and global tables by name.
+ *	each chain is in ascending table order, so the first match
+ *	is the one a linear search would find.  if the index can't
+ *	be allocated, findtext and findglobal search linearly.
+ */
+static void
+buildhash(void)
+{
+	int32 i, h;
+
+	nhash = 1;
+	while(nhash < ntxt+nglob)
+		nhash <<= 1;
+	txthash = malloc(nhash*sizeof(*txthash));
+	txtnext = malloc((ntxt+1)*sizeof(*txtnext));
+	globhash = malloc(nhash*sizeof(*globhash));
+	globnext = malloc((nglob+1)*sizeof(*globnext));
+	if(txthash == 0 || txtnext == 0 || globhash == 0 || globnext == 0) {
+		free(txthash);
+		free(txtnext);
+		free(globhash);
+		free(globnext);
+		txthash = txtnext = globhash = globnext = 0;
+		return;
+	}
+	memset(txthash, -1, nhash*sizeof(*txthash));
+	memset(globhash, -1, nhash*sizeof(*globhash));
+	for(i = ntxt-1; i >= 0; i--) {
+		h = symhash(txt[i].sym->name) & (nhash-1);
+		txtnext[i] = txthash[h];
+		txthash[h] = i;
+	}
+	for(i = nglob-1; i >= 0; i--) {
+		h = symhash(globals[i]->name) & (nhash-1);
+		globnext[i] = globhash[h];
+		globhash[h] = i;
+	}
+}
+
 /*
  * find symbol function.var by name.
  *	fn != 0 && var != 0	=> look for fn in text, var in data
@@ -603,13 +707,21 @@ findtext(char *name, Symbol *s)
 {
 	int i;
 
-	for(i = 0; i < ntxt; i++) {
+	if(txthash)
+		i = txthash[symhash(name) & (nhash-1)];
+	else
+		i = 0;
+	while(i >= 0 && i < ntxt) {
 		if(cdotstrcmp(txt[i].sym->name, name) == 0) {
 			fillsym(txt[i].sym, s);
 			s->handle = (void *) &txt[i];
 			s->index = i;
 			return 1;
 		}
+		if(txthash)
+			i = txtnext[i];
+		else
+			i++;
 	}
 	return 0;
 }
@@ -621,12 +733,20 @@ findglobal(char *name, Symbol *s)
 {
 	int32 i;
 
-	for(i = 0; i < nglob; i++) {
+	if(globhash)
+		i = globhash[symhash(name) & (nhash-1)];
+	else
+		i = 0;
+	while(i >= 0 && i < nglob) {
 		if(cdotstrcmp(globals[i]->name, name) == 0) {
 			fillsym(globals[i], s);
 			s->index = i;
 			return 1;
 		}
+		if(globhash)
+			i = globnext[i];
+		else
+			i++;
 	}
 	return 0;
 }
@@ -1261,6 +1381,69 @@ fillsym(Sym *sp, Symbol *s)
 	s->handle = 0;
 }
 
+/*
+ *	record the decoder state every PCCKGAP entries of a pc-line
+ *	(scale 1) or pc-sp (scale 4) table, starting at pc,
+ *	so that a query can start decoding near its pc.
+ */
+static Pcck*
+mkck(uchar *c, uchar *end, uvlong pc, int scale, int32 *np)
+{
+	Pcck *ck;
+	int32 n, i;
+	vlong val;
+	uchar u;
+
+	ck = malloc(((end-c)/PCCKGAP+1)*sizeof(*ck));
+	if(ck == 0)
+		return 0;
+	val = 0;
+	n = 0;
+	for(i = 0; c < end; c++, i++) {
+		if(i%PCCKGAP == 0) {
+			ck[n].pc = pc;
+			ck[n].val = val;
+			ck[n].c = c;
+			n++;
+		}
+		u = *c;
+		if(u == 0) {
+			val += (int32)((c[1]<<24)|(c[2]<<16)|(c[3]<<8)|c[4]);
+			c += 4;
+		}
+		else if(u < 65)
+			val += scale*u;
+		else if(u < 129)
+			val -= scale*(u-64);
+		else
+			pc += mach->pcquant*(u-129);
+		pc += mach->pcquant;
+	}
+	*np = n;
+	return ck;
+}
+
+/*
+ *	find the last checkpoint before pc, where a query for pc
+ *	can start decoding.  there is always one at the start of the table.
+ */
+static Pcck*
+findck(Pcck *ck, int32 n, uvlong pc)
+{
+	int32 lo, hi, m;
+
+	lo = 0;
+	hi = n;
+	while(hi - lo > 1) {
+		m = (lo+hi)/2;
+		if(ck[m].pc < pc)
+			lo = m;
+		else
+			hi = m;
+	}
+	return &ck[lo];
+}
+
 /*
  *	find the stack frame, given the pc
  */
@@ -1269,6 +1452,7 @@ pc2sp(uvlong pc)
 {
 	uchar *c, u;
 	uvlong currpc, currsp;
+	Pcck *ck;
 
 	if(spoff == 0)
 		return ~0;
@@ -1277,7 +1461,16 @@ pc2sp(uvlong pc)
 
 	if(pc<currpc || pc>txtend)
 		return ~0;
-	for(c = spoff; c < spoffend; c++) {
+	c = spoff;
+	if(spck == 0)
+		spck = mkck(spoff, spoffend, currpc, 4, &nspck);
+	if(spck && nspck > 0) {
+		ck = findck(spck, nspck, pc);
+		c = ck->c;
+		currpc = ck->pc;
+		currsp = ck->val;
+	}
+	for(; c < spoffend; c++) {
 		if (currpc >= pc)
 			return currsp;
 		u = *c;
@@ -1305,6 +1498,7 @@ pc2line(uvlong pc)
 	uchar *c, u;
 	uvlong currpc;
 	int32 currline;
+	Pcck *ck;
 
 	if(pcline == 0)
 		return -1;
@@ -1316,7 +1510,22 @@ pc2line(uvlong pc)
 	if(pc<currpc || pc>txtend)
 		return ~0;
 
-	for(c = pcline; c < pclineend && currpc < pc; c++) {
+	c = pcline;
+	if(lineck && lineckpc != currpc) {	/* firstinstr has been found since */
+		free(lineck);
+		lineck = 0;
+	}
+	if(lineck == 0) {
+		lineck = mkck(pcline, pclineend, currpc, 1, &nlineck);
+		lineckpc = currpc;
+	}
+	if(lineck && nlineck > 0) {
+		ck = findck(lineck, nlineck, pc);
+		c = ck->c;
+		currpc = ck->pc;
+		currline = ck->val;
+	}
+	for(; c < pclineend && currpc < pc; c++) {
 		u = *c;
 		if(u == 0) {
 			currline += (c[1]<<24)|(c[2]<<16)|(c[3]<<8)|c[4];
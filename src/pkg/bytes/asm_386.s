@@ -2,16 +2,43 @@
 // Use of this source code is governed by a BSD-style
 // license that can be found in the LICENSE file.
 
+// The searching and comparison loops are shared with the
+// runtime and the strings package; see runtime/386/asm.s.
+
 TEXT ·IndexByte(SB),7,$0
 	MOVL	p+0(FP), SI
-	MOVL	len+4(FP), CX
+	MOVL	len+4(FP), BX
+	MOVB	b+12(FP), AL
+	CALL	runtime·indexbytebody(SB)
+	MOVL	AX, ret+16(FP)
+	RET
+
+TEXT ·countByte(SB),7,$0
+	MOVL	p+0(FP), SI
+	MOVL	len+4(FP), BX
 	MOVB	b+12(FP), AL
-	MOVL	SI, DI
-	CLD; REPN; SCASB
-	JZ 3(PC)
-	MOVL	$-1, ret+16(FP)
+	CALL	runtime·countbytebody(SB)
+	MOVL	AX, ret+16(FP)
+	RET
+
+TEXT ·Equal(SB),7,$0
+	MOVL	alen+4(FP), BX
+	MOVL	blen+16(FP), CX
+	XORL	AX, AX
+	CMPL	BX, CX
+	JNE	eqret
+	MOVL	a+0(FP), SI
+	MOVL	b+12(FP), DI
+	CALL	runtime·memeqbody(SB)
+eqret:
+	MOVB	AX, ret+24(FP)
 	RET
-	SUBL	SI, DI
-	SUBL	$1, DI
-	MOVL	DI, ret+16(FP)
+
+TEXT ·Compare(SB),7,$0
+	MOVL	a+0(FP), SI
+	MOVL	alen+4(FP), BX
+	MOVL	b+12(FP), DI
+	MOVL	blen+16(FP), DX
+	CALL	runtime·cmpbody(SB)
+	MOVL	AX, ret+24(FP)
 	RET
@@ -6,3 +6,11 @@
 TEXT ·IndexByte(SB),7,$0
 	B	·indexBytePortable(SB)
 
+TEXT ·countByte(SB),7,$0
+	B	·countBytePortable(SB)
+
+TEXT ·Equal(SB),7,$0
+	B	·equalPortable(SB)
+
+TEXT ·Compare(SB),7,$0
+	B	·comparePortable(SB)
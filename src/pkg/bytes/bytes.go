@@ -11,9 +11,7 @@ import (
 	"utf8"
 )
 
-// Compare returns an integer comparing the two byte arrays lexicographically.
-// The result will be 0 if a==b, -1 if a < b, and +1 if a > b
-func Compare(a, b []byte) int {
+func comparePortable(a, b []byte) int {
 	m := len(a)
 	if m > len(b) {
 		m = len(b)
@@ -36,8 +34,7 @@ func Compare(a, b []byte) int {
 	return 0
 }
 
-// Equal returns a boolean reporting whether a == b.
-func Equal(a, b []byte) bool {
+func equalPortable(a, b []byte) bool {
 	if len(a) != len(b) {
 		return false
 	}
@@ -77,12 +74,33 @@ func Count(s, sep []byte) int {
 	if len(sep) == 0 {
 		return utf8.RuneCount(s) + 1
 	}
+	if len(sep) == 1 {
+		return countByte(s, sep[0])
+	}
 	c := sep[0]
 	n := 0
-	for i := 0; i+len(sep) <= len(s); i++ {
-		if s[i] == c && (len(sep) == 1 || Equal(s[i:i+len(sep)], sep)) {
+	for i := 0; i+len(sep) <= len(s); {
+		// skip ahead to the next possible match
+		o := IndexByte(s[i:len(s)-len(sep)+1], c)
+		if o < 0 {
+			break
+		}
+		i += o
+		if Equal(s[i:i+len(sep)], sep) {
+			n++
+			i += len(sep)
+		} else {
+			i++
+		}
+	}
+	return n
+}
+
+func countBytePortable(s []byte, c byte) int {
+	n := 0
+	for _, b := range s {
+		if b == c {
 			n++
-			i += len(sep) - 1
 		}
 	}
 	return n
@@ -95,8 +113,17 @@ func Index(s, sep []byte) int {
 		return 0
 	}
 	c := sep[0]
+	if n == 1 {
+		return IndexByte(s, c)
+	}
 	for i := 0; i+n <= len(s); i++ {
-		if s[i] == c && (n == 1 || Equal(s[i:i+n], sep)) {
+		// skip ahead to the next possible match
+		o := IndexByte(s[i:len(s)-n+1], c)
+		if o < 0 {
+			break
+		}
+		i += o
+		if Equal(s[i:i+n], sep) {
 			return i
 		}
 	}
@@ -6,3 +6,13 @@ package bytes
 
 // IndexByte returns the index of the first instance of c in s, or -1 if c is not present in s.
 func IndexByte(s []byte, c byte) int // asm_$GOARCH.s
+
+// Compare returns an integer comparing the two byte arrays lexicographically.
+// The result will be 0 if a==b, -1 if a < b, and +1 if a > b
+func Compare(a, b []byte) int // asm_$GOARCH.s
+
+// Equal returns a boolean reporting whether a == b.
+func Equal(a, b []byte) bool // asm_$GOARCH.s
+
+// countByte returns the number of instances of c in s.
+func countByte(s []byte, c byte) int // asm_$GOARCH.s
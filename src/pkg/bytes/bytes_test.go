@@ -73,6 +73,58 @@ func TestCompare(t *testing.T) {
 	}
 }
 
+func TestCompareLong(t *testing.T) {
+	// exercise every length and alignment the vector loops care about
+	a := make([]byte, 80)
+	b := make([]byte, 80)
+	for i := range a {
+		a[i] = byte(i + 1)
+		b[i] = byte(i + 1)
+	}
+	for off := 0; off < 8; off++ {
+		for n := 0; off+n <= len(a); n++ {
+			x := a[off : off+n]
+			y := b[off : off+n]
+			if !Equal(x, y) || Compare(x, y) != 0 {
+				t.Errorf("off=%d n=%d: Equal=%v Compare=%d", off, n, Equal(x, y), Compare(x, y))
+			}
+			for k := 0; k < n; k++ {
+				y[k] = 0
+				if Equal(x, y) != EqualPortable(x, y) {
+					t.Errorf("off=%d n=%d diff at %d: Equal=%v", off, n, k, Equal(x, y))
+				}
+				if c := Compare(x, y); c != ComparePortable(x, y) {
+					t.Errorf("off=%d n=%d diff at %d: Compare=%d", off, n, k, c)
+				}
+				if c := Compare(y, x); c != ComparePortable(y, x) {
+					t.Errorf("off=%d n=%d diff at %d: Compare(rev)=%d", off, n, k, c)
+				}
+				y[k] = x[k]
+			}
+			if n > 0 && Compare(x[:n-1], y) != -1 {
+				t.Errorf("off=%d n=%d: prefix does not compare less", off, n)
+			}
+		}
+	}
+}
+
+func TestCountByte(t *testing.T) {
+	b := make([]byte, 100)
+	for i := range b {
+		if i%3 == 0 {
+			b[i] = 'x'
+		}
+	}
+	for off := 0; off < 8; off++ {
+		for n := 0; off+n <= len(b); n++ {
+			s := b[off : off+n]
+			if c, want := CountByte(s, 'x'), CountBytePortable(s, 'x'); c != want {
+				t.Errorf("CountByte(b[%d:%d], 'x') = %d, want %d", off, off+n, c, want)
+			}
+		}
+	}
+}
+
 var indexTests = []BinOpTest{
 	{"", "", 0},
 	{"", "a", -1},
@@ -281,6 +333,40 @@ func BenchmarkIndexBytePortable64M(b *testing.B) {
 	bmIndex(b, IndexBytePortable, 64<<20)
 }
 
+func BenchmarkEqual32(b *testing.B) { bmEqual(b, Equal, 32) }
+
+func BenchmarkEqual4K(b *testing.B) { bmEqual(b, Equal, 4<<10) }
+
+func BenchmarkEqual4M(b *testing.B) { bmEqual(b, Equal, 4<<20) }
+
+func BenchmarkEqualPortable4K(b *testing.B) { bmEqual(b, EqualPortable, 4<<10) }
+
+func BenchmarkCompare4K(b *testing.B) {
+	bmEqual(b, func(x, y []byte) bool { return Compare(x, y) == 0 }, 4<<10)
+}
+
+func BenchmarkComparePortable4K(b *testing.B) {
+	bmEqual(b, func(x, y []byte) bool { return ComparePortable(x, y) == 0 }, 4<<10)
+}
+
+func BenchmarkCountByte4K(b *testing.B) { bmCount(b, CountByte, 4<<10) }
+
+func BenchmarkCountBytePortable4K(b *testing.B) { bmCount(b, CountBytePortable, 4<<10) }
+
+func BenchmarkIndexShort4K(b *testing.B) {
+	b.StopTimer()
+	buf := make([]byte, 4<<10)
+	for i := range buf {
+		buf[i] = 'a' + byte(i%16)
+	}
+	copy(buf[len(buf)-4:], "xyzw")
+	b.SetBytes(int64(len(buf)))
+	b.StartTimer()
+	for i := 0; i < b.N; i++ {
+		Index(buf, []byte("xyzw"))
+	}
+}
+
 var bmbuf []byte
 
 func bmIndex(b *testing.B, index func([]byte, byte) int, n int) {
@@ -845,3 +931,31 @@ func TestTitle(t *testing.T) {
 		}
 	}
 }
+
+func bmEqual(b *testing.B, equal func([]byte, []byte) bool, n int) {
+	b.StopTimer()
+	x := make([]byte, n)
+	y := make([]byte, n)
+	b.SetBytes(int64(n))
+	b.StartTimer()
+	for i := 0; i < b.N; i++ {
+		if !equal(x, y) {
+			panic("bad equal")
+		}
+	}
+}
+
+func bmCount(b *testing.B, count func([]byte, byte) int, n int) {
+	b.StopTimer()
+	buf := make([]byte, n)
+	for i := range buf {
+		buf[i] = byte(i)
+	}
+	b.SetBytes(int64(n))
+	b.StartTimer()
+	for i := 0; i < b.N; i++ {
+		if count(buf, 'x') != n/256 {
+			panic("bad count")
+		}
+	}
+}
@@ -6,3 +6,7 @@ package bytes
 
 // Export func for testing
 var IndexBytePortable = indexBytePortable
+var ComparePortable = comparePortable
+var EqualPortable = equalPortable
+var CountByte = countByte
+var CountBytePortable = countBytePortable
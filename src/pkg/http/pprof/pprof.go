@@ -18,10 +18,18 @@
 //
 //	pprof http://localhost:6060/debug/pprof/heap
 //
+// Adding ?gc=1 to the heap URL reports the heap as of the last
+// garbage collection instead of its current state.
+//
 // Or to look at a 30-second CPU profile:
 //
 //	pprof http://localhost:6060/debug/pprof/profile
 //
+// Or to look at where goroutines block, after setting
+// runtime.BlockProfileRate in the program:
+//
+//	pprof http://localhost:6060/debug/pprof/contention
+//
 package pprof
 
 import (
@@ -41,6 +49,7 @@ func init() {
 	http.Handle("/debug/pprof/cmdline", http.HandlerFunc(Cmdline))
 	http.Handle("/debug/pprof/profile", http.HandlerFunc(Profile))
 	http.Handle("/debug/pprof/heap", http.HandlerFunc(Heap))
+	http.Handle("/debug/pprof/contention", http.HandlerFunc(Contention))
 	http.Handle("/debug/pprof/symbol", http.HandlerFunc(Symbol))
 }
 
@@ -53,12 +62,25 @@ func Cmdline(w http.ResponseWriter, r *http.Request) {
 }
 
 // Heap responds with the pprof-formatted heap profile.
+// If the form value gc is non-zero, the profile is the one
+// as of the last garbage collection.
 // The package initialization registers it as /debug/pprof/heap.
 func Heap(w http.ResponseWriter, r *http.Request) {
 	w.Header().Set("Content-Type", "text/plain; charset=utf-8")
+	if gc, _ := strconv.Atoi(r.FormValue("gc")); gc != 0 {
+		pprof.WriteHeapProfileAtGC(w)
+		return
+	}
 	pprof.WriteHeapProfile(w)
 }
 
+// Contention responds with the pprof-formatted contention profile.
+// The package initialization registers it as /debug/pprof/contention.
+func Contention(w http.ResponseWriter, r *http.Request) {
+	w.Header().Set("Content-Type", "text/plain; charset=utf-8")
+	pprof.WriteBlockProfile(w)
+}
+
 // Profile responds with the pprof-formatted cpu profile.
 // The package initialization registers it as /debug/pprof/profile.
 func Profile(w http.ResponseWriter, r *http.Request) {
@@ -112,8 +134,9 @@ func Symbol(w http.ResponseWriter, r *http.Request) {
 		}
 		pc, _ := strconv.Btoui64(string(word), 0)
 		if pc != 0 {
-			f := runtime.FuncForPC(uintptr(pc))
-			if f != nil {
+			if label, ok := pprof.LabelForPC(uintptr(pc)); ok {
+				fmt.Fprintf(&buf, "%#x label:%s\n", pc, label)
+			} else if f := runtime.FuncForPC(uintptr(pc)); f != nil {
 				fmt.Fprintf(&buf, "%#x %s\n", pc, f.Name())
 			}
 		}
@@ -32,4 +32,9 @@ func Getgroups() ([]int, Error) {
 
 // Exit causes the current program to exit with the given status code.
 // Conventionally, code zero indicates success, non-zero an error.
-func Exit(code int) { syscall.Exit(code) }
+func Exit(code int) {
+	beforeexit()
+	syscall.Exit(code)
+}
+
+func beforeexit() // implemented in package runtime
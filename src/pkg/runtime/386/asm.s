@@ -91,6 +91,7 @@ TEXT runtime·mainstart(SB),7,$0
 	CALL	main·init(SB)
 	CALL	runtime·initdone(SB)
 	CALL	main·main(SB)
+	CALL	runtime·beforeexit(SB)
 	PUSHL	$0
 	CALL	runtime·exit(SB)
 	POPL	AX
@@ -131,6 +132,11 @@ TEXT runtime·gogo(SB), 7, $0
 	MOVL	gobuf_pc(BX), BX
 	JMP	BX
 
+// void gogoret(Gobuf*, uintptr)
+// gogo for oldstack; results are only in AX here.
+TEXT runtime·gogoret(SB), 7, $0
+	JMP	runtime·gogo(SB)
+
 // void gogocall(Gobuf*, void (*fn)(void))
 // restore state from Gobuf but then call fn.
 // (call fn, returning to state in Gobuf)
@@ -318,6 +324,12 @@ TEXT runtime·casp(SB), 7, $0
 	MOVL	$1, AX
 	RET
 
+// uint32 atomicload(uint32 volatile* addr);
+TEXT runtime·atomicload(SB), 7, $0
+	MOVL	4(SP), AX
+	MOVL	0(AX), AX
+	RET
+
 // void jmpdefer(fn, sp);
 // called from deferreturn.
 // 1. pop the caller
@@ -457,15 +469,51 @@ TEXT runtime·stackcheck(SB), 7, $0
 	INT	$3
 	RET
 
+// void memclr(byte *addr, uintptr n)
+// Sizes up to 16 bytes are cleared with straight-line
+// (possibly overlapping) stores, avoiding REP's startup cost.
 TEXT runtime·memclr(SB),7,$0
 	MOVL	4(SP), DI		// arg 1 addr
-	MOVL	8(SP), CX		// arg 2 count
-	ADDL	$3, CX
+	MOVL	8(SP), BX		// arg 2 count
+	XORL	AX, AX
+clrtail:
+	TESTL	BX, BX
+	JEQ	clr_0
+	CMPL	BX, $2
+	JBE	clr_1or2
+	CMPL	BX, $4
+	JBE	clr_3or4
+	CMPL	BX, $8
+	JBE	clr_5through8
+	CMPL	BX, $16
+	JBE	clr_9through16
+
+	MOVL	BX, CX
 	SHRL	$2, CX
-	MOVL	$0, AX
+	ANDL	$3, BX
 	CLD
 	REP
 	STOSL
+	JMP	clrtail
+
+clr_1or2:
+	MOVB	AX, (DI)
+	MOVB	AX, -1(DI)(BX*1)
+clr_0:
+	RET
+clr_3or4:
+	MOVW	AX, (DI)
+	MOVW	AX, -2(DI)(BX*1)
+	RET
+clr_5through8:
+	MOVL	AX, (DI)
+	MOVL	AX, -4(DI)(BX*1)
+	RET
+clr_9through16:
+	MOVL	AX, (DI)
+	MOVL	AX, 4(DI)
+	MOVL	AX, -8(DI)(BX*1)
+	MOVL	AX, -4(DI)(BX*1)
 	RET
 
 TEXT runtime·getcallerpc(SB),7,$0
@@ -500,4 +548,135 @@ TEXT runtime·emptyfunc(SB),0,$0
 TEXT runtime·abort(SB),7,$0
 	INT $0x3
 
+// The following bodies take their arguments in registers so that
+// they can be shared by the C runtime and by the bytes and strings
+// packages, whose assembly stubs load the Go arguments and CALL them.
+// The 386 port cannot assume SSE2, so they work a word at a time.
+
+// bool memeq(void *a, void *b, uintptr n)
+TEXT runtime·memeq(SB),7,$0
+	MOVL	a+0(FP), SI
+	MOVL	b+4(FP), DI
+	MOVL	n+8(FP), BX
+	JMP	runtime·memeqbody(SB)
+
+// a in SI, b in DI, count in BX.
+// Returns 1 in AX if the n bytes at a and b are equal, 0 otherwise.
+TEXT runtime·memeqbody(SB),7,$0
+	XORL	AX, AX
+eq_loop:
+	CMPL	BX, $4
+	JB	eq_bytes
+	MOVL	(SI), CX
+	CMPL	CX, (DI)
+	JNE	eq_done
+	ADDL	$4, SI
+	ADDL	$4, DI
+	SUBL	$4, BX
+	JMP	eq_loop
+eq_bytes:
+	TESTL	BX, BX
+	JEQ	eq_true
+	MOVB	(SI), CX
+	CMPB	CX, (DI)
+	JNE	eq_done
+	INCL	SI
+	INCL	DI
+	DECL	BX
+	JMP	eq_bytes
+eq_true:
+	MOVL	$1, AX
+eq_done:
+	RET
+
+// int32 mcmp(byte *a, byte *b, uint32 n)
+TEXT runtime·mcmp(SB),7,$0
+	MOVL	a+0(FP), SI
+	MOVL	b+4(FP), DI
+	MOVL	n+8(FP), BX
+	MOVL	BX, DX
+	JMP	runtime·cmpbody(SB)
+
+// a in SI, len(a) in BX, b in DI, len(b) in DX.
+// Returns -1, 0 or +1 in AX as a is lexicographically
+// less than, equal to or greater than b.
+TEXT runtime·cmpbody(SB),7,$0
+	MOVL	BX, BP			// BP = min(len(a), len(b))
+	CMPL	DX, BP
+	JGE	cmp_loop
+	MOVL	DX, BP
+
+	// find the first 4-byte word that differs
+cmp_loop:
+	CMPL	BP, $4
+	JB	cmp_bytes
+	MOVL	(SI), AX
+	CMPL	AX, (DI)
+	JNE	cmp_word
+	ADDL	$4, SI
+	ADDL	$4, DI
+	SUBL	$4, BP
+	JMP	cmp_loop
+
+	// the difference is within the next 4 bytes
+cmp_word:
+	MOVL	$4, BP
+cmp_bytes:
+	TESTL	BP, BP
+	JEQ	cmp_len
+	MOVB	(SI), AX
+	CMPB	AX, (DI)
+	JHI	cmp_gt
+	JCS	cmp_lt
+	INCL	SI
+	INCL	DI
+	DECL	BP
+	JMP	cmp_bytes
+
+	// common prefix is equal; the shorter one is less
+cmp_len:
+	CMPL	BX, DX
+	JGT	cmp_gt
+	JLT	cmp_lt
+	XORL	AX, AX
+	RET
+cmp_gt:
+	MOVL	$1, AX
+	RET
+cmp_lt:
+	MOVL	$-1, AX
+	RET
+
+// p in SI, count in BX, c in AL.
+// Returns in AX the index of the first c in p, or -1.
+TEXT runtime·indexbytebody(SB),7,$0
+	MOVL	SI, DI
+	MOVL	BX, CX
+	CLD; REPN; SCASB
+	JEQ	ib_success
+	MOVL	$-1, AX
+	RET
+ib_success:
+	SUBL	SI, DI
+	SUBL	$1, DI
+	MOVL	DI, AX
+	RET
+
+// p in SI, count in BX, c in AL.
+// Returns in AX the number of bytes in p equal to c.
+TEXT runtime·countbytebody(SB),7,$0
+	MOVL	AX, DX
+	XORL	AX, AX
+cb_loop:
+	TESTL	BX, BX
+	JEQ	cb_done
+	CMPB	DX, (SI)
+	JNE	2(PC)
+	INCL	AX
+	INCL	SI
+	DECL	BX
+	JMP	cb_loop
+cb_done:
+	RET
+
 GLOBL runtime·tls0(SB), $32
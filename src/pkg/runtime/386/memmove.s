@@ -30,9 +30,26 @@ TEXT runtime·memmove(SB), 7, $0
 	CMPL	BX, $0
 	JLT	fault
 
+/*
+ * REP instructions have a high startup cost, so small
+ * sizes are handled with straight-line code that loads
+ * everything before storing anything.  There is no SSE
+ * path: 386 code cannot assume SSE2.
+ */
+tail:
+	TESTL	BX, BX
+	JEQ	move_0
+	CMPL	BX, $2
+	JBE	move_1or2
+	CMPL	BX, $4
+	JBE	move_3or4
+	CMPL	BX, $8
+	JBE	move_5through8
+	CMPL	BX, $16
+	JBE	move_9through16
+
 /*
  * check and set for backwards
- * should we look closer for overlap?
  */
 	CMPL	SI, DI
 	JLS	back
@@ -40,21 +57,27 @@ TEXT runtime·memmove(SB), 7, $0
 /*
  * forward copy loop
  */
+forward:
 	MOVL	BX, CX
 	SHRL	$2, CX
 	ANDL	$3, BX
 
 	REP;	MOVSL
-	MOVL	BX, CX
-	REP;	MOVSB
+	JMP	tail
+
+back:
+/*
+ * check overlap
+ */
+	MOVL	SI, CX
+	ADDL	BX, CX
+	CMPL	CX, DI
+	JLS	forward
 
-	MOVL	to+0(FP),AX
-	RET
 /*
  * whole thing backwards has
  * adjusted addresses
  */
-back:
 	ADDL	BX, DI
 	ADDL	BX, SI
 	STD
@@ -70,13 +93,41 @@ back:
 	SUBL	$4, SI
 	REP;	MOVSL
 
-	ADDL	$3, DI
-	ADDL	$3, SI
-	MOVL	BX, CX
-	REP;	MOVSB
-
 	CLD
-	MOVL	to+0(FP),AX
+	ADDL	$4, DI
+	ADDL	$4, SI
+	SUBL	BX, DI
+	SUBL	BX, SI
+	JMP	tail
+
+move_1or2:
+	MOVB	(SI), AX
+	MOVB	-1(SI)(BX*1), CX
+	MOVB	AX, (DI)
+	MOVB	CX, -1(DI)(BX*1)
+move_0:
+	RET
+move_3or4:
+	MOVW	(SI), AX
+	MOVW	-2(SI)(BX*1), CX
+	MOVW	AX, (DI)
+	MOVW	CX, -2(DI)(BX*1)
+	RET
+move_5through8:
+	MOVL	(SI), AX
+	MOVL	-4(SI)(BX*1), CX
+	MOVL	AX, (DI)
+	MOVL	CX, -4(DI)(BX*1)
+	RET
+move_9through16:
+	MOVL	(SI), AX
+	MOVL	4(SI), CX
+	MOVL	-8(SI)(BX*1), DX
+	MOVL	-4(SI)(BX*1), BP
+	MOVL	AX, (DI)
+	MOVL	CX, 4(DI)
+	MOVL	DX, -8(DI)(BX*1)
+	MOVL	BP, -4(DI)(BX*1)
 	RET
 
 /*
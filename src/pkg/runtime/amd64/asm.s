@@ -75,6 +75,7 @@ TEXT runtime·mainstart(SB),7,$0
 	CALL	main·init(SB)
 	CALL	runtime·initdone(SB)
 	CALL	main·main(SB)
+	CALL	runtime·beforeexit(SB)
 	PUSHQ	$0
 	CALL	runtime·exit(SB)
 	POPQ	AX
@@ -115,6 +116,15 @@ TEXT runtime·gogo(SB), 7, $0
 	MOVQ	gobuf_pc(BX), BX
 	JMP	BX
 
+// void gogoret(Gobuf*, uintptr)
+// gogo for oldstack: also restore the
+// floating point result saved by lessstack.
+TEXT runtime·gogoret(SB), 7, $0
+	get_tls(CX)
+	MOVQ	m(CX), SI
+	MOVSD	m_cretf(SI), X0
+	JMP	runtime·gogo(SB)
+
 // void gogocall(Gobuf*, void (*fn)(void))
 // restore state from Gobuf but then call fn.
 // (call fn, returning to state in Gobuf)
@@ -124,9 +134,21 @@ TEXT runtime·gogocall(SB), 7, $0
 	MOVQ	gobuf_g(BX), DX
 	get_tls(CX)
 	MOVQ	DX, g(CX)
+	MOVQ	m(CX), SI
 	MOVQ	0(DX), CX	// make sure g != nil
 	MOVQ	gobuf_sp(BX), SP	// restore SP
 	MOVQ	gobuf_pc(BX), BX
+	// Register arguments saved by morestack.
+	MOVQ	(m_moreregs+0)(SI), R8
+	MOVQ	(m_moreregs+8)(SI), R9
+	MOVQ	(m_moreregs+16)(SI), R10
+	MOVQ	(m_moreregs+24)(SI), R11
+	MOVQ	(m_moreregs+32)(SI), R12
+	MOVQ	(m_moreregs+40)(SI), R13
+	MOVSD	(m_morefregs+0)(SI), X8
+	MOVSD	(m_morefregs+8)(SI), X9
+	MOVSD	(m_morefregs+16)(SI), X10
+	MOVSD	(m_morefregs+24)(SI), X11
 	PUSHQ	BX
 	JMP	AX
 	POPQ	BX	// not reached
@@ -188,6 +210,20 @@ TEXT runtime·morestack(SB),7,$0
 	MOVQ	0(SP), AX
 	MOVQ	AX, m_morepc(BX)
 
+	// f may take its arguments in registers
+	// (see ../../cmd/6g/ggen.c:/^regint);
+	// gogocall puts them back.
+	MOVQ	R8, (m_moreregs+0)(BX)
+	MOVQ	R9, (m_moreregs+8)(BX)
+	MOVQ	R10, (m_moreregs+16)(BX)
+	MOVQ	R11, (m_moreregs+24)(BX)
+	MOVQ	R12, (m_moreregs+32)(BX)
+	MOVQ	R13, (m_moreregs+40)(BX)
+	MOVSD	X8, (m_morefregs+0)(BX)
+	MOVSD	X9, (m_morefregs+8)(BX)
+	MOVSD	X10, (m_morefregs+16)(BX)
+	MOVSD	X11, (m_morefregs+24)(BX)
+
 	// Call newstack on m->g0's stack.
 	MOVQ	m_g0(BX), BP
 	MOVQ	BP, g(CX)
@@ -240,10 +276,12 @@ TEXT reflect·call(SB), 7, $0
 
 // Return point when leaving stack.
 TEXT runtime·lessstack(SB), 7, $0
-	// Save return value in m->cret
+	// Save return value in m->cret,
+	// and a floating point one in m->cretf.
 	get_tls(CX)
 	MOVQ	m(CX), BX
 	MOVQ	AX, m_cret(BX)
+	MOVSD	X0, m_cretf(BX)
 
 	// Call oldstack on m->g0's stack.
 	MOVQ	m_g0(BX), BP
@@ -364,6 +402,12 @@ TEXT runtime·casp(SB), 7, $0
 	MOVL	$1, AX
 	RET
 
+// uint32 atomicload(uint32 volatile* addr);
+TEXT runtime·atomicload(SB), 7, $0
+	MOVQ	8(SP), AX
+	MOVL	0(AX), AX
+	RET
+
 // void jmpdefer(fn, sp);
 // called from deferreturn.
 // 1. pop the caller
@@ -503,15 +547,96 @@ TEXT runtime·stackcheck(SB), 7, $0
 	INT	$3
 	RET
 
+// void memclr(byte *addr, uintptr n)
+// Sizes up to 256 bytes are cleared with straight-line
+// (possibly overlapping) stores, avoiding REP's startup cost.
 TEXT runtime·memclr(SB),7,$0
 	MOVQ	8(SP), DI		// arg 1 addr
-	MOVQ	16(SP), CX		// arg 2 count
-	ADDQ	$7, CX
+	MOVQ	16(SP), BX		// arg 2 count
+	XORQ	AX, AX
+	PXOR	X0, X0
+clrtail:
+	TESTQ	BX, BX
+	JEQ	clr_0
+	CMPQ	BX, $2
+	JBE	clr_1or2
+	CMPQ	BX, $4
+	JBE	clr_3or4
+	CMPQ	BX, $8
+	JBE	clr_5through8
+	CMPQ	BX, $16
+	JBE	clr_9through16
+	CMPQ	BX, $32
+	JBE	clr_17through32
+	CMPQ	BX, $64
+	JBE	clr_33through64
+	CMPQ	BX, $128
+	JBE	clr_65through128
+	CMPQ	BX, $256
+	JBE	clr_129through256
+
+	MOVQ	BX, CX
 	SHRQ	$3, CX
-	MOVQ	$0, AX
+	ANDQ	$7, BX
 	CLD
 	REP
 	STOSQ
+	JMP	clrtail
+
+clr_1or2:
+	MOVB	AX, (DI)
+	MOVB	AX, -1(DI)(BX*1)
+clr_0:
+	RET
+clr_3or4:
+	MOVW	AX, (DI)
+	MOVW	AX, -2(DI)(BX*1)
+	RET
+clr_5through8:
+	MOVL	AX, (DI)
+	MOVL	AX, -4(DI)(BX*1)
+	RET
+clr_9through16:
+	MOVQ	AX, (DI)
+	MOVQ	AX, -8(DI)(BX*1)
+	RET
+clr_17through32:
+	MOVOU	X0, (DI)
+	MOVOU	X0, -16(DI)(BX*1)
+	RET
+clr_33through64:
+	MOVOU	X0, (DI)
+	MOVOU	X0, 16(DI)
+	MOVOU	X0, -32(DI)(BX*1)
+	MOVOU	X0, -16(DI)(BX*1)
+	RET
+clr_65through128:
+	MOVOU	X0, (DI)
+	MOVOU	X0, 16(DI)
+	MOVOU	X0, 32(DI)
+	MOVOU	X0, 48(DI)
+	MOVOU	X0, -64(DI)(BX*1)
+	MOVOU	X0, -48(DI)(BX*1)
+	MOVOU	X0, -32(DI)(BX*1)
+	MOVOU	X0, -16(DI)(BX*1)
+	RET
+clr_129through256:
+	MOVOU	X0, (DI)
+	MOVOU	X0, 16(DI)
+	MOVOU	X0, 32(DI)
+	MOVOU	X0, 48(DI)
+	MOVOU	X0, 64(DI)
+	MOVOU	X0, 80(DI)
+	MOVOU	X0, 96(DI)
+	MOVOU	X0, 112(DI)
+	MOVOU	X0, -128(DI)(BX*1)
+	MOVOU	X0, -112(DI)(BX*1)
+	MOVOU	X0, -96(DI)(BX*1)
+	MOVOU	X0, -80(DI)(BX*1)
+	MOVOU	X0, -64(DI)(BX*1)
+	MOVOU	X0, -48(DI)(BX*1)
+	MOVOU	X0, -32(DI)(BX*1)
+	MOVOU	X0, -16(DI)(BX*1)
 	RET
 
 TEXT runtime·getcallerpc(SB),7,$0
@@ -529,4 +654,262 @@ TEXT runtime·getcallersp(SB),7,$0
 	MOVQ	sp+0(FP), AX
 	RET
 
+// The following bodies take their arguments in registers so that
+// they can be shared by the C runtime and by the bytes and strings
+// packages, whose assembly stubs load the Go arguments and CALL them.
+// Only R14 and R15 (m and g) are preserved.
+
+// bool memeq(void *a, void *b, uintptr n)
+TEXT runtime·memeq(SB),7,$0
+	MOVQ	a+0(FP), SI
+	MOVQ	b+8(FP), DI
+	MOVQ	n+16(FP), BX
+	JMP	runtime·memeqbody(SB)
+
+// a in SI, b in DI, count in BX.
+// Returns 1 in AX if the n bytes at a and b are equal, 0 otherwise.
+TEXT runtime·memeqbody(SB),7,$0
+	XORQ	AX, AX
+	CMPQ	BX, $8
+	JB	eq_small
+
+	// 16 bytes at a time using SSE2
+eq_loop:
+	CMPQ	BX, $16
+	JB	eq_leftover
+	MOVOU	(SI), X0
+	MOVOU	(DI), X1
+	PCMPEQB	X0, X1
+	PMOVMSKB X1, DX
+	CMPL	DX, $0xffff
+	JNE	eq_done
+	ADDQ	$16, SI
+	ADDQ	$16, DI
+	SUBQ	$16, BX
+	JMP	eq_loop
+
+	// 0-15 bytes left, but there were at least 8 to begin with,
+	// so finish with (possibly overlapping) 8-byte loads.
+eq_leftover:
+	CMPQ	BX, $8
+	JB	eq_last8
+	MOVQ	(SI), CX
+	MOVQ	(DI), DX
+	CMPQ	CX, DX
+	JNE	eq_done
+	ADDQ	$8, SI
+	ADDQ	$8, DI
+	SUBQ	$8, BX
+eq_last8:
+	MOVQ	-8(SI)(BX*1), CX
+	MOVQ	-8(DI)(BX*1), DX
+	CMPQ	CX, DX
+	SETEQ	AL
+	RET
+
+	// fewer than 8 bytes: check head and tail words,
+	// which overlap when the count is not a power of two.
+eq_small:
+	CMPQ	BX, $4
+	JB	eq_small2
+	MOVL	(SI), CX
+	MOVL	(DI), DX
+	CMPL	CX, DX
+	JNE	eq_done
+	MOVL	-4(SI)(BX*1), CX
+	MOVL	-4(DI)(BX*1), DX
+	CMPL	CX, DX
+	SETEQ	AL
+	RET
+eq_small2:
+	CMPQ	BX, $2
+	JB	eq_small1
+	MOVW	(SI), CX
+	MOVW	(DI), DX
+	CMPW	CX, DX
+	JNE	eq_done
+	MOVW	-2(SI)(BX*1), CX
+	MOVW	-2(DI)(BX*1), DX
+	CMPW	CX, DX
+	SETEQ	AL
+	RET
+eq_small1:
+	TESTQ	BX, BX
+	JEQ	eq_true
+	MOVB	(SI), CX
+	MOVB	(DI), DX
+	CMPB	CX, DX
+	SETEQ	AL
+	RET
+eq_true:
+	MOVL	$1, AX
+eq_done:
+	RET
+
+// int32 mcmp(byte *a, byte *b, uint32 n)
+TEXT runtime·mcmp(SB),7,$0
+	MOVQ	a+0(FP), SI
+	MOVQ	b+8(FP), DI
+	MOVL	n+16(FP), BX
+	MOVQ	BX, DX
+	JMP	runtime·cmpbody(SB)
+
+// a in SI, len(a) in BX, b in DI, len(b) in DX.
+// Returns -1, 0 or +1 in AX as a is lexicographically
+// less than, equal to or greater than b.
+TEXT runtime·cmpbody(SB),7,$0
+	MOVQ	BX, R8			// R8 = min(len(a), len(b))
+	CMPQ	DX, R8
+	JGE	cmp_loop
+	MOVQ	DX, R8
+
+	// find the first 16-byte chunk that differs
+cmp_loop:
+	CMPQ	R8, $16
+	JB	cmp_bytes
+	MOVOU	(SI), X0
+	MOVOU	(DI), X1
+	PCMPEQB	X0, X1
+	PMOVMSKB X1, AX
+	XORL	$0xffff, AX		// bits set where bytes differ
+	JNE	cmp_diff16
+	ADDQ	$16, SI
+	ADDQ	$16, DI
+	SUBQ	$16, R8
+	JMP	cmp_loop
+
+cmp_diff16:
+	BSFL	AX, AX
+	MOVB	(SI)(AX*1), CX
+	CMPB	CX, (DI)(AX*1)
+	JHI	cmp_gt
+	JMP	cmp_lt
+
+cmp_bytes:
+	TESTQ	R8, R8
+	JEQ	cmp_len
+	MOVB	(SI), CX
+	CMPB	CX, (DI)
+	JHI	cmp_gt
+	JCS	cmp_lt
+	INCQ	SI
+	INCQ	DI
+	DECQ	R8
+	JMP	cmp_bytes
+
+	// common prefix is equal; the shorter one is less
+cmp_len:
+	CMPQ	BX, DX
+	JGT	cmp_gt
+	JLT	cmp_lt
+	XORQ	AX, AX
+	RET
+cmp_gt:
+	MOVQ	$1, AX
+	RET
+cmp_lt:
+	MOVQ	$-1, AX
+	RET
+
+// p in SI, count in BX, c in AL.
+// Returns in AX the index of the first c in p, or -1.
+TEXT runtime·indexbytebody(SB),7,$0
+	MOVQ	SI, DI
+	CMPQ	BX, $16
+	JLT	ib_small
+
+	// shuffle X0 around so that each byte contains c
+	MOVD	AX, X0
+	PUNPCKLBW X0, X0
+	PUNPCKLBW X0, X0
+	PSHUFL	$0, X0, X0
+
+	// CX = start of the last 16-byte chunk
+	LEAQ	-16(SI)(BX*1), CX
+ib_sse:
+	CMPQ	DI, CX
+	JHI	ib_ssetail
+	MOVOU	(DI), X1
+	PCMPEQB	X0, X1
+	PMOVMSKB X1, DX
+	BSFL	DX, DX
+	JNE	ib_ssesuccess
+	ADDQ	$16, DI
+	JMP	ib_sse
+
+	// search the final chunk, which may overlap
+	// bytes already known not to match.
+ib_ssetail:
+	MOVQ	CX, DI
+	MOVOU	(DI), X1
+	PCMPEQB	X0, X1
+	PMOVMSKB X1, DX
+	BSFL	DX, DX
+	JNE	ib_ssesuccess
+	MOVQ	$-1, AX
+	RET
+
+ib_ssesuccess:
+	SUBQ	SI, DI
+	ADDQ	DX, DI
+	MOVQ	DI, AX
+	RET
+
+	// handle for lengths < 16
+ib_small:
+	MOVQ	BX, CX
+	REPN; SCASB
+	JEQ	ib_success
+	MOVQ	$-1, AX
+	RET
+ib_success:
+	SUBQ	SI, DI
+	SUBQ	$1, DI
+	MOVQ	DI, AX
+	RET
+
+// p in SI, count in BX, c in AL.
+// Returns in AX the number of bytes in p equal to c.
+TEXT runtime·countbytebody(SB),7,$0
+	MOVQ	AX, CX
+	XORQ	AX, AX
+	CMPQ	BX, $16
+	JLT	cb_tail
+
+	// X0 = c in every byte, X2 = 0, X3 = running total in two 64-bit halves
+	MOVD	CX, X0
+	PUNPCKLBW X0, X0
+	PUNPCKLBW X0, X0
+	PSHUFL	$0, X0, X0
+	PXOR	X2, X2
+	PXOR	X3, X3
+cb_sse:
+	MOVOU	(SI), X1
+	PCMPEQB	X0, X1			// 0xff where equal
+	PXOR	X4, X4
+	PSUBB	X1, X4			// 0x01 where equal
+	PSADBW	X2, X4			// sum bytes into each half
+	PADDQ	X4, X3
+	ADDQ	$16, SI
+	SUBQ	$16, BX
+	CMPQ	BX, $16
+	JGE	cb_sse
+	MOVQ	X3, AX
+	PSRLO	$8, X3
+	MOVQ	X3, DX
+	ADDQ	DX, AX
+
+	// count the last 0-15 bytes one at a time
+cb_tail:
+	TESTQ	BX, BX
+	JEQ	cb_done
+	CMPB	CX, (SI)
+	JNE	2(PC)
+	INCQ	AX
+	INCQ	SI
+	DECQ	BX
+	JMP	cb_tail
+cb_done:
+	RET
+
 GLOBL runtime·tls0(SB), $64
@@ -67,6 +67,7 @@ TEXT runtime·mainstart(SB),7,$4
 	EOR	R0, R0
 	MOVW	R0, 0(R13)
 	BL	main·main(SB)
+	BL	runtime·beforeexit(SB)
 	MOVW	$0, R0
 	MOVW	R0, 4(SP)
 	BL	runtime·exit(SB)
@@ -112,6 +113,11 @@ TEXT runtime·gogo(SB), 7, $-4
 	MOVW	gobuf_sp(R1), SP	// restore SP
 	MOVW	gobuf_pc(R1), PC
 
+// void gogoret(Gobuf*, uintptr)
+// gogo for oldstack; results are only in R0 here.
+TEXT runtime·gogoret(SB), 7, $-4
+	B	runtime·gogo(SB)
+
 // void gogocall(Gobuf*, void (*fn)(void))
 // restore state from Gobuf but then call fn.
 // (call fn, returning to state in Gobuf)
@@ -0,0 +1,42 @@
+// Copyright 2011 The Go Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include "runtime.h"
+
+// Memory comparison.  The 386 and amd64 versions
+// are written in assembly; see asm.s.
+
+int32
+runtime·mcmp(byte *s1, byte *s2, uint32 n)
+{
+	uint32 i;
+	byte c1, c2;
+
+	for(i=0; i<n; i++) {
+		c1 = s1[i];
+		c2 = s2[i];
+		if(c1 < c2)
+			return -1;
+		if(c1 > c2)
+			return +1;
+	}
+	return 0;
+}
+
+bool
+runtime·memeq(void *a, void *b, uintptr n)
+{
+	byte *ba, *bb, *aend;
+
+	ba = a;
+	bb = b;
+	aend = ba+n;
+	while(ba != aend) {
+		if(*ba != *bb)
+			return 0;
+		ba++;
+		bb++;
+	}
+	return 1;
+}
@@ -171,6 +171,7 @@ runtime·chansend(Hchan *c, byte *ep, bool *pres)
 {
 	SudoG *sg;
 	G* gp;
+	int64 t0;
 
 	if(c == nil)
 		runtime·panicstring("send to nil channel");
@@ -218,9 +219,16 @@ loop:
 		c->elemalg->copy(c->elemsize, sg->elem, ep);
 	g->param = nil;
 	g->status = Gwaiting;
+	if(runtime·tracing)
+		runtime·tracegostk(TraceEvGoBlock, g, TraceBlockSend);
+	t0 = 0;
+	if(runtime·BlockProfileRate > 0)
+		t0 = runtime·nanotime();
 	enqueue(&c->sendq, sg);
 	runtime·unlock(c);
 	runtime·gosched();
+	if(t0 != 0)
+		runtime·blockevent(runtime·nanotime() - t0, 1);
 
 	runtime·lock(c);
 	sg = g->param;
@@ -242,9 +250,16 @@ asynch:
 		}
 		sg = allocsg(c);
 		g->status = Gwaiting;
+		if(runtime·tracing)
+			runtime·tracegostk(TraceEvGoBlock, g, TraceBlockSend);
+		t0 = 0;
+		if(runtime·BlockProfileRate > 0)
+			t0 = runtime·nanotime();
 		enqueue(&c->sendq, sg);
 		runtime·unlock(c);
 		runtime·gosched();
+		if(t0 != 0)
+			runtime·blockevent(runtime·nanotime() - t0, 1);
 
 		runtime·lock(c);
 		goto asynch;
@@ -278,6 +293,7 @@ runtime·chanrecv(Hchan* c, byte *ep, bool *selected, bool *received)
 {
 	SudoG *sg;
 	G *gp;
+	int64 t0;
 
 	if(c == nil)
 		runtime·panicstring("receive from nil channel");
@@ -324,9 +340,16 @@ loop:
 	sg = allocsg(c);
 	g->param = nil;
 	g->status = Gwaiting;
+	if(runtime·tracing)
+		runtime·tracegostk(TraceEvGoBlock, g, TraceBlockRecv);
+	t0 = 0;
+	if(runtime·BlockProfileRate > 0)
+		t0 = runtime·nanotime();
 	enqueue(&c->recvq, sg);
 	runtime·unlock(c);
 	runtime·gosched();
+	if(t0 != 0)
+		runtime·blockevent(runtime·nanotime() - t0, 1);
 
 	runtime·lock(c);
 	sg = g->param;
@@ -356,9 +379,16 @@ asynch:
 		}
 		sg = allocsg(c);
 		g->status = Gwaiting;
+		if(runtime·tracing)
+			runtime·tracegostk(TraceEvGoBlock, g, TraceBlockRecv);
+		t0 = 0;
+		if(runtime·BlockProfileRate > 0)
+			t0 = runtime·nanotime();
 		enqueue(&c->recvq, sg);
 		runtime·unlock(c);
 		runtime·gosched();
+		if(t0 != 0)
+			runtime·blockevent(runtime·nanotime() - t0, 1);
 
 		runtime·lock(c);
 		goto asynch;
@@ -807,6 +837,8 @@ void
 runtime·block(void)
 {
 	g->status = Gwaiting;	// forever
+	if(runtime·tracing)
+		runtime·tracegostk(TraceEvGoBlock, g, TraceBlockSelect);
 	runtime·gosched();
 }
 
@@ -833,6 +865,7 @@ selectgo(Select **selp)
 	SudoG *sg;
 	G *gp;
 	byte *as;
+	int64 t0;
 	void *pc;
 
 	sel = *selp;
@@ -939,8 +972,15 @@ loop:
 
 	g->param = nil;
 	g->status = Gwaiting;
+	if(runtime·tracing)
+		runtime·tracegostk(TraceEvGoBlock, g, TraceBlockSelect);
+	t0 = 0;
+	if(runtime·BlockProfileRate > 0)
+		t0 = runtime·nanotime();
 	selunlock(sel);
 	runtime·gosched();
+	if(t0 != 0)
+		runtime·blockevent(runtime·nanotime() - t0, 1);
 
 	sellock(sel);
 	sg = g->param;
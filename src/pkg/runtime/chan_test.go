@@ -0,0 +1,111 @@
+// Copyright 2011 The Go Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+package runtime_test
+
+import (
+	"testing"
+)
+
+// Send and receive on a buffered channel that never blocks.
+func BenchmarkChanUncontended(b *testing.B) {
+	parallel(b, func(n int) {
+		c := make(chan int, 100)
+		for i := 0; i < n; i += 100 {
+			for j := 0; j < 100; j++ {
+				c <- j
+			}
+			for j := 0; j < 100; j++ {
+				<-c
+			}
+		}
+	})
+}
+
+// pingPong bounces a value between two goroutines over
+// channels with the given buffer size; each op is one round trip.
+func pingPong(b *testing.B, buf int) {
+	ping := make(chan int, buf)
+	pong := make(chan int, buf)
+	go func() {
+		for v := range ping {
+			pong <- v
+		}
+		close(pong)
+	}()
+	for i := 0; i < b.N; i++ {
+		ping <- i
+		<-pong
+	}
+	close(ping)
+	<-pong
+}
+
+func BenchmarkChanSync(b *testing.B)     { pingPong(b, 0) }
+func BenchmarkChanBuffered(b *testing.B) { pingPong(b, 1) }
+
+// Producers and consumers, $GOMAXPROCS of each, share one channel.
+func chanProdCons(b *testing.B, buf int) {
+	c := make(chan int, buf)
+	done := make(chan bool)
+	parallel(b, func(n int) {
+		go func() {
+			for i := 0; i < n; i++ {
+				<-c
+			}
+			done <- true
+		}()
+		for i := 0; i < n; i++ {
+			c <- i
+		}
+		<-done
+	})
+}
+
+func BenchmarkChanProdCons0(b *testing.B)   { chanProdCons(b, 0) }
+func BenchmarkChanProdCons100(b *testing.B) { chanProdCons(b, 100) }
+
+// Four senders, one receiver selecting among their channels.
+func BenchmarkSelectFanIn(b *testing.B) {
+	var c [4]chan int
+	for i := range c {
+		c[i] = make(chan int)
+	}
+	for i := range c {
+		n := b.N / 4
+		if i < b.N%4 {
+			n++
+		}
+		go func(c chan int, n int) {
+			for j := 0; j < n; j++ {
+				c <- j
+			}
+		}(c[i], n)
+	}
+	for i := 0; i < b.N; i++ {
+		select {
+		case <-c[0]:
+		case <-c[1]:
+		case <-c[2]:
+		case <-c[3]:
+		}
+	}
+}
+
+// A select that never blocks: one ready case and a default.
+func BenchmarkSelectNonblock(b *testing.B) {
+	c := make(chan int, 1)
+	d := make(chan int)
+	for i := 0; i < b.N; i++ {
+		select {
+		case c <- i:
+		default:
+		}
+		select {
+		case <-c:
+		case <-d:
+		default:
+		}
+	}
+}
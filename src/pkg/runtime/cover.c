@@ -0,0 +1,134 @@
+// Copyright 2011 The Go Authors.  All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+// Code coverage counters.
+//
+// A package compiled with 6g -C counts how many times each
+// straight-line run of its statements executes, and its init
+// registers a description of the counters here.  When the program
+// exits, if $GOCOVER names a file, the counts are appended to it,
+// one line per run:
+//
+//	file:line0,line1 index count
+//
+// cov -c reads the file and adds up the counts of repeated runs.
+
+#include "runtime.h"
+
+typedef struct Cover Cover;
+struct Cover
+{
+	Cover*	next;
+	uintptr	n;	// number of counters
+	uint32*	count;	// [n]
+	uint32*	pos;	// [n][3]: file index, first line, last line
+	uintptr	nfile;
+	String**	file;	// [nfile]
+};
+
+static struct {
+	Lock;
+	Cover	*list;
+	uint32	dumped;
+} cover;
+
+void
+runtime·coverregister(Cover *c)
+{
+	runtime·lock(&cover);
+	c->next = cover.list;
+	cover.list = c;
+	runtime·unlock(&cover);
+}
+
+typedef struct Buf Buf;
+struct Buf
+{
+	int32	fd;
+	int32	n;
+	byte	buf[4096];
+};
+
+static void
+flush(Buf *b)
+{
+	if(b->n > 0 && b->fd >= 0)
+		runtime·write(b->fd, b->buf, b->n);
+	b->n = 0;
+}
+
+static void
+putbytes(Buf *b, byte *p, int32 n)
+{
+	int32 m;
+
+	while(n > 0) {
+		if(b->n == sizeof b->buf)
+			flush(b);
+		m = sizeof b->buf - b->n;
+		if(m > n)
+			m = n;
+		runtime·mcpy(b->buf+b->n, p, m);
+		b->n += m;
+		p += m;
+		n -= m;
+	}
+}
+
+static void
+putuint(Buf *b, uint64 v)
+{
+	byte buf[20];
+	int32 i;
+
+	i = nelem(buf);
+	do
+		buf[--i] = '0' + v%10;
+	while((v /= 10) > 0);
+	putbytes(b, buf+i, nelem(buf)-i);
+}
+
+// Write the counts to $GOCOVER, once.
+void
+runtime·coverdump(void)
+{
+	static Buf b;
+	byte *path;
+	Cover *c;
+	uint32 *p;
+	String *f;
+	uintptr i;
+
+	if(cover.list == nil || !runtime·cas(&cover.dumped, 0, 1))
+		return;
+	path = runtime·getenv("GOCOVER");
+	if(path == nil || *path == 0)
+		return;
+	b.fd = runtime·coveropen(path);
+	if(b.fd < 0) {
+		runtime·printf("runtime: cannot open coverage file %s\n", path);
+		return;
+	}
+	b.n = 0;
+	for(c=cover.list; c; c=c->next) {
+		for(i=0; i<c->n; i++) {
+			p = c->pos + 3*i;
+			if(p[0] >= c->nfile)
+				continue;
+			f = c->file[p[0]];
+			putbytes(&b, f->str, f->len);
+			putbytes(&b, (byte*)":", 1);
+			putuint(&b, p[1]);
+			putbytes(&b, (byte*)",", 1);
+			putuint(&b, p[2]);
+			putbytes(&b, (byte*)" ", 1);
+			putuint(&b, i);
+			putbytes(&b, (byte*)" ", 1);
+			putuint(&b, c->count[i]);
+			putbytes(&b, (byte*)"\n", 1);
+		}
+	}
+	flush(&b);
+	// The file closes when the program exits.
+}
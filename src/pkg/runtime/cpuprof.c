@@ -11,42 +11,30 @@
 // to an arbitrary io.Writer, while the google-perftools code always
 // writes to an operating system file.
 //
-// The signal handler for the profiling clock tick adds a new stack trace
-// to a hash table tracking counts for recent traces.  Most clock ticks
-// hit in the cache.  In the event of a cache miss, an entry must be 
-// evicted from the hash table, copied to a log that will eventually be
-// written as profile data.  The google-perftools code flushed the
-// log itself during the signal handler.  This code cannot do that, because
-// the io.Writer might block or need system calls or locks that are not
-// safe to use from within the signal handler.  Instead, we split the log
-// into two halves and let the signal handler fill one half while a goroutine
-// is writing out the other half.  When the signal handler fills its half, it
-// offers to swap with the goroutine.  If the writer is not done with its half,
-// we lose the stack trace for this clock tick (and record that loss).
-// The goroutine interacts with the signal handler by calling getprofile() to
-// get the next log piece to write, implicitly handing back the last log
-// piece it obtained.
+// The signal handler for the profiling clock tick runs on every m
+// at once, so it must not share data with the other ms.  Each m has
+// its own ProfBuf, a ring of recent stack traces that only the m's
+// signal handler appends to.  A goroutine calling getprofile() reads
+// the rings, adds their traces to a hash table tracking counts for
+// recent traces, and returns the log of traces evicted from the hash
+// table as profile data.  Most traces hit in the hash table.  Because
+// only the reading goroutine touches the hash table and the log, they
+// need no locking, and the reader is free to take its time writing the
+// log to an io.Writer that might block or need system calls or locks
+// that are not safe to use from within the signal handler.
 //
-// The state of this dance between the signal handler and the goroutine
-// is encoded in the Profile.handoff field.  If handoff == 0, then the goroutine
-// is not using either log half and is waiting (or will soon be waiting) for
-// a new piece by calling notesleep(&p->wait).  If the signal handler
-// changes handoff from 0 to non-zero, it must call notewakeup(&p->wait)
-// to wake the goroutine.  The value indicates the number of entries in the
-// log half being handed off.  The goroutine leaves the non-zero value in
-// place until it has finished processing the log half and then flips the number
-// back to zero.  Setting the high bit in handoff means that the profiling is over, 
-// and the goroutine is now in charge of flushing the data left in the hash table
-// to the log and returning that data.  
+// A ProfBuf is a single-producer, single-consumer queue: the signal
+// handler advances tail after writing a trace, and the reader advances
+// head after consuming one, both with atomic operations.  If a ring is
+// full, the signal handler drops the trace and counts the loss.  When a
+// ring becomes half full, the signal handler wakes the reader, which
+// otherwise sleeps until the profile is turned off.  Profile.wakeme is
+// set by the reader before it sleeps; whoever changes it back to zero
+// is responsible for calling notewakeup(&p->wait).
 //
-// The handoff field is manipulated using atomic operations.
-// For the most part, the manipulation of handoff is orderly: if handoff == 0
-// then the signal handler owns it and can change it to non-zero.  
-// If handoff != 0 then the goroutine owns it and can change it to zero.
-// If that were the end of the story then we would not need to manipulate
-// handoff using atomic operations.  The operations are needed, however,
-// in order to let the log closer set the high bit to indicate "EOF" safely
-// in the situation when normally the goroutine "owns" handoff.
+// When a goroutine with a profiling label is running, its trace carries
+// the label as an extra outermost frame.  The runtime/pprof package
+// chooses labels that cannot be confused with program counters.
 
 #include "runtime.h"
 #include "malloc.h"
@@ -54,63 +42,78 @@
 enum
 {
 	HashSize = 1<<10,
-	LogSize = 1<<17,
+	LogSize = 1<<16,
 	Assoc = 4,
-	MaxStack = 64,
+	DefaultStack = 64,
+	MaxStack = 512,
+	BufSize = 1<<12,	// words in each m's ring; must be a power of 2
 };
 
 typedef struct Profile Profile;
 typedef struct Bucket Bucket;
 typedef struct Entry Entry;
+typedef struct ProfBuf ProfBuf;
 
 struct Entry {
 	uintptr count;
 	uintptr depth;
-	uintptr stack[MaxStack];
+	uintptr *stack;
 };
 
 struct Bucket {
 	Entry entry[Assoc];
 };
 
+// Each trace in buf is stored as its depth followed by its pcs.
+struct ProfBuf {
+	uint32 head;	// next word to read, advanced by the reader
+	uint32 tail;	// next word to write, advanced by the signal handler
+	uint32 lost;	// traces dropped because buf was full
+	uintptr buf[BufSize];
+	uintptr pcbuf[MaxStack+1];	// signal handler's traceback, +1 for label
+};
+
 struct Profile {
 	bool on;		// profiling is on
-	Note wait;		// goroutine waits here
+	bool reading;		// reader has not yet returned the end of the profile
+	Note wait;		// reader waits here
+	uint32 wakeme;		// reader is waiting (or about to wait) on wait
+	int32 depth;		// max stack depth for this profile
 	uintptr count;		// tick count
 	uintptr evicts;		// eviction count
 	uintptr lost;		// lost ticks that need to be logged
 	uintptr totallost;	// total lost ticks
+	uint32 noring;		// ticks dropped on ms that have no ring yet
 
 	// Active recent stack traces.
 	Bucket hash[HashSize];
+	uintptr *stk;		// storage for the entries' stacks
+	int32 nstk;		// depth stk was allocated for
 
 	// Log of traces evicted from hash.
-	// Signal handler has filled log[toggle][:nlog].
-	// Goroutine is writing log[1-toggle][:handoff].
-	uintptr log[2][LogSize/2];
+	uintptr log[LogSize];
 	uintptr nlog;
-	int32 toggle;
-	uint32 handoff;
-	
-	// Writer state.
-	// Writer maintains its own toggle to avoid races
-	// looking at signal handler's toggle.
-	uint32 wtoggle;
-	bool wholding;	// holding & need to release a log half
+
+	// Reader state.
+	uintptr pcbuf[MaxStack+1];	// trace being moved from a ProfBuf
+	bool wholding;	// log is being written; empty it on next getprofile
 	bool flushing;	// flushing hash table - profile is over
 };
 
 static Lock lk;
 static Profile *prof;
+static int32 depth = DefaultStack;
 
-static void tick(uintptr*, int32);
-static void add(Profile*, uintptr*, int32);
+static bool setrate(int32);
+static void tick(uint8*, uint8*, uint8*, G*);
+static bool add(Profile*, uintptr*, int32);
 static bool evict(Profile*, Entry*);
-static bool flushlog(Profile*);
+static bool drain(Profile*);
+static bool halffull(void);
 
 // LostProfileData is a no-op function used in profiles
 // to mark the number of profiling stack traces that were
-// discarded due to slow data writers.
+// discarded due to full buffers.
 static void LostProfileData(void) {
 }
 
@@ -118,9 +121,30 @@ static void LostProfileData(void) {
 // The user documentation is in debug.go.
 void
 runtime·SetCPUProfileRate(int32 hz)
+{
+	if(!setrate(hz))
+		runtime·printf("runtime: cannot set cpu profile rate until previous profile has finished.\n");
+}
+
+// cpuprofstart starts a profile at hz samples per second
+// if no profile is being taken or read, and reports whether
+// it did.  It is SetCPUProfileRate for callers that have
+// their own way to report a busy profiler.
+bool
+runtime·cpuprofstart(int32 hz)
+{
+	return hz > 0 && setrate(hz) && prof != nil && prof->on;
+}
+
+// setrate does the work of SetCPUProfileRate.
+// It returns false only if a profile was already running.
+static bool
+setrate(int32 hz)
 {
 	uintptr *p;
-	uintptr n;
+	int32 i, j;
+	M *mp;
+	ProfBuf *b;
 
 	// Clamp hz to something reasonable.
 	if(hz < 0)
@@ -135,17 +159,49 @@ runtime·SetCPUProfileRate(int32 hz)
 			if(prof == nil) {
 				runtime·printf("runtime: cpu profiling cannot allocate memory\n");
 				runtime·unlock(&lk);
-				return;
+				return true;
 			}
 		}
-		if(prof->on || prof->handoff != 0) {
-			runtime·printf("runtime: cannot set cpu profile rate until previous profile has finished.\n");
+		if(prof->on || prof->reading) {
 			runtime·unlock(&lk);
-			return;
+			return false;
 		}
 
+		// Size the hash table's stacks for the current depth,
+		// leaving room for a label frame.
+		if(prof->nstk != depth+1) {
+			if(prof->stk != nil)
+				runtime·SysFree(prof->stk, HashSize*Assoc*prof->nstk*sizeof(uintptr));
+			prof->nstk = 0;
+			prof->stk = runtime·SysAlloc(HashSize*Assoc*(depth+1)*sizeof(uintptr));
+			if(prof->stk == nil) {
+				runtime·printf("runtime: cpu profiling cannot allocate memory\n");
+				runtime·unlock(&lk);
+				return true;
+			}
+			prof->nstk = depth+1;
+			for(i=0; i<HashSize; i++)
+				for(j=0; j<Assoc; j++)
+					prof->hash[i].entry[j].stack = prof->stk + (i*Assoc+j)*prof->nstk;
+		}
+		prof->depth = depth;
+
+		// Give every m a ring, discarding traces left over from
+		// the last profile.  Ms created later get theirs when they
+		// first notice that profiling is on (see schedule in proc.c).
+		for(mp=runtime·allm; mp; mp=mp->alllink) {
+			runtime·cpuprofminit(mp);
+			b = mp->profbuf;
+			if(b != nil) {
+				b->head = b->tail;
+				b->lost = 0;
+			}
+		}
+		prof->noring = 0;
+
 		prof->on = true;
-		p = prof->log[0];
+		prof->reading = true;
+		p = prof->log;
 		// pprof binary header format.
 		// http://code.google.com/p/google-perftools/source/browse/trunk/src/profiledata.cc#117
 		*p++ = 0;  // count for header
@@ -153,47 +209,143 @@ runtime·SetCPUProfileRate(int32 hz)
 		*p++ = 0;  // version number
 		*p++ = 1000000 / hz;  // period (microseconds)
 		*p++ = 0;
-		prof->nlog = p - prof->log[0];
-		prof->toggle = 0;
+		prof->nlog = p - prof->log;
 		prof->wholding = false;
-		prof->wtoggle = 0;
 		prof->flushing = false;
+		prof->wakeme = 0;
 		runtime·noteclear(&prof->wait);
 
 		runtime·setcpuprofilerate(tick, hz);
-	} else if(prof->on) {
+	} else if(prof != nil && prof->on) {
 		runtime·setcpuprofilerate(nil, 0);
 		prof->on = false;
 
-		// Now add is not running anymore, and getprofile owns the entire log.
-		// Set the high bit in prof->handoff to tell getprofile.
-		for(;;) {
-			n = prof->handoff;
-			if(n&0x80000000)
-				runtime·printf("runtime: setcpuprofile(off) twice");
-			if(runtime·cas(&prof->handoff, n, n|0x80000000))
-				break;
-		}
-		if(n == 0) {
-			// we did the transition from 0 -> nonzero so we wake getprofile
+		// Wake the reader so that it flushes the profile.
+		if(runtime·cas(&prof->wakeme, 1, 0))
 			runtime·notewakeup(&prof->wait);
-		}
 	}
 	runtime·unlock(&lk);
+	return true;
 }
 
-static void
-tick(uintptr *pc, int32 n)
+// SetCPUProfileDepth sets the maximum depth of profile stack traces.
+// The user documentation is in debug.go.
+void
+runtime·SetCPUProfileDepth(int32 d)
 {
-	add(prof, pc, n);
+	if(d < 1)
+		d = 1;
+	if(d > MaxStack)
+		d = MaxStack;
+
+	runtime·lock(&lk);
+	if(prof != nil && (prof->on || prof->reading))
+		runtime·printf("runtime: cannot set cpu profile depth until previous profile has finished.\n");
+	else
+		depth = d;
+	runtime·unlock(&lk);
 }
 
-// add adds the stack trace to the profile.
+// SetCPUProfileLabel sets the calling goroutine's profiling label.
+// The user documentation is in debug.go.
+void
+runtime·SetCPUProfileLabel(uintptr label)
+{
+	g->proflabel = label;
+}
+
+void
+runtime·CPUProfileLabel(uintptr ret)
+{
+	ret = g->proflabel;
+	FLUSH(&ret);
+}
+
+// cpuprofminit gives mp a ring for profiling samples if it does not
+// have one already.  Rings are never freed: a signal handler might be
+// using one at any time.
+void
+runtime·cpuprofminit(M *mp)
+{
+	ProfBuf *b;
+
+	if(mp->profbuf != nil)
+		return;
+	b = runtime·SysAlloc(sizeof *b);
+	if(b == nil)
+		return;  // profiling signals on mp will be ignored
+	if(!runtime·casp((void**)&mp->profbuf, nil, b))
+		runtime·SysFree(b, sizeof *b);
+}
+
+// tick appends the current stack trace to m's ring.
 // It is called from signal handlers and other limited environments
 // and cannot allocate memory or acquire locks that might be
 // held at the time of the signal, nor can it use substantial amounts
-// of stack.  It is allowed to call evict.
+// of stack.
 static void
+tick(uint8 *pc, uint8 *sp, uint8 *lr, G *gp)
+{
+	Profile *p;
+	ProfBuf *b;
+	int32 i, n;
+	uint32 t, used;
+
+	p = prof;
+	if(p == nil || !p->on)
+		return;
+	b = m->profbuf;
+	if(b == nil) {
+		// This m has not picked up its ring yet.
+		// Count the tick so the profile shows it as lost.
+		runtime·xadd(&p->noring, 1);
+		return;
+	}
+
+	n = runtime·gentraceback(pc, sp, lr, gp, 0, b->pcbuf, p->depth);
+	if(n <= 0)
+		return;
+	if(gp != nil && gp->proflabel != 0)
+		b->pcbuf[n++] = gp->proflabel;
+
+	t = b->tail;
+	used = t - runtime·atomicload(&b->head);
+	if(used+1+n > BufSize) {
+		runtime·xadd(&b->lost, 1);
+	} else {
+		b->buf[t++%BufSize] = n;
+		for(i=0; i<n; i++)
+			b->buf[t++%BufSize] = b->pcbuf[i];
+		runtime·xadd(&b->tail, n+1);
+		used += n+1;
+	}
+	if(used >= BufSize/2 && runtime·cas(&p->wakeme, 1, 0))
+		runtime·notewakeup(&p->wait);
+}
+
+// logtrace appends a trace to the log.
+// It returns false if there is no room.
+static bool
+logtrace(Profile *p, uintptr count, uintptr *stk, int32 n)
+{
+	int32 i;
+	uintptr *q;
+
+	if(p->nlog+2+n > nelem(p->log))
+		return false;
+	q = p->log+p->nlog;
+	*q++ = count;
+	*q++ = n;
+	for(i=0; i<n; i++)
+		*q++ = stk[i];
+	p->nlog = q - p->log;
+	return true;
+}
+
+// add adds the stack trace to the profile.
+// It returns false if an entry had to be evicted
+// and there was no room for it in the log.
+static bool
 add(Profile *p, uintptr *pc, int32 n)
 {
 	int32 i, j;
@@ -201,9 +353,6 @@ add(Profile *p, uintptr *pc, int32 n)
 	Bucket *b;
 	Entry *e;
 
-	if(n > MaxStack)
-		n = MaxStack;
-	
 	// Compute hash.
 	h = 0;
 	for(i=0; i<n; i++) {
@@ -211,19 +360,19 @@ add(Profile *p, uintptr *pc, int32 n)
 		x = pc[i];
 		h += x*31 + x*7 + x*3;
 	}
-	p->count++;
 
 	// Add to entry count if already present in table.
 	b = &p->hash[h%HashSize];
 	for(i=0; i<Assoc; i++) {
 		e = &b->entry[i];
-		if(e->depth != n)	
+		if(e->depth != n)
 			continue;
 		for(j=0; j<n; j++)
 			if(e->stack[j] != pc[j])
 				goto ContinueAssoc;
 		e->count++;
-		return;
+		p->count++;
+		return true;
 	ContinueAssoc:;
 	}
 
@@ -233,84 +382,102 @@ add(Profile *p, uintptr *pc, int32 n)
 		if(b->entry[i].count < e->count)
 			e = &b->entry[i];
 	if(e->count > 0) {
-		if(!evict(p, e)) {
-			// Could not evict entry.  Record lost stack.
-			p->lost++;
-			p->totallost++;
-			return;
-		}
+		if(!evict(p, e))
+			return false;
 		p->evicts++;
 	}
-	
+
 	// Reuse the newly evicted entry.
 	e->depth = n;
 	e->count = 1;
 	for(i=0; i<n; i++)
 		e->stack[i] = pc[i];
+	p->count++;
+	return true;
 }
 
 // evict copies the given entry's data into the log, so that
-// the entry can be reused.  evict is called from add, which
-// is called from the profiling signal handler, so it must not
-// allocate memory or block.  It is safe to call flushLog.
-// evict returns true if the entry was copied to the log,
-// false if there was no room available.
+// the entry can be reused.  evict returns true if the entry
+// was copied to the log, false if there was no room available.
 static bool
 evict(Profile *p, Entry *e)
 {
-	int32 i, d, nslot;
-	uintptr *log, *q;
-	
-	d = e->depth;
-	nslot = d+2;
-	log = p->log[p->toggle];
-	if(p->nlog+nslot > nelem(p->log[0])) {
-		if(!flushlog(p))
-			return false;
-		log = p->log[p->toggle];
-	}
-	
-	q = log+p->nlog;
-	*q++ = e->count;
-	*q++ = d;
-	for(i=0; i<d; i++)
-		*q++ = e->stack[i];
-	p->nlog = q - log;
+	if(!logtrace(p, e->count, e->stack, e->depth))
+		return false;
 	e->count = 0;
 	return true;
 }
 
-// flushlog tries to flush the current log and switch to the other one.
-// flushlog is called from evict, called from add, called from the signal handler,
-// so it cannot allocate memory or block.  It can try to swap logs with
-// the writing goroutine, as explained in the comment at the top of this file.
+// drain moves the traces in every m's ring into the hash table.
+// It returns false if it had to stop because the log is full.
 static bool
-flushlog(Profile *p)
+drain(Profile *p)
 {
-	uintptr *log, *q;
-
-	if(!runtime·cas(&p->handoff, 0, p->nlog))
-		return false;
-	runtime·notewakeup(&p->wait);
-
-	p->toggle = 1 - p->toggle;
-	log = p->log[p->toggle];
-	q = log;
+	M *mp;
+	ProfBuf *b;
+	uint32 h, t, h1, n, i;
+	uintptr lostpc;
+
+	n = runtime·atomicload(&p->noring);
+	if(n > 0) {
+		runtime·xadd(&p->noring, -n);
+		p->lost += n;
+		p->totallost += n;
+	}
+	for(mp=runtime·allm; mp; mp=mp->alllink) {
+		b = mp->profbuf;
+		if(b == nil)
+			continue;
+		n = runtime·atomicload(&b->lost);
+		if(n > 0) {
+			runtime·xadd(&b->lost, -n);
+			p->lost += n;
+			p->totallost += n;
+		}
+		h = b->head;
+		t = runtime·atomicload(&b->tail);
+		while(h != t) {
+			h1 = h;
+			n = b->buf[h++%BufSize];
+			for(i=0; i<n; i++)
+				p->pcbuf[i] = b->buf[h++%BufSize];
+			if(!add(p, p->pcbuf, n)) {
+				runtime·xadd(&b->head, h1 - b->head);
+				return false;
+			}
+		}
+		runtime·xadd(&b->head, h - b->head);
+	}
 	if(p->lost > 0) {
-		*q++ = p->lost;
-		*q++ = 1;
-		*q++ = (uintptr)LostProfileData;
+		lostpc = (uintptr)LostProfileData;
+		if(!logtrace(p, p->lost, &lostpc, 1))
+			return false;
+		p->lost = 0;
 	}
-	p->nlog = q - log;
 	return true;
 }
 
+// halffull reports whether any m's ring is at least half full.
+static bool
+halffull(void)
+{
+	M *mp;
+	ProfBuf *b;
+
+	for(mp=runtime·allm; mp; mp=mp->alllink) {
+		b = mp->profbuf;
+		if(b != nil && runtime·atomicload(&b->tail) - b->head >= BufSize/2)
+			return true;
+	}
+	return false;
+}
+
 // getprofile blocks until the next block of profiling data is available
 // and returns it as a []byte.  It is called from the writing goroutine.
 Slice
 getprofile(Profile *p)
 {
-	uint32 i, j, n;
+	uint32 i, j;
 	Slice ret;
 	Bucket *b;
 	Entry *e;
@@ -318,97 +485,76 @@ getprofile(Profile *p)
 	ret.array = nil;
 	ret.len = 0;
 	ret.cap = 0;
-	
-	if(p == nil)	
+
+	if(p == nil)
 		return ret;
 
 	if(p->wholding) {
-		// Release previous log to signal handling side.
-		// Loop because we are racing against setprofile(off).
-		for(;;) {
-			n = p->handoff;
-			if(n == 0) {
-				runtime·printf("runtime: phase error during cpu profile handoff\n");
-				return ret;
-			}
-			if(n & 0x80000000) {
-				p->wtoggle = 1 - p->wtoggle;
-				p->wholding = false;
-				p->flushing = true;
-				goto flush;
-			}
-			if(runtime·cas(&p->handoff, n, 0))
-				break;
-		}
-		p->wtoggle = 1 - p->wtoggle;
+		// The caller is done with the log we returned last time.
+		p->nlog = 0;
 		p->wholding = false;
 	}
-	
+
 	if(p->flushing)
 		goto flush;
-	
-	if(!p->on && p->handoff == 0)
-		return ret;
-
-	// Wait for new log.
-	runtime·entersyscall();
-	runtime·notesleep(&p->wait);
-	runtime·exitsyscall();
-	runtime·noteclear(&p->wait);
 
-	n = p->handoff;
-	if(n == 0) {
-		runtime·printf("runtime: phase error during cpu profile wait\n");
+	if(!p->reading)
 		return ret;
-	}
-	if(n == 0x80000000) {
-		p->flushing = true;
-		goto flush;
-	}
-	n &= ~0x80000000;
 
-	// Return new log to caller.
-	p->wholding = true;
+	for(;;) {
+		if(!drain(p) || p->nlog >= nelem(p->log)/2)
+			goto returnlog;
+		if(!p->on) {
+			p->flushing = true;
+			goto flush;
+		}
 
-	ret.array = (byte*)p->log[p->wtoggle];
-	ret.len = n*sizeof(uintptr);
-	ret.cap = ret.len;
-	return ret;
+		// Wait for a ring to fill or for the profile to end.
+		// Check again after setting wakeme, in case the
+		// signal handler looked at wakeme before we set it.
+		runtime·noteclear(&p->wait);
+		if(!runtime·cas(&p->wakeme, 0, 1))
+			runtime·printf("runtime: phase error during cpu profile wait\n");
+		if((!p->on || halffull()) && runtime·cas(&p->wakeme, 1, 0))
+			continue;
+		runtime·entersyscall();
+		runtime·notesleep(&p->wait);
+		runtime·exitsyscall();
+	}
 
 flush:
 	// In flush mode.
-	// Add is no longer being called.  We own the log.
-	// Also, p->handoff is non-zero, so flushlog will return false.
-	// Evict the hash table into the log and return it.
+	// Profiling is off, so the rings are no longer filling.
+	// Move what is left in them to the hash table, then evict
+	// the hash table into the log and return it.
+	if(!drain(p))
+		goto returnlog;
 	for(i=0; i<HashSize; i++) {
 		b = &p->hash[i];
 		for(j=0; j<Assoc; j++) {
 			e = &b->entry[j];
 			if(e->count > 0 && !evict(p, e)) {
-				// Filled the log.  Stop the loop and return what we've got.
-				goto breakflush;
+				// Filled the log.  Return what we've got
+				// and pick up here on the next call.
+				goto returnlog;
 			}
 		}
 	}
-breakflush:
-
-	// Return pending log data.
-	if(p->nlog > 0) {
-		// Note that we're using toggle now, not wtoggle,
-		// because we're working on the log directly.
-		ret.array = (byte*)p->log[p->toggle];
-		ret.len = p->nlog*sizeof(uintptr);
-		ret.cap = ret.len;
-		p->nlog = 0;
-		return ret;
-	}
+	if(p->nlog > 0)
+		goto returnlog;
 
 	// Made it through the table without finding anything to log.
 	// Finally done.  Clean up and return nil.
 	p->flushing = false;
-	if(!runtime·cas(&p->handoff, p->handoff, 0))
-		runtime·printf("runtime: profile flush racing with something\n");
+	p->reading = false;
 	return ret;  // set to nil at top of function
+
+returnlog:
+	p->wholding = true;
+	ret.array = (byte*)p->log;
+	ret.len = p->nlog*sizeof(uintptr);
+	ret.cap = ret.len;
+	return ret;
 }
 
 // CPUProfile returns the next cpu profile block as a []byte.
@@ -419,3 +565,28 @@ runtime·CPUProfile(Slice ret)
 	ret = getprofile(prof);
 	FLUSH(&ret);
 }
+
+// cpuprofwrite writes the profile to fd until it has been
+// turned off and flushed, like profileWriter in runtime/pprof.
+// Once a write fails it keeps reading, and discarding,
+// the rest of the profile, so that the next one can start.
+void
+runtime·cpuprofwrite(int32 fd)
+{
+	Slice s;
+	byte *p;
+	int32 n;
+
+	for(;;) {
+		s = getprofile(prof);
+		if(s.array == nil)
+			break;
+		for(p=s.array; fd >= 0 && p < s.array+s.len; p+=n) {
+			runtime·entersyscall();
+			n = runtime·write(fd, p, s.array+s.len-p);
+			runtime·exitsyscall();
+			if(n <= 0)
+				fd = -1;
+		}
+	}
+}
@@ -55,6 +55,8 @@ initsema(uint32 *psema)
 void
 runtime·lock(Lock *l)
 {
+	int64 t0;
+
 	if(m->locks < 0)
 		runtime·throw("lock count");
 	m->locks++;
@@ -63,7 +65,12 @@ runtime·lock(Lock *l)
 		// Allocate semaphore if needed.
 		if(l->sema == 0)
 			initsema(&l->sema);
+		t0 = 0;
+		if(runtime·BlockProfileRate > 0)
+			t0 = runtime·nanotime();
 		runtime·mach_semacquire(l->sema);
+		if(t0 != 0)
+			runtime·blockevent(runtime·nanotime() - t0, 1);
 	}
 }
 
@@ -481,3 +488,32 @@ runtime·sigpanic(void)
 	}
 	runtime·panicstring(runtime·sigtab[g->sig].name);
 }
+
+// The profiling control channel for prof -i (see linux/profctl.c)
+// exists only on Linux.  Say so rather than ignore $GOPROFCTL.
+void
+runtime·profctlinit(void)
+{
+	byte *p;
+
+	p = runtime·getenv("GOPROFCTL");
+	if(p != nil && *p != 0)
+		runtime·printf("runtime: GOPROFCTL is set, but prof -i is not supported on OS X\n");
+}
+
+void
+runtime·profctlexit(void)
+{
+}
+
+// Coverage output (see cover.c) is written only on Linux.
+// A program built with -C and run with $GOCOVER set
+// must not appear to succeed without writing the counts.
+int32
+runtime·coveropen(byte *path)
+{
+	USED(path);
+	runtime·printf("runtime: GOCOVER is set, but coverage output is not supported on OS X\n");
+	runtime·exit(2);
+	return -1;
+}
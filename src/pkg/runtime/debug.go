@@ -62,6 +62,8 @@ var MemProfileRate int = 512 * 1024
 type MemProfileRecord struct {
 	AllocBytes, FreeBytes     int64       // number of bytes allocated, freed
 	AllocObjects, FreeObjects int64       // number of objects allocated, freed
+	RecentAllocBytes          int64       // bytes allocated between the last two GCs
+	RecentAllocObjects        int64       // objects allocated between the last two GCs
 	Stack0                    [32]uintptr // stack trace for this record; ends at first 0 entry
 }
 
@@ -97,6 +99,56 @@ func (r *MemProfileRecord) Stack() []uintptr {
 // of calling MemProfile directly.
 func MemProfile(p []MemProfileRecord, inuseZero bool) (n int, ok bool)
 
+// MemProfileAtGC is like MemProfile, but returns the profile as of
+// the end of the most recent garbage collection.  Unlike the current
+// profile, which counts objects that are garbage but not yet collected
+// as in use, it describes exactly the objects that collection found live.
+// Dividing RecentAllocBytes by MemStats.LastGC - MemStats.PrevGC
+// gives each call sequence's allocation rate during the last GC cycle.
+func MemProfileAtGC(p []MemProfileRecord, inuseZero bool) (n int, ok bool)
+
+// BlockProfileRate controls the fraction of blocking events
+// that are recorded and reported in the blocking profile.
+// The profiler aims to sample an average of one blocking event
+// per BlockProfileRate nanoseconds spent blocked: events at least
+// that long are always recorded, shorter ones in proportion to
+// their length.
+//
+// To include every blocking event in the profile, set BlockProfileRate to 1.
+// To turn off profiling entirely, set BlockProfileRate to 0, the default.
+var BlockProfileRate int
+
+// A BlockProfileRecord describes the blocking events at
+// a particular call sequence (stack trace).
+type BlockProfileRecord struct {
+	Count       int64       // number of events recorded
+	Nanoseconds int64       // total time blocked in those events
+	Stack0      [32]uintptr // stack trace for this record; ends at first 0 entry
+}
+
+// Stack returns the stack trace associated with the record,
+// a prefix of r.Stack0.
+func (r *BlockProfileRecord) Stack() []uintptr {
+	for i, v := range r.Stack0 {
+		if v == 0 {
+			return r.Stack0[0:i]
+		}
+	}
+	return r.Stack0[0:]
+}
+
+// BlockProfile returns n, the number of records in the current blocking profile.
+// If len(p) >= n, BlockProfile copies the profile into p and returns n, true.
+// If len(p) < n, BlockProfile does not change p and returns n, false.
+//
+// The profile records time goroutines spent blocked sending, receiving
+// and selecting on channels and acquiring semaphores (as in sync.Mutex),
+// and time threads spent waiting for contended runtime locks.
+// Most clients should use the runtime/pprof package or
+// the testing package's -test.blockprofile flag instead
+// of calling BlockProfile directly.
+func BlockProfile(p []BlockProfileRecord) (n int, ok bool)
+
 // CPUProfile returns the next chunk of binary CPU profiling stack trace data,
 // blocking until data is available.  If profiling is turned off and all the profile
 // data accumulated while it was on has been returned, CPUProfile returns nil.
@@ -113,3 +165,38 @@ func CPUProfile() []byte
 // the testing package's -test.cpuprofile flag instead of calling
 // SetCPUProfileRate directly.
 func SetCPUProfileRate(hz int)
+
+// SetCPUProfileDepth sets the maximum number of stack frames recorded
+// in each CPU profile sample.  The default is 64; the limit is 512.
+// The depth cannot be changed while a profile is being taken.
+func SetCPUProfileDepth(depth int)
+
+// SetCPUProfileLabel sets the profiling label of the calling goroutine.
+// Goroutines inherit the label of the goroutine that starts them.
+// CPU profile samples taken while a goroutine with a non-zero label
+// is running record the label as an extra, outermost stack frame.
+// Most clients should use the runtime/pprof package's SetLabel instead
+// of calling SetCPUProfileLabel directly.
+func SetCPUProfileLabel(label uintptr)
+
+// CPUProfileLabel returns the profiling label of the calling goroutine.
+func CPUProfileLabel() uintptr
+
+// StartTrace turns on the execution tracer, which records scheduling,
+// blocking, system call and garbage collection events with timestamps.
+// It returns false if a trace is already being taken, or if the data
+// from the last trace has not all been read.
+// Most clients should use the runtime/pprof package or
+// the testing package's -test.trace flag instead of calling
+// StartTrace directly.
+func StartTrace() bool
+
+// StopTrace turns off the execution tracer.
+func StopTrace()
+
+// ReadTrace returns the next chunk of binary execution trace data,
+// blocking until data is available.  If tracing is turned off and all the
+// data accumulated while it was on has been returned, ReadTrace returns nil.
+// The caller must save the returned data before calling ReadTrace again.
+// The format is described in trace.c and decoded by cmd/gotrace.
+func ReadTrace() []byte
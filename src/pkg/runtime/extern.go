@@ -153,9 +153,10 @@ func Semrelease(s *uint32)
 // to depend on a finalizer to flush an in-memory I/O buffer such as a
 // bufio.Writer, because the buffer would not be flushed at program exit.
 //
-// A single goroutine runs all finalizers for a program, sequentially.
-// If a finalizer must run for a long time, it should do so by starting
-// a new goroutine.
+// A small pool of goroutines runs the finalizers for a program, so
+// finalizers for different objects may run concurrently and must
+// synchronize any state they share.  If a finalizer must run for a
+// long time, it should do so by starting a new goroutine.
 //
 // TODO(rsc): allow f to have (ignored) return values
 //
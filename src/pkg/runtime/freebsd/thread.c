@@ -43,18 +43,25 @@ static void
 umtx_lock(Lock *l)
 {
 	uint32 v;
+	int64 t0;
 
+	t0 = 0;
 again:
 	v = l->key;
 	if((v&1) == 0){
-		if(runtime·cas(&l->key, v, v|1))
+		if(runtime·cas(&l->key, v, v|1)) {
+			if(t0 != 0)
+				runtime·blockevent(runtime·nanotime() - t0, 2);
 			return;
+		}
 		goto again;
 	}
 
 	if(!runtime·cas(&l->key, v, v+2))
 		goto again;
 
+	if(t0 == 0 && runtime·BlockProfileRate > 0)
+		t0 = runtime·nanotime();
 	umtx_wait(&l->key, v+2);
 
 	for(;;){
@@ -204,3 +211,32 @@ runtime·sigpanic(void)
 	}
 	runtime·panicstring(runtime·sigtab[g->sig].name);
 }
+
+// The profiling control channel for prof -i (see linux/profctl.c)
+// exists only on Linux.  Say so rather than ignore $GOPROFCTL.
+void
+runtime·profctlinit(void)
+{
+	byte *p;
+
+	p = runtime·getenv("GOPROFCTL");
+	if(p != nil && *p != 0)
+		runtime·printf("runtime: GOPROFCTL is set, but prof -i is not supported on FreeBSD\n");
+}
+
+void
+runtime·profctlexit(void)
+{
+}
+
+// Coverage output (see cover.c) is written only on Linux.
+// A program built with -C and run with $GOCOVER set
+// must not appear to succeed without writing the counts.
+int32
+runtime·coveropen(byte *path)
+{
+	USED(path);
+	runtime·printf("runtime: GOCOVER is set, but coverage output is not supported on FreeBSD\n");
+	runtime·exit(2);
+	return -1;
+}
@@ -30,6 +30,59 @@ TEXT runtime·write(SB),7,$0
 	INT	$0x80
 	RET
 
+TEXT runtime·read(SB),7,$0
+	MOVL	$3, AX		// syscall - read
+	MOVL	4(SP),  BX
+	MOVL	8(SP), CX
+	MOVL	12(SP), DX
+	INT	$0x80
+	RET
+
+TEXT runtime·open(SB),7,$0
+	MOVL	$5, AX		// syscall - open
+	MOVL	4(SP),  BX
+	MOVL	8(SP), CX
+	MOVL	12(SP), DX
+	INT	$0x80
+	RET
+
+TEXT runtime·close(SB),7,$0
+	MOVL	$6, AX		// syscall - close
+	MOVL	4(SP),  BX
+	INT	$0x80
+	RET
+
+TEXT runtime·mknod(SB),7,$0
+	MOVL	$14, AX		// syscall - mknod
+	MOVL	4(SP),  BX
+	MOVL	8(SP), CX
+	MOVL	12(SP), DX
+	INT	$0x80
+	RET
+
+TEXT runtime·getpid(SB),7,$0
+	MOVL	$20, AX		// syscall - getpid
+	INT	$0x80
+	RET
+
+TEXT runtime·getuid(SB),7,$0
+	MOVL	$199, AX	// syscall - getuid32
+	INT	$0x80
+	RET
+
+TEXT runtime·fstat(SB),7,$0
+	MOVL	$197, AX	// syscall - fstat64
+	MOVL	4(SP), BX
+	MOVL	8(SP), CX
+	INT	$0x80
+	RET
+
+TEXT runtime·unlink(SB),7,$0
+	MOVL	$10, AX		// syscall - unlink
+	MOVL	4(SP), BX
+	INT	$0x80
+	RET
+
 TEXT runtime·raisesigpipe(SB),7,$12
 	MOVL	$224, AX	// syscall - gettid
 	INT	$0x80
@@ -36,6 +36,51 @@ TEXT runtime·write(SB),7,$0-24
 	SYSCALL
 	RET
 
+TEXT runtime·read(SB),7,$0-24
+	MOVL	8(SP), DI
+	MOVQ	16(SP), SI
+	MOVL	24(SP), DX
+	MOVL	$0, AX			// syscall entry
+	SYSCALL
+	RET
+
+TEXT runtime·close(SB),7,$0-8
+	MOVL	8(SP), DI
+	MOVL	$3, AX			// syscall entry
+	SYSCALL
+	RET
+
+TEXT runtime·mknod(SB),7,$0-16
+	MOVQ	8(SP), DI
+	MOVL	16(SP), SI
+	MOVL	20(SP), DX
+	MOVL	$133, AX		// syscall entry
+	SYSCALL
+	RET
+
+TEXT runtime·getpid(SB),7,$0
+	MOVL	$39, AX			// syscall entry
+	SYSCALL
+	RET
+
+TEXT runtime·getuid(SB),7,$0
+	MOVL	$102, AX		// syscall entry
+	SYSCALL
+	RET
+
+TEXT runtime·fstat(SB),7,$0-16
+	MOVL	8(SP), DI
+	MOVQ	16(SP), SI
+	MOVL	$5, AX			// syscall entry
+	SYSCALL
+	RET
+
+TEXT runtime·unlink(SB),7,$0-8
+	MOVQ	8(SP), DI
+	MOVL	$87, AX			// syscall entry
+	SYSCALL
+	RET
+
 TEXT runtime·raisesigpipe(SB),7,$12
 	MOVL	$186, AX	// syscall - gettid
 	SYSCALL
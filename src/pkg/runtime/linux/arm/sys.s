@@ -15,7 +15,15 @@
 #define SYS_BASE 0x0
 
 #define SYS_exit (SYS_BASE + 1)
+#define SYS_read (SYS_BASE + 3)
 #define SYS_write (SYS_BASE + 4)
+#define SYS_open (SYS_BASE + 5)
+#define SYS_close (SYS_BASE + 6)
+#define SYS_mknod (SYS_BASE + 14)
+#define SYS_getpid (SYS_BASE + 20)
+#define SYS_unlink (SYS_BASE + 10)
+#define SYS_fstat64 (SYS_BASE + 197)
+#define SYS_getuid32 (SYS_BASE + 199)
 #define SYS_gettimeofday (SYS_BASE + 78)
 #define SYS_clone (SYS_BASE + 120)
 #define SYS_rt_sigreturn (SYS_BASE + 173)
@@ -40,6 +48,59 @@ TEXT runtime·write(SB),7,$0
 	SWI	$0
 	RET
 
+TEXT runtime·read(SB),7,$0
+	MOVW	0(FP), R0
+	MOVW	4(FP), R1
+	MOVW	8(FP), R2
+	MOVW	$SYS_read, R7
+	SWI	$0
+	RET
+
+TEXT runtime·open(SB),7,$0
+	MOVW	0(FP), R0
+	MOVW	4(FP), R1
+	MOVW	8(FP), R2
+	MOVW	$SYS_open, R7
+	SWI	$0
+	RET
+
+TEXT runtime·close(SB),7,$0
+	MOVW	0(FP), R0
+	MOVW	$SYS_close, R7
+	SWI	$0
+	RET
+
+TEXT runtime·mknod(SB),7,$0
+	MOVW	0(FP), R0
+	MOVW	4(FP), R1
+	MOVW	8(FP), R2
+	MOVW	$SYS_mknod, R7
+	SWI	$0
+	RET
+
+TEXT runtime·getpid(SB),7,$0
+	MOVW	$SYS_getpid, R7
+	SWI	$0
+	RET
+
+TEXT runtime·getuid(SB),7,$0
+	MOVW	$SYS_getuid32, R7
+	SWI	$0
+	RET
+
+TEXT runtime·fstat(SB),7,$0
+	MOVW	0(FP), R0
+	MOVW	4(FP), R1
+	MOVW	$SYS_fstat64, R7
+	SWI	$0
+	RET
+
+TEXT runtime·unlink(SB),7,$0
+	MOVW	0(FP), R0
+	MOVW	$SYS_unlink, R7
+	SWI	$0
+	RET
+
 TEXT runtime·exit(SB),7,$-4
 	MOVW	0(FP), R0
 	MOVW	$SYS_exit_group, R7
@@ -17,3 +17,13 @@ void	runtime·sigpanic(void);
 void runtime·setitimer(int32, Itimerval*, Itimerval*);
 
 void	runtime·raisesigpipe(void);
+
+// For the profiling control channel, see profctl.c.
+int32	runtime·open(uint8*, int32, int32);
+int32	runtime·read(int32, void*, int32);
+int32	runtime·close(int32);
+int32	runtime·mknod(uint8*, int32, int32);
+int32	runtime·getpid(void);
+int32	runtime·getuid(void);
+int32	runtime·fstat(int32, void*);
+int32	runtime·unlink(uint8*);
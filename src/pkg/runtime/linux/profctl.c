@@ -0,0 +1,204 @@
+// Copyright 2011 The Go Authors.  All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+// Control channel for in-process CPU profiling (prof -i).
+//
+// If $GOPROFCTL is set when the program starts, the runtime makes
+// a FIFO named /tmp/goprof.<pid> and a goroutine that waits for
+// someone to open it.  The profiler writes one line, "hz path\n",
+// where path names a FIFO of its own, and then holds the control
+// FIFO open for as long as it wants samples.  The goroutine turns
+// on the CPU profiler at hz samples per second and another
+// goroutine copies the profile log, the same bytes that
+// runtime.CPUProfile returns, to path.  When the profiler closes
+// the control FIFO, the profile is turned off and flushed, and the
+// goroutine waits for the next request.
+//
+// The program never stops: the samples come from its own SIGPROF
+// handler, and the profiler symbolizes the program counters itself.
+// If the program is already taking a CPU profile, the request gets
+// an empty log.
+//
+// Only the program's own user may send requests.  The control FIFO
+// is made with mode 0600; if something already exists at its path,
+// another user may have planted it, so the runtime refuses to listen.
+// After each open it checks that the FIFO is still its own, and it
+// removes the FIFO when the program exits (see runtime·beforeexit).
+//
+// While it waits, the control goroutine sits in open(), and a
+// goroutine in a system call counts as running.  So with $GOPROFCTL
+// set, a program whose other goroutines are all asleep hangs instead
+// of dying with "all goroutines are asleep - deadlock!".  Use it on
+// programs that are meant to keep running, like servers.
+
+#include "runtime.h"
+#include "defs.h"
+#include "os.h"
+
+enum
+{
+	O_RDONLY = 0,
+	O_WRONLY = 1,
+	S_IFMT = 0170000,
+	S_IFIFO = 010000,
+	EINTR = 4,
+	EEXIST = 17,
+};
+
+static struct {
+	byte	path[32];	// control FIFO
+	int32	datafd;		// where the writer sends the profile
+	Note	done;		// writer has finished
+} ctl;
+
+static void profctl(void);
+static void profwriter(void);
+
+void
+runtime·profctlinit(void)
+{
+	byte *p, buf[12];
+	int32 i, n;
+
+	p = runtime·getenv("GOPROFCTL");
+	if(p == nil || *p == 0)
+		return;
+
+	n = runtime·getpid();
+	i = nelem(buf);
+	do
+		buf[--i] = '0' + n%10;
+	while((n /= 10) > 0);
+	p = ctl.path;
+	runtime·mcpy(p, (byte*)"/tmp/goprof.", 12);
+	runtime·mcpy(p+12, buf+i, nelem(buf)-i);
+	p[12+nelem(buf)-i] = 0;
+
+	n = runtime·mknod(ctl.path, S_IFIFO|0600, 0);
+	if(n == -EEXIST) {
+		runtime·printf("runtime: profiling FIFO %s already exists; remove it to use prof -i\n", ctl.path);
+		ctl.path[0] = 0;
+		return;
+	}
+	if(n < 0) {
+		runtime·printf("runtime: cannot make profiling FIFO %s: errno=%d\n", ctl.path, -n);
+		ctl.path[0] = 0;
+		return;
+	}
+	runtime·newproc1((byte*)profctl, nil, 0, 0, runtime·profctlinit);
+}
+
+// Called when the program exits.
+void
+runtime·profctlexit(void)
+{
+	if(ctl.path[0] != 0)
+		runtime·unlink(ctl.path);
+}
+
+// ours reports whether fd is a FIFO owned by this process's user.
+// The kernel's struct stat differs by architecture: amd64 has
+// st_mode at byte 24 and st_uid at 28; 386 and arm use stat64,
+// with st_mode at 16 and st_uid at 24.
+static bool
+ours(int32 fd)
+{
+	uint64 st[32];
+	uint32 mode, uid;
+
+	if(runtime·fstat(fd, st) < 0)
+		return false;
+	if(sizeof(uintptr) == 8) {
+		mode = ((uint32*)st)[6];
+		uid = ((uint32*)st)[7];
+	} else {
+		mode = ((uint32*)st)[4];
+		uid = ((uint32*)st)[6];
+	}
+	return (mode&S_IFMT) == S_IFIFO && uid == runtime·getuid();
+}
+
+// readline reads the first line from fd into buf, which holds n bytes,
+// and returns its length without the newline.
+static int32
+readline(int32 fd, byte *buf, int32 n)
+{
+	int32 i, r;
+	byte *nl;
+
+	nl = nil;
+	for(i=0; i<n-1 && nl == nil; i+=r) {
+		r = runtime·read(fd, buf+i, n-1-i);
+		if(r == -EINTR)
+			r = 0;
+		else if(r <= 0)
+			break;
+		nl = runtime·mchr(buf+i, '\n', buf+i+r);
+	}
+	if(nl != nil)
+		i = nl - buf;
+	buf[i] = 0;
+	return i;
+}
+
+static void
+profctl(void)
+{
+	byte buf[256], *path;
+	int32 fd, hz, n;
+	bool ok;
+
+	for(;;) {
+		n = 0;
+		ok = false;
+		runtime·entersyscall();
+		fd = runtime·open(ctl.path, O_RDONLY, 0);
+		if(fd >= 0 && (ok = ours(fd)))
+			n = readline(fd, buf, sizeof buf);
+		runtime·exitsyscall();
+		if(fd == -EINTR)
+			continue;
+		if(fd < 0)
+			return;
+		if(!ok) {
+			runtime·printf("runtime: %s is not this user's FIFO; profiling control stopped\n", ctl.path);
+			runtime·close(fd);
+			return;
+		}
+
+		hz = runtime·atoi(buf);
+		path = runtime·mchr(buf, ' ', buf+n);
+		if(path != nil) {
+			runtime·entersyscall();
+			ctl.datafd = runtime·open(path+1, O_WRONLY, 0);
+			runtime·exitsyscall();
+			if(ctl.datafd >= 0) {
+				if(runtime·cpuprofstart(hz)) {
+					runtime·noteclear(&ctl.done);
+					runtime·newproc1((byte*)profwriter, nil, 0, 0, profctl);
+
+					// Profile until the profiler lets go of the control FIFO.
+					runtime·entersyscall();
+					while((n = runtime·read(fd, buf, sizeof buf)) > 0 || n == -EINTR)
+						;
+					runtime·exitsyscall();
+					runtime·SetCPUProfileRate(0);
+
+					runtime·entersyscall();
+					runtime·notesleep(&ctl.done);
+					runtime·exitsyscall();
+				}
+				runtime·close(ctl.datafd);
+			}
+		}
+		runtime·close(fd);
+	}
+}
+
+static void
+profwriter(void)
+{
+	runtime·cpuprofwrite(ctl.datafd);
+	runtime·notewakeup(&ctl.done);
+}
@@ -25,6 +25,10 @@ enum
 
 	EINTR = 4,
 	EAGAIN = 11,
+
+	O_WRONLY = 01,
+	O_CREAT = 0100,
+	O_APPEND = 02000,
 };
 
 // TODO(rsc): I tried using 1<<40 here but futex woke up (-ETIMEDOUT).
@@ -93,12 +97,16 @@ static void
 futexlock(Lock *l)
 {
 	uint32 v;
+	int64 t0;
 
+	t0 = 0;
 again:
 	v = l->key;
 	if((v&1) == 0){
 		if(runtime·cas(&l->key, v, v|1)){
 			// Lock wasn't held; we grabbed it.
+			if(t0 != 0)
+				runtime·blockevent(runtime·nanotime() - t0, 2);
 			return;
 		}
 		goto again;
@@ -117,6 +125,8 @@ again:
 	// We only really care that (v&1) == 1 (the lock is held),
 	// and in fact there is a futex variant that could
 	// accomodate that check, but let's not get carried away.)
+	if(t0 == 0 && runtime·BlockProfileRate > 0)
+		t0 = runtime·nanotime();
 	futexsleep(&l->key, v+2);
 
 	// We're awake: remove ourselves from the count.
@@ -303,3 +313,9 @@ runtime·sigpanic(void)
 	}
 	runtime·panicstring(runtime·sigtab[g->sig].name);
 }
+
+int32
+runtime·coveropen(byte *path)
+{
+	return runtime·open(path, O_WRONLY|O_CREAT|O_APPEND, 0644);
+}
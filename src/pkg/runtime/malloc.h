@@ -215,6 +215,8 @@ struct MStats
 	// Statistics about garbage collector.
 	// Protected by stopping the world during GC.
 	uint64	next_gc;	// next GC (in heap_alloc time)
+	uint64	last_gc;	// end of last GC, in nanoseconds since 1970
+	uint64	prev_gc;	// end of the GC before that
 	uint64	pause_total_ns;
 	uint64	pause_ns[256];
 	uint32	numgc;
@@ -390,6 +392,8 @@ enum
 
 void	runtime·MProf_Malloc(void*, uintptr);
 void	runtime·MProf_Free(void*, uintptr);
+void	runtime·MProf_Drain(void);
+void	runtime·MProf_GC(void);
 
 // Malloc profiling settings.
 // Must match definition in extern.go.
@@ -0,0 +1,113 @@
+// Copyright 2011 The Go Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+package runtime_test
+
+import (
+	"runtime"
+	"testing"
+	"unsafe"
+)
+
+var sink interface{}
+
+// Allocations of one size class, without pointers.
+func benchmarkMalloc(b *testing.B, size int) {
+	for i := 0; i < b.N; i++ {
+		sink = make([]byte, size)
+	}
+}
+
+func BenchmarkMalloc8(b *testing.B)    { benchmarkMalloc(b, 8) }
+func BenchmarkMalloc16(b *testing.B)   { benchmarkMalloc(b, 16) }
+func BenchmarkMalloc64(b *testing.B)   { benchmarkMalloc(b, 64) }
+func BenchmarkMalloc256(b *testing.B)  { benchmarkMalloc(b, 256) }
+func BenchmarkMalloc1K(b *testing.B)   { benchmarkMalloc(b, 1<<10) }
+func BenchmarkMalloc4K(b *testing.B)   { benchmarkMalloc(b, 4<<10) }
+func BenchmarkMalloc32K(b *testing.B)  { benchmarkMalloc(b, 32<<10) }
+func BenchmarkMalloc256K(b *testing.B) { benchmarkMalloc(b, 256<<10) }
+
+type ptrs [8]*int
+
+// Allocations that carry pointers, and so type information.
+func BenchmarkMallocTypeInfo(b *testing.B) {
+	for i := 0; i < b.N; i++ {
+		sink = new(ptrs)
+	}
+}
+
+// Small allocations from $GOMAXPROCS goroutines at once.
+func BenchmarkMallocParallel(b *testing.B) {
+	parallel(b, func(n int) {
+		var p *ptrs
+		for i := 0; i < n; i++ {
+			p = new(ptrs)
+		}
+		sink = p
+	})
+}
+
+// heap holds a live heap of about size bytes made of 64-byte
+// nodes; if ptr is set, each node points at the next, so the
+// collector must scan it.
+var heap []*node
+
+type node struct {
+	next *node
+	pad  [56]byte
+}
+
+type leaf struct {
+	pad [64]byte
+}
+
+var leaves [][]leaf
+
+func makeHeap(size int, ptr bool) {
+	heap = nil
+	leaves = nil
+	n := size / int(unsafe.Sizeof(node{}))
+	if ptr {
+		heap = make([]*node, 0, n)
+		var last *node
+		for i := 0; i < n; i++ {
+			x := &node{next: last}
+			heap = append(heap, x)
+			last = x
+		}
+	} else {
+		for n > 0 {
+			m := n
+			if m > 1024 {
+				m = 1024
+			}
+			leaves = append(leaves, make([]leaf, m))
+			n -= m
+		}
+	}
+	runtime.GC()
+}
+
+// Each op is one full collection with a live heap
+// of the given size; the collection stops the world,
+// so this is the pause time.
+func benchmarkGC(b *testing.B, size int, ptr bool) {
+	b.StopTimer()
+	makeHeap(size, ptr)
+	b.StartTimer()
+	for i := 0; i < b.N; i++ {
+		runtime.GC()
+	}
+	b.StopTimer()
+	heap = nil
+	leaves = nil
+	runtime.GC()
+}
+
+func BenchmarkGCPause1MB(b *testing.B)        { benchmarkGC(b, 1<<20, true) }
+func BenchmarkGCPause16MB(b *testing.B)       { benchmarkGC(b, 16<<20, true) }
+func BenchmarkGCPause64MB(b *testing.B)       { benchmarkGC(b, 64<<20, true) }
+func BenchmarkGCPauseNoscan1MB(b *testing.B)  { benchmarkGC(b, 1<<20, false) }
+func BenchmarkGCPauseNoscan16MB(b *testing.B) { benchmarkGC(b, 16<<20, false) }
+func BenchmarkGCPauseNoscan64MB(b *testing.B) { benchmarkGC(b, 64<<20, false) }
@@ -0,0 +1,113 @@
+// Copyright 2011 The Go Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+package runtime_test
+
+import (
+	"strconv"
+	"testing"
+)
+
+// mapSink keeps the lookups from being dead code.
+var mapSink int
+
+func benchmarkMapInt(b *testing.B, size int) {
+	b.StopTimer()
+	m := make(map[int]int, size)
+	for i := 0; i < size; i++ {
+		m[i*7] = i
+	}
+	b.StartTimer()
+	sum := 0
+	for i := 0; i < b.N; i++ {
+		sum += m[(i%size)*7]
+	}
+	mapSink = sum
+}
+
+func benchmarkMapString(b *testing.B, size int) {
+	b.StopTimer()
+	m := make(map[string]int, size)
+	keys := make([]string, size)
+	for i := range keys {
+		keys[i] = "key." + strconv.Itoa(i)
+		m[keys[i]] = i
+	}
+	b.StartTimer()
+	sum := 0
+	for i := 0; i < b.N; i++ {
+		sum += m[keys[i%size]]
+	}
+	mapSink = sum
+}
+
+// Interface keys hash through the dynamic type.
+func benchmarkMapIface(b *testing.B, size int) {
+	b.StopTimer()
+	m := make(map[interface{}]int, size)
+	keys := make([]interface{}, size)
+	for i := range keys {
+		keys[i] = i
+		m[keys[i]] = i
+	}
+	b.StartTimer()
+	sum := 0
+	for i := 0; i < b.N; i++ {
+		sum += m[keys[i%size]]
+	}
+	mapSink = sum
+}
+
+func benchmarkMapMiss(b *testing.B, size int) {
+	b.StopTimer()
+	m := make(map[int]int, size)
+	for i := 0; i < size; i++ {
+		m[i*7] = i
+	}
+	b.StartTimer()
+	for i := 0; i < b.N; i++ {
+		_, ok := m[(i%size)*7+1]
+		if ok {
+			panic("found missing key")
+		}
+	}
+}
+
+func benchmarkMapAssign(b *testing.B, size int) {
+	m := make(map[int]int)
+	for i := 0; i < b.N; i++ {
+		if i%size == 0 {
+			m = make(map[int]int)
+		}
+		m[i%size] = i
+	}
+}
+
+func BenchmarkMapInt8(b *testing.B)        { benchmarkMapInt(b, 8) }
+func BenchmarkMapInt1K(b *testing.B)       { benchmarkMapInt(b, 1<<10) }
+func BenchmarkMapInt1M(b *testing.B)       { benchmarkMapInt(b, 1<<20) }
+func BenchmarkMapString8(b *testing.B)     { benchmarkMapString(b, 8) }
+func BenchmarkMapString1K(b *testing.B)    { benchmarkMapString(b, 1<<10) }
+func BenchmarkMapString1M(b *testing.B)    { benchmarkMapString(b, 1<<20) }
+func BenchmarkMapIface8(b *testing.B)      { benchmarkMapIface(b, 8) }
+func BenchmarkMapIface1K(b *testing.B)     { benchmarkMapIface(b, 1<<10) }
+func BenchmarkMapMiss8(b *testing.B)       { benchmarkMapMiss(b, 8) }
+func BenchmarkMapMiss1K(b *testing.B)      { benchmarkMapMiss(b, 1<<10) }
+func BenchmarkMapAssignInt8(b *testing.B)  { benchmarkMapAssign(b, 8) }
+func BenchmarkMapAssignInt1K(b *testing.B) { benchmarkMapAssign(b, 1<<10) }
+
+// Concurrent readers of one map.
+func BenchmarkMapIntParallel(b *testing.B) {
+	m := make(map[int]int, 1<<10)
+	for i := 0; i < 1<<10; i++ {
+		m[i] = i
+	}
+	parallel(b, func(n int) {
+		sum := 0
+		for i := 0; i < n; i++ {
+			sum += m[i&(1<<10-1)]
+		}
+		mapSink = sum
+	})
+}
@@ -36,6 +36,8 @@ type MemStatsType struct {
 
 	// Garbage collector statistics.
 	NextGC       uint64
+	LastGC       uint64 // end of last GC, in nanoseconds since 1970
+	PrevGC       uint64 // end of the GC before that
 	PauseTotalNs uint64
 	PauseNs      [256]uint64 // most recent GC pause times
 	NumGC        uint32
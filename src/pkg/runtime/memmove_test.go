@@ -0,0 +1,136 @@
+// Copyright 2011 The Go Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+package runtime_test
+
+import "testing"
+
+func TestMemmove(t *testing.T) {
+	size := 256
+	if testing.Short() {
+		size = 128 + 16
+	}
+	src := make([]byte, size)
+	dst := make([]byte, size)
+	for i := 0; i < size; i++ {
+		src[i] = byte(128 + (i & 127))
+	}
+	for i := 0; i < size; i++ {
+		dst[i] = byte(i & 127)
+	}
+	for n := 0; n <= size; n++ {
+		for x := 0; x <= size-n; x++ { // offset in src
+			for y := 0; y <= size-n; y += 7 { // offset in dst
+				copy(dst[y:y+n], src[x:x+n])
+				for i := 0; i < y; i++ {
+					if dst[i] != byte(i&127) {
+						t.Fatalf("prefix dst[%d] = %d", i, dst[i])
+					}
+				}
+				for i := y; i < y+n; i++ {
+					if dst[i] != byte(128+((i-y+x)&127)) {
+						t.Fatalf("copied dst[%d] = %d", i, dst[i])
+					}
+					dst[i] = byte(i & 127) // reset dst
+				}
+				for i := y + n; i < size; i++ {
+					if dst[i] != byte(i&127) {
+						t.Fatalf("suffix dst[%d] = %d", i, dst[i])
+					}
+				}
+			}
+		}
+	}
+}
+
+func TestMemmoveOverlap(t *testing.T) {
+	size := 256
+	if testing.Short() {
+		size = 128 + 16
+	}
+	buf := make([]byte, size)
+	for n := 0; n <= size; n++ {
+		for x := 0; x <= size-n; x++ { // src offset
+			for y := 0; y <= size-n; y += 5 { // dst offset
+				for i := 0; i < size; i++ {
+					buf[i] = byte(i)
+				}
+				copy(buf[y:y+n], buf[x:x+n])
+				for i := 0; i < size; i++ {
+					want := byte(i)
+					if i >= y && i < y+n {
+						want = byte(i - y + x)
+					}
+					if buf[i] != want {
+						t.Fatalf("copy(buf[%d:%d], buf[%d:%d]): buf[%d] = %d, want %d",
+							y, y+n, x, x+n, i, buf[i], want)
+					}
+				}
+			}
+		}
+	}
+}
+
+func bmMemmove(b *testing.B, n, off int) {
+	b.StopTimer()
+	x := make([]byte, n+off)
+	y := make([]byte, n+off)
+	b.SetBytes(int64(n))
+	b.StartTimer()
+	for i := 0; i < b.N; i++ {
+		copy(x[off:], y[:n])
+	}
+}
+
+func BenchmarkMemmove0(b *testing.B)    { bmMemmove(b, 0, 0) }
+func BenchmarkMemmove1(b *testing.B)    { bmMemmove(b, 1, 0) }
+func BenchmarkMemmove2(b *testing.B)    { bmMemmove(b, 2, 0) }
+func BenchmarkMemmove3(b *testing.B)    { bmMemmove(b, 3, 0) }
+func BenchmarkMemmove4(b *testing.B)    { bmMemmove(b, 4, 0) }
+func BenchmarkMemmove5(b *testing.B)    { bmMemmove(b, 5, 0) }
+func BenchmarkMemmove6(b *testing.B)    { bmMemmove(b, 6, 0) }
+func BenchmarkMemmove7(b *testing.B)    { bmMemmove(b, 7, 0) }
+func BenchmarkMemmove8(b *testing.B)    { bmMemmove(b, 8, 0) }
+func BenchmarkMemmove9(b *testing.B)    { bmMemmove(b, 9, 0) }
+func BenchmarkMemmove10(b *testing.B)   { bmMemmove(b, 10, 0) }
+func BenchmarkMemmove11(b *testing.B)   { bmMemmove(b, 11, 0) }
+func BenchmarkMemmove12(b *testing.B)   { bmMemmove(b, 12, 0) }
+func BenchmarkMemmove13(b *testing.B)   { bmMemmove(b, 13, 0) }
+func BenchmarkMemmove14(b *testing.B)   { bmMemmove(b, 14, 0) }
+func BenchmarkMemmove15(b *testing.B)   { bmMemmove(b, 15, 0) }
+func BenchmarkMemmove16(b *testing.B)   { bmMemmove(b, 16, 0) }
+func BenchmarkMemmove32(b *testing.B)   { bmMemmove(b, 32, 0) }
+func BenchmarkMemmove64(b *testing.B)   { bmMemmove(b, 64, 0) }
+func BenchmarkMemmove128(b *testing.B)  { bmMemmove(b, 128, 0) }
+func BenchmarkMemmove256(b *testing.B)  { bmMemmove(b, 256, 0) }
+func BenchmarkMemmove512(b *testing.B)  { bmMemmove(b, 512, 0) }
+func BenchmarkMemmove1024(b *testing.B) { bmMemmove(b, 1024, 0) }
+func BenchmarkMemmove2048(b *testing.B) { bmMemmove(b, 2048, 0) }
+func BenchmarkMemmove4096(b *testing.B) { bmMemmove(b, 4096, 0) }
+
+func BenchmarkMemmoveUnaligned0(b *testing.B)    { bmMemmove(b, 0, 1) }
+func BenchmarkMemmoveUnaligned1(b *testing.B)    { bmMemmove(b, 1, 1) }
+func BenchmarkMemmoveUnaligned2(b *testing.B)    { bmMemmove(b, 2, 1) }
+func BenchmarkMemmoveUnaligned3(b *testing.B)    { bmMemmove(b, 3, 1) }
+func BenchmarkMemmoveUnaligned4(b *testing.B)    { bmMemmove(b, 4, 1) }
+func BenchmarkMemmoveUnaligned5(b *testing.B)    { bmMemmove(b, 5, 1) }
+func BenchmarkMemmoveUnaligned6(b *testing.B)    { bmMemmove(b, 6, 1) }
+func BenchmarkMemmoveUnaligned7(b *testing.B)    { bmMemmove(b, 7, 1) }
+func BenchmarkMemmoveUnaligned8(b *testing.B)    { bmMemmove(b, 8, 1) }
+func BenchmarkMemmoveUnaligned9(b *testing.B)    { bmMemmove(b, 9, 1) }
+func BenchmarkMemmoveUnaligned10(b *testing.B)   { bmMemmove(b, 10, 1) }
+func BenchmarkMemmoveUnaligned11(b *testing.B)   { bmMemmove(b, 11, 1) }
+func BenchmarkMemmoveUnaligned12(b *testing.B)   { bmMemmove(b, 12, 1) }
+func BenchmarkMemmoveUnaligned13(b *testing.B)   { bmMemmove(b, 13, 1) }
+func BenchmarkMemmoveUnaligned14(b *testing.B)   { bmMemmove(b, 14, 1) }
+func BenchmarkMemmoveUnaligned15(b *testing.B)   { bmMemmove(b, 15, 1) }
+func BenchmarkMemmoveUnaligned16(b *testing.B)   { bmMemmove(b, 16, 1) }
+func BenchmarkMemmoveUnaligned32(b *testing.B)   { bmMemmove(b, 32, 1) }
+func BenchmarkMemmoveUnaligned64(b *testing.B)   { bmMemmove(b, 64, 1) }
+func BenchmarkMemmoveUnaligned128(b *testing.B)  { bmMemmove(b, 128, 1) }
+func BenchmarkMemmoveUnaligned256(b *testing.B)  { bmMemmove(b, 256, 1) }
+func BenchmarkMemmoveUnaligned512(b *testing.B)  { bmMemmove(b, 512, 1) }
+func BenchmarkMemmoveUnaligned1024(b *testing.B) { bmMemmove(b, 1024, 1) }
+func BenchmarkMemmoveUnaligned2048(b *testing.B) { bmMemmove(b, 2048, 1) }
+func BenchmarkMemmoveUnaligned4096(b *testing.B) { bmMemmove(b, 4096, 1) }
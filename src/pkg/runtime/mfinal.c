@@ -5,10 +5,15 @@
 #include "runtime.h"
 #include "malloc.h"
 
-// Lock to protect finalizer data structures.
-// Cannot reuse mheap.Lock because the finalizer
-// maintenance requires allocation.
-static Lock finlock;
+// The finalizer table is split into shards by address, so that
+// goroutines adding finalizers to objects in different pages do not
+// contend for a lock.  Each shard has its own lock, which cannot be
+// mheap.Lock because the finalizer maintenance requires allocation.
+enum
+{
+	FinShards = 64,	// power of two
+	EvacuateStep = 8,	// slots of the old table moved per insertion
+};
 
 // Finalizer hash table.  Direct hash, linear scan, at most 3/4 full.
 // Table size is power of 3 so that hash can be key % max.
@@ -27,6 +32,27 @@ struct Fintab
 	int32 max;	// size of key, val allocations
 };
 
+// A shard grows incrementally: when its table fills, a new one
+// is allocated and the entries of the old one are moved a few at
+// a time by later insertions.  Until then lookups check both.
+typedef struct Finshard Finshard;
+struct Finshard
+{
+	Lock;
+	Fintab cur;
+	Fintab old;
+	int32 evac;	// next slot of old to move to cur
+	byte pad[64];	// keep shards' locks in separate cache lines
+};
+
+static Finshard finshard[FinShards];
+
+static Finshard*
+shardof(void *p)
+{
+	return &finshard[((uintptr)p >> PageShift) & (FinShards-1)];
+}
+
 static void
 addfintab(Fintab *t, void *k, Finalizer *v)
 {
@@ -84,14 +110,79 @@ lookfintab(Fintab *t, void *k, bool del)
 	return nil;
 }
 
-static Fintab fintab;
+static Finalizer*
+lookshard(Finshard *s, void *k, bool del)
+{
+	Finalizer *v;
+
+	v = lookfintab(&s->cur, k, del);
+	if(v == nil)
+		v = lookfintab(&s->old, k, del);
+	return v;
+}
+
+// Move up to n slots of s's old table to its current one.
+// Shard must be locked.
+static void
+evacuate(Finshard *s, int32 n)
+{
+	void *k;
+
+	for(; n > 0 && s->evac < s->old.max; n--, s->evac++) {
+		k = s->old.key[s->evac];
+		if(k != nil && k != (void*)-1) {
+			addfintab(&s->cur, k, s->old.val[s->evac]);
+			// Mark dead rather than free, to keep
+			// the probe sequences of later slots intact.
+			s->old.key[s->evac] = (void*)-1;
+			s->old.val[s->evac] = nil;
+		}
+	}
+	if(s->old.max != 0 && s->evac == s->old.max) {
+		runtime·free(s->old.key);
+		runtime·free(s->old.val);
+		runtime·memclr((byte*)&s->old, sizeof s->old);
+		s->evac = 0;
+	}
+}
+
+// Start moving s's table to a new one, if it is too full.
+// Shard must be locked.
+static void
+growshard(Finshard *s)
+{
+	Fintab *t;
+	int32 max;
+
+	t = &s->cur;
+	if(t->nkey < t->max/2+t->max/4)
+		return;
+
+	// keep table at most 3/4 full.
+	// the previous move must be finished first.
+	evacuate(s, s->old.max);
+
+	max = t->max;
+	if(max == 0)
+		max = 3*3*3;
+	else if(t->ndead < t->nkey/2) {
+		// grow table if not many dead values.
+		// otherwise just rehash into table of same size.
+		max *= 3;
+	}
+	s->old = *t;
+	s->evac = 0;
+	runtime·memclr((byte*)t, sizeof *t);
+	t->max = max;
+	t->key = runtime·mallocgc(max*sizeof t->key[0], FlagNoPointers, 0, 1);
+	t->val = runtime·mallocgc(max*sizeof t->val[0], 0, 0, 1);
+}
 
 // add finalizer; caller is responsible for making sure not already in table
 void
 runtime·addfinalizer(void *p, void (*f)(void*), int32 nret)
 {
-	Fintab newtab;
-	int32 i;
+	Finshard *s;
 	byte *base;
 	Finalizer *e;
 	
@@ -102,54 +193,28 @@ runtime·addfinalizer(void *p, void (*f)(void*), int32 nret)
 		e->nret = nret;
 	}
 
-	runtime·lock(&finlock);
+	s = shardof(p);
+	runtime·lock(s);
 	if(!runtime·mlookup(p, &base, nil, nil) || p != base) {
-		runtime·unlock(&finlock);
+		runtime·unlock(s);
 		runtime·throw("addfinalizer on invalid pointer");
 	}
 	if(f == nil) {
-		lookfintab(&fintab, p, 1);
-		runtime·unlock(&finlock);
+		lookshard(s, p, 1);
+		runtime·unlock(s);
 		return;
 	}
 
-	if(lookfintab(&fintab, p, 0)) {
-		runtime·unlock(&finlock);
+	if(lookshard(s, p, 0)) {
+		runtime·unlock(s);
 		runtime·throw("double finalizer");
 	}
 	runtime·setblockspecial(p);
 
-	if(fintab.nkey >= fintab.max/2+fintab.max/4) {
-		// keep table at most 3/4 full:
-		// allocate new table and rehash.
-
-		runtime·memclr((byte*)&newtab, sizeof newtab);
-		newtab.max = fintab.max;
-		if(newtab.max == 0)
-			newtab.max = 3*3*3;
-		else if(fintab.ndead < fintab.nkey/2) {
-			// grow table if not many dead values.
-			// otherwise just rehash into table of same size.
-			newtab.max *= 3;
-		}
-
-		newtab.key = runtime·mallocgc(newtab.max*sizeof newtab.key[0], FlagNoPointers, 0, 1);
-		newtab.val = runtime·mallocgc(newtab.max*sizeof newtab.val[0], 0, 0, 1);
-
-		for(i=0; i<fintab.max; i++) {
-			void *k;
-
-			k = fintab.key[i];
-			if(k != nil && k != (void*)-1)
-				addfintab(&newtab, k, fintab.val[i]);
-		}
-		runtime·free(fintab.key);
-		runtime·free(fintab.val);
-		fintab = newtab;
-	}
-
-	addfintab(&fintab, p, e);
-	runtime·unlock(&finlock);
+	evacuate(s, EvacuateStep);
+	growshard(s);
+	addfintab(&s->cur, p, e);
+	runtime·unlock(s);
 }
 
 // get finalizer; if del, delete finalizer.
@@ -157,25 +222,38 @@ runtime·addfinalizer(void *p, void (*f)(void*), int32 nret)
 Finalizer*
 runtime·getfinalizer(void *p, bool del)
 {
+	Finshard *s;
 	Finalizer *f;
 	
-	runtime·lock(&finlock);
-	f = lookfintab(&fintab, p, del);
-	runtime·unlock(&finlock);
+	s = shardof(p);
+	runtime·lock(s);
+	f = lookshard(s, p, del);
+	runtime·unlock(s);
 	return f;
 }
 
-void
-runtime·walkfintab(void (*fn)(void*))
+static void
+walk(Fintab *t, void (*fn)(void*))
 {
 	void **key;
 	void **ekey;
 
-	runtime·lock(&finlock);
-	key = fintab.key;
-	ekey = key + fintab.max;
+	key = t->key;
+	ekey = key + t->max;
 	for(; key < ekey; key++)
 		if(*key != nil && *key != ((void*)-1))
 			fn(*key);
-	runtime·unlock(&finlock);
+}
+
+void
+runtime·walkfintab(void (*fn)(void*))
+{
+	Finshard *s;
+
+	for(s=finshard; s<finshard+FinShards; s++) {
+		runtime·lock(s);
+		walk(&s->cur, fn);
+		walk(&s->old, fn);
+		runtime·unlock(s);
+	}
 }
@@ -0,0 +1,72 @@
+// Copyright 2011 The Go Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+package runtime_test
+
+import (
+	"runtime"
+	"sync"
+	"testing"
+	"time"
+)
+
+type finObj struct {
+	n int
+	_ [8]byte
+}
+
+// setFinalizers sets a finalizer on each of n new objects,
+// from each of procs goroutines.  The finalizers count into
+// *count under mu.
+func setFinalizers(procs, n int, mu *sync.Mutex, count *int) {
+	var wg sync.WaitGroup
+	wg.Add(procs)
+	for p := 0; p < procs; p++ {
+		go func() {
+			for i := 0; i < n; i++ {
+				runtime.SetFinalizer(&finObj{n: i}, func(*finObj) {
+					mu.Lock()
+					*count++
+					mu.Unlock()
+				})
+			}
+			wg.Done()
+		}()
+	}
+	wg.Wait()
+}
+
+func TestFinalizerMany(t *testing.T) {
+	const procs, n = 4, 20000
+	defer runtime.GOMAXPROCS(runtime.GOMAXPROCS(procs))
+	var mu sync.Mutex
+	count := 0
+	setFinalizers(procs, n, &mu, &count)
+	for i := 0; i < 100; i++ {
+		runtime.GC()
+		time.Sleep(10e6)
+		mu.Lock()
+		c := count
+		mu.Unlock()
+		// The collector is conservative, so a few
+		// objects may look reachable indefinitely.
+		if c >= procs*n*95/100 {
+			return
+		}
+	}
+	t.Errorf("only %d of %d finalizers ran", count, procs*n)
+}
+
+func BenchmarkSetFinalizer(b *testing.B) {
+	var mu sync.Mutex
+	count := 0
+	setFinalizers(1, b.N, &mu, &count)
+}
+
+func BenchmarkSetFinalizer4(b *testing.B) {
+	defer runtime.GOMAXPROCS(runtime.GOMAXPROCS(4))
+	var mu sync.Mutex
+	count := 0
+	setFinalizers(4, b.N/4, &mu, &count)
+}
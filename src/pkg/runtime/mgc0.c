@@ -68,11 +68,24 @@ extern byte data[];
 extern byte etext[];
 extern byte end[];
 
-static G *fing;
+// Queued finalizers are run by a pool of at most MaxFing goroutines,
+// each taking up to FinBatch finalizers at a time.  The garbage
+// collector queues finalizers and wakes the goroutines with the
+// world stopped; the goroutines share the queue under finlock.
+enum {
+	MaxFing = 8,
+	FinBatch = 64,
+};
+static Lock finlock;
 static Finalizer *finq;
-static int32 fingwait;
+static int32 nfinq;	// length of finq
+static int32 nfing;	// finalizer goroutines started
+static G *fingwait[MaxFing];	// finalizer goroutines waiting for work
+static int32 nfingwait;
+static int32 nfingrun;	// finalizer goroutines running finalizers
 
 static void runfinq(void);
+static void wakefing(void);
 static Workbuf* getempty(Workbuf*);
 static Workbuf* getfull(Workbuf*);
 
@@ -476,6 +489,7 @@ sweep(void)
 					f->arg = p;
 					f->next = finq;
 					finq = f;
+					nfinq++;
 					continue;
 				}
 				runtime·MProf_Free(p, size);
@@ -591,8 +605,13 @@ runtime·gc(int32 force)
 
 	m->gcing = 1;
 	runtime·stoptheworld();
+	if(runtime·tracing)
+		runtime·tracegc(TraceEvGCStart, 0);
 	if(runtime·mheap.Lock.key != 0)
 		runtime·throw("runtime·mheap locked during gc");
+	m->locks++;	// the drain mallocs buckets; do not yield to the stopped world
+	runtime·MProf_Drain();
+	m->locks--;
 
 	cachestats();
 	heap0 = mstats.heap_alloc;
@@ -603,21 +622,15 @@ runtime·gc(int32 force)
 	sweep();
 	t2 = runtime·nanotime();
 	stealcache();
+	runtime·MProf_GC();
 
 	mstats.next_gc = mstats.heap_alloc+mstats.heap_alloc*gcpercent/100;
 	m->gcing = 0;
 
 	m->locks++;	// disable gc during the mallocs in newproc
 	fp = finq;
-	if(fp != nil) {
-		// kick off or wake up goroutine to run queued finalizers
-		if(fing == nil)
-			fing = runtime·newproc1((byte*)runfinq, nil, 0, 0, runtime·gc);
-		else if(fingwait) {
-			fingwait = 0;
-			runtime·ready(fing);
-		}
-	}
+	if(fp != nil)
+		wakefing();
 	m->locks--;
 
 	cachestats();
@@ -627,6 +640,8 @@ runtime·gc(int32 force)
 	t3 = runtime·nanotime();
 	mstats.pause_ns[mstats.numgc%nelem(mstats.pause_ns)] = t3 - t0;
 	mstats.pause_total_ns += t3 - t0;
+	mstats.prev_gc = mstats.last_gc;
+	mstats.last_gc = t3;
 	mstats.numgc++;
 	if(mstats.debuggc)
 		runtime·printf("pause %D\n", t3-t0);
@@ -639,6 +654,8 @@ runtime·gc(int32 force)
 			nlookup, nsizelookup, naddrlookup);
 	}
 
+	if(runtime·tracing)
+		runtime·tracegc(TraceEvGCDone, heap1);
 	runtime·semrelease(&gcsema);
 	runtime·starttheworld();
 	
@@ -650,27 +667,56 @@ runtime·gc(int32 force)
 		runtime·gc(1);
 }
 
+// Wake or start one finalizer goroutine per FinBatch
+// queued finalizers, up to MaxFing.  The world is stopped.
+static void
+wakefing(void)
+{
+	int32 n;
+
+	n = (nfinq + FinBatch - 1) / FinBatch;
+	for(; n > 0 && nfingwait > 0; n--)
+		runtime·ready(fingwait[--nfingwait]);
+	for(; n > 0 && nfing < MaxFing; n--) {
+		nfing++;
+		runtime·newproc1((byte*)runfinq, nil, 0, 0, runtime·gc);
+	}
+}
+
 static void
 runfinq(void)
 {
-	Finalizer *f, *next;
+	Finalizer *f, *next, **l;
 	byte *frame;
+	int32 i;
+	bool last;
 
 	for(;;) {
-		// There's no need for a lock in this section
-		// because it only conflicts with the garbage
-		// collector, and the garbage collector only
-		// runs when everyone else is stopped, and
-		// runfinq only stops at the gosched() or
-		// during the calls in the for loop.
+		// The garbage collector only adds to finq and reads
+		// fingwait while the world is stopped, and runfinq
+		// holds finlock only between scheduling points, so
+		// the lock is needed only against other runfinqs.
+		runtime·lock(&finlock);
 		f = finq;
-		finq = nil;
 		if(f == nil) {
-			fingwait = 1;
+			fingwait[nfingwait++] = g;
 			g->status = Gwaiting;
+			runtime·unlock(&finlock);
+			if(runtime·tracing)
+				runtime·tracegostk(TraceEvGoBlock, g, TraceBlockFinalizer);
 			runtime·gosched();
 			continue;
 		}
+		// Take a batch off the front of the queue.
+		l = &finq;
+		for(i=0; i<FinBatch && *l != nil; i++)
+			l = &(*l)->next;
+		finq = *l;
+		*l = nil;
+		nfinq -= i;
+		nfingrun++;
+		runtime·unlock(&finlock);
+
 		for(; f; f=next) {
 			next = f->next;
 			frame = runtime·mal(sizeof(uintptr) + f->nret);
@@ -682,7 +728,12 @@ runfinq(void)
 			f->next = nil;
 			runtime·free(f);
 		}
-		runtime·gc(1);	// trigger another gc to clean up the finalized objects, if possible
+
+		runtime·lock(&finlock);
+		last = --nfingrun == 0 && finq == nil;
+		runtime·unlock(&finlock);
+		if(last)
+			runtime·gc(1);	// trigger another gc to clean up the finalized objects, if possible
 	}
 }
 
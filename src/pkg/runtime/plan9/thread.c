@@ -64,6 +64,8 @@ runtime·newosproc(M *m, G *g, void *stk, void (*fn)(void))
 void
 runtime·lock(Lock *l)
 {
+	int64 t0;
+
 	if(m->locks < 0)
 		runtime·throw("lock count");
 	m->locks++;
@@ -71,9 +73,14 @@ runtime·lock(Lock *l)
 	if(runtime·xadd(&l->key, 1) == 1)
 		return; // changed from 0 -> 1; we hold lock
 	// otherwise wait in kernel
+	t0 = 0;
+	if(runtime·BlockProfileRate > 0)
+		t0 = runtime·nanotime();
 	while(runtime·plan9_semacquire(&l->sema, 1) < 0) {
 		/* interrupted; try again */
 	}
+	if(t0 != 0)
+		runtime·blockevent(runtime·nanotime() - t0, 1);
 }
 
 void
@@ -143,3 +150,32 @@ os·sigpipe(void)
 {
 	runtime·throw("too many writes on closed pipe");
 }
+
+// The profiling control channel for prof -i (see linux/profctl.c)
+// exists only on Linux.  Say so rather than ignore $GOPROFCTL.
+void
+runtime·profctlinit(void)
+{
+	byte *p;
+
+	p = runtime·getenv("GOPROFCTL");
+	if(p != nil && *p != 0)
+		runtime·printf("runtime: GOPROFCTL is set, but prof -i is not supported on Plan 9\n");
+}
+
+void
+runtime·profctlexit(void)
+{
+}
+
+// Coverage output (see cover.c) is written only on Linux.
+// A program built with -C and run with $GOCOVER set
+// must not appear to succeed without writing the counts.
+int32
+runtime·coveropen(byte *path)
+{
+	USED(path);
+	runtime·printf("runtime: GOCOVER is set, but coverage output is not supported on Plan 9\n");
+	runtime·exit(2);
+	return -1;
+}
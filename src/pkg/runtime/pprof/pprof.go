@@ -21,20 +21,33 @@ import (
 // If a write to w returns an error, WriteHeapProfile returns that error.
 // Otherwise, WriteHeapProfile returns nil.
 func WriteHeapProfile(w io.Writer) os.Error {
-	// Find out how many records there are (MemProfile(nil, false)),
+	return writeHeapProfile(w, runtime.MemProfile)
+}
+
+// WriteHeapProfileAtGC is like WriteHeapProfile, but the in-use figures
+// describe the heap as of the end of the most recent garbage collection,
+// which are consistent with that collection.  Comments at the end of
+// the profile list the allocation rate of each call sequence during
+// the last complete GC cycle.
+func WriteHeapProfileAtGC(w io.Writer) os.Error {
+	return writeHeapProfile(w, runtime.MemProfileAtGC)
+}
+
+func writeHeapProfile(w io.Writer, memProfile func([]runtime.MemProfileRecord, bool) (int, bool)) os.Error {
+	// Find out how many records there are (memProfile(nil, false)),
 	// allocate that many records, and get the data.
 	// There's a race—more records might be added between
 	// the two calls—so allocate a few extra records for safety
 	// and also try again if we're very unlucky.
 	// The loop should only execute one iteration in the common case.
 	var p []runtime.MemProfileRecord
-	n, ok := runtime.MemProfile(nil, false)
+	n, ok := memProfile(nil, false)
 	for {
 		// Allocate room for a slightly bigger profile,
 		// in case a few more entries have been added
-		// since the call to MemProfile.
+		// since the call to memProfile.
 		p = make([]runtime.MemProfileRecord, n+50)
-		n, ok = runtime.MemProfile(p, false)
+		n, ok = memProfile(p, false)
 		if ok {
 			p = p[0:n]
 			break
@@ -92,6 +105,7 @@ func WriteHeapProfile(w io.Writer) os.Error {
 	fmt.Fprintf(b, "# BuckHashSys = %d\n", s.BuckHashSys)
 
 	fmt.Fprintf(b, "# NextGC = %d\n", s.NextGC)
+	fmt.Fprintf(b, "# LastGC = %d\n", s.LastGC)
 	fmt.Fprintf(b, "# PauseNs = %d\n", s.PauseNs)
 	fmt.Fprintf(b, "# NumGC = %d\n", s.NumGC)
 	fmt.Fprintf(b, "# EnableGC = %v\n", s.EnableGC)
@@ -104,6 +118,60 @@ func WriteHeapProfile(w io.Writer) os.Error {
 			fmt.Fprintf(b, "#   %d * (%d = %d - %d)\n", t.Size, t.Mallocs-t.Frees, t.Mallocs, t.Frees)
 		}
 	}
+
+	if cycle := float64(s.LastGC - s.PrevGC); s.PrevGC != 0 && cycle > 0 {
+		fmt.Fprintf(b, "\n# Allocation rate during the last GC cycle (%.3fs),\n", cycle/1e9)
+		fmt.Fprintf(b, "# sampled like the counts above\n")
+		fmt.Fprintf(b, "# objects/s: bytes/s @ stack\n")
+		for i := range p {
+			r := &p[i]
+			if r.RecentAllocBytes == 0 {
+				continue
+			}
+			fmt.Fprintf(b, "# %.0f: %.0f @",
+				float64(r.RecentAllocObjects)*1e9/cycle,
+				float64(r.RecentAllocBytes)*1e9/cycle)
+			for _, pc := range r.Stack() {
+				fmt.Fprintf(b, " %#x", pc)
+			}
+			fmt.Fprintf(b, "\n")
+		}
+	}
+	return b.Flush()
+}
+
+// WriteBlockProfile writes a pprof-formatted contention profile to w,
+// describing where goroutines blocked and for how long.
+// Blocking events are recorded only while runtime.BlockProfileRate > 0.
+// If a write to w returns an error, WriteBlockProfile returns that error.
+// Otherwise, WriteBlockProfile returns nil.
+func WriteBlockProfile(w io.Writer) os.Error {
+	// See writeHeapProfile for why this loops.
+	var p []runtime.BlockProfileRecord
+	n, ok := runtime.BlockProfile(nil)
+	for {
+		p = make([]runtime.BlockProfileRecord, n+50)
+		n, ok = runtime.BlockProfile(p)
+		if ok {
+			p = p[0:n]
+			break
+		}
+	}
+
+	// The pprof contention format counts time in cycles;
+	// the runtime records nanoseconds.
+	b := bufio.NewWriter(w)
+	fmt.Fprintf(b, "--- contention:\n")
+	fmt.Fprintf(b, "cycles/second=%d\n", 1000000000)
+	fmt.Fprintf(b, "sampling period=%d\n", runtime.BlockProfileRate)
+	for i := range p {
+		r := &p[i]
+		fmt.Fprintf(b, "%d %d @", r.Nanoseconds, r.Count)
+		for _, pc := range r.Stack() {
+			fmt.Fprintf(b, " %#x", pc)
+		}
+		fmt.Fprintf(b, "\n")
+	}
 	return b.Flush()
 }
 
@@ -160,6 +228,71 @@ func profileWriter(w io.Writer) {
 	cpu.done <- true
 }
 
+// Profiling labels are recorded by the runtime as an extra, outermost
+// stack frame.  The frame's value is a small number that cannot be a
+// program counter.  Pprof subtracts one from caller pcs before looking
+// them up, so each label owns two consecutive values.
+const (
+	labelBase = 0x1000
+	maxLabels = (0x10000 - labelBase) / 2
+)
+
+var labels struct {
+	sync.Mutex
+	id   map[string]uintptr
+	name []string
+}
+
+// SetLabel sets the profiling label of the calling goroutine to label,
+// such as "handler=search".  Goroutines inherit the label of the goroutine
+// that starts them.  CPU profile samples taken while a labeled goroutine
+// is running have an extra frame at the base of the stack, which
+// LabelForPC (and so the pprof symbol server in package http/pprof)
+// resolves to the label.  An empty label clears the label.
+// Only a few thousand distinct labels can be used; once they are
+// exhausted, SetLabel clears the label instead.
+func SetLabel(label string) {
+	var pc uintptr
+	if label != "" {
+		labels.Lock()
+		if labels.id == nil {
+			labels.id = make(map[string]uintptr)
+		}
+		id, ok := labels.id[label]
+		if !ok && len(labels.name) < maxLabels {
+			labels.name = append(labels.name, label)
+			id = uintptr(len(labels.name))
+			labels.id[label] = id
+		}
+		labels.Unlock()
+		if id != 0 {
+			pc = labelBase + 2*id
+		}
+	}
+	runtime.SetCPUProfileLabel(pc)
+}
+
+// Label returns the profiling label of the calling goroutine.
+func Label() string {
+	label, _ := LabelForPC(runtime.CPUProfileLabel())
+	return label
+}
+
+// LabelForPC reports whether pc, a frame in a CPU profile,
+// is a label frame, and if so returns the label.
+func LabelForPC(pc uintptr) (label string, ok bool) {
+	if pc <= labelBase || pc > labelBase+2*maxLabels {
+		return "", false
+	}
+	id := int(pc-labelBase+1) / 2
+	labels.Lock()
+	defer labels.Unlock()
+	if id > len(labels.name) {
+		return "", false
+	}
+	return labels.name[id-1], true
+}
+
 // StopCPUProfile stops the current CPU profile, if any.
 // StopCPUProfile only returns after all the writes for the
 // profile have completed.
@@ -174,3 +307,51 @@ func StopCPUProfile() {
 	runtime.SetCPUProfileRate(0)
 	<-cpu.done
 }
+
+var trace struct {
+	sync.Mutex
+	tracing bool
+	done    chan bool
+}
+
+// StartTrace enables execution tracing for the current process.
+// While tracing, the trace will be buffered and written to w.
+// StartTrace returns an error if tracing is already enabled.
+// The gotrace command summarizes traces.
+func StartTrace(w io.Writer) os.Error {
+	trace.Lock()
+	defer trace.Unlock()
+	if trace.done == nil {
+		trace.done = make(chan bool)
+	}
+	if trace.tracing || !runtime.StartTrace() {
+		return fmt.Errorf("execution tracing already in use")
+	}
+	trace.tracing = true
+	go func() {
+		for {
+			data := runtime.ReadTrace()
+			if data == nil {
+				break
+			}
+			w.Write(data)
+		}
+		trace.done <- true
+	}()
+	return nil
+}
+
+// StopTrace stops the current trace, if any.
+// StopTrace only returns after all the writes for the
+// trace have completed.
+func StopTrace() {
+	trace.Lock()
+	defer trace.Unlock()
+
+	if !trace.tracing {
+		return
+	}
+	trace.tracing = false
+	runtime.StopTrace()
+	<-trace.done
+}
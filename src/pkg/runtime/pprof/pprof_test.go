@@ -6,15 +6,67 @@ package pprof_test
 
 import (
 	"bytes"
+	"fmt"
 	"hash/crc32"
 	"runtime"
 	. "runtime/pprof"
+	"strconv"
 	"strings"
+	"sync"
 	"testing"
+	"time"
 	"unsafe"
 )
 
 func TestCPUProfile(t *testing.T) {
+	found := false
+	testCPUProfile(t, func(stk []uintptr) {
+		for _, pc := range stk {
+			f := runtime.FuncForPC(pc)
+			if f == nil {
+				continue
+			}
+			if strings.Contains(f.Name(), "ChecksumIEEE") {
+				found = true
+			}
+		}
+	})
+	if !found {
+		t.Fatal("did not find ChecksumIEEE in the profile")
+	}
+}
+
+func TestCPUProfileLabel(t *testing.T) {
+	SetLabel("test=label")
+	defer SetLabel("")
+	if l := Label(); l != "test=label" {
+		t.Fatalf("Label() = %q, want %q", l, "test=label")
+	}
+	runtime.SetCPUProfileDepth(4)
+	defer runtime.SetCPUProfileDepth(64)
+
+	found := false
+	testCPUProfile(t, func(stk []uintptr) {
+		if len(stk) > 4+1 {
+			t.Errorf("stack depth %d exceeds 4+1", len(stk))
+		}
+		if l, ok := LabelForPC(stk[len(stk)-1]); ok && l == "test=label" {
+			found = true
+		}
+		for _, pc := range stk[:len(stk)-1] {
+			if _, ok := LabelForPC(pc); ok {
+				t.Errorf("label frame %#x is not outermost", pc)
+			}
+		}
+	})
+	if !found {
+		t.Fatal("did not find label in the profile")
+	}
+}
+
+// testCPUProfile profiles some checksumming in a new goroutine,
+// checks the profile's format, and calls f with each stack in it.
+func testCPUProfile(t *testing.T, f func([]uintptr)) {
 	switch runtime.GOOS {
 	case "darwin":
 		// see Apple Bug Report #9177434 (copied into change description)
@@ -35,9 +87,14 @@ func TestCPUProfile(t *testing.T) {
 	// This loop takes about a quarter second on a 2 GHz laptop.
 	// We only need to get one 100 Hz clock tick, so we've got
 	// a 25x safety buffer.
-	for i := 0; i < 1000; i++ {
-		crc32.ChecksumIEEE(buf)
-	}
+	done := make(chan bool)
+	go func() {
+		for i := 0; i < 1000; i++ {
+			crc32.ChecksumIEEE(buf)
+		}
+		done <- true
+	}()
+	<-done
 	StopCPUProfile()
 
 	// Convert []byte to []uintptr.
@@ -52,26 +109,230 @@ func TestCPUProfile(t *testing.T) {
 		t.Fatalf("unexpected header %#x", val[:5])
 	}
 
-	// Check that profile is well formed and contains ChecksumIEEE.
-	found := false
+	// Check that profile is well formed.
 	val = val[5:]
 	for len(val) > 0 {
 		if len(val) < 2 || val[0] < 1 || val[1] < 1 || uintptr(len(val)) < 2+val[1] {
 			t.Fatalf("malformed profile.  leftover: %#x", val)
 		}
-		for _, pc := range val[2 : 2+val[1]] {
-			f := runtime.FuncForPC(pc)
-			if f == nil {
-				continue
+		f(val[2 : 2+val[1]])
+		val = val[2+val[1]:]
+	}
+}
+
+var heapSink [][]byte
+
+func TestHeapProfileAtGC(t *testing.T) {
+	old := runtime.MemProfileRate
+	runtime.MemProfileRate = 1
+	defer func() { runtime.MemProfileRate = old }()
+
+	runtime.GC()
+	heapSink = nil
+	for i := 0; i < 100; i++ {
+		heapSink = append(heapSink, make([]byte, 1000))
+	}
+	runtime.GC()
+
+	p := make([]runtime.MemProfileRecord, 1000)
+	n, ok := runtime.MemProfileAtGC(p, true)
+	if !ok {
+		t.Fatalf("MemProfileAtGC needs %d records", n)
+	}
+	var recent int64
+	for _, r := range p[:n] {
+		if r.RecentAllocBytes < 0 || r.RecentAllocObjects < 0 {
+			t.Fatalf("negative recent allocation: %+v", r)
+		}
+		recent += r.RecentAllocBytes
+	}
+	if recent < 100*1000 {
+		t.Errorf("recent allocation %d bytes, want at least %d", recent, 100*1000)
+	}
+
+	var buf bytes.Buffer
+	if err := WriteHeapProfileAtGC(&buf); err != nil {
+		t.Fatal(err)
+	}
+	if !bytes.HasPrefix(buf.Bytes(), []byte("heap profile: ")) {
+		t.Fatalf("bad heap profile header %q", buf.Bytes()[:20])
+	}
+}
+
+func TestBlockProfile(t *testing.T) {
+	old := runtime.BlockProfileRate
+	runtime.BlockProfileRate = 1
+	defer func() { runtime.BlockProfileRate = old }()
+
+	c := make(chan bool)
+	go func() {
+		time.Sleep(20e6)
+		c <- true
+	}()
+	<-c
+
+	var mu sync.Mutex
+	mu.Lock()
+	go func() {
+		time.Sleep(20e6)
+		mu.Unlock()
+	}()
+	mu.Lock()
+
+	var prof bytes.Buffer
+	if err := WriteBlockProfile(&prof); err != nil {
+		t.Fatal(err)
+	}
+	lines := strings.Split(prof.String(), "\n", -1)
+	if len(lines) < 3 || lines[0] != "--- contention:" || lines[1] != "cycles/second=1000000000" {
+		t.Fatalf("bad contention profile header:\n%s", prof.String())
+	}
+	found := make(map[string]bool)
+	for _, l := range lines[3:] {
+		if l == "" {
+			continue
+		}
+		var ns, count int64
+		if n, _ := fmt.Sscanf(l, "%d %d @", &ns, &count); n != 2 || count < 1 || ns < 1 {
+			t.Fatalf("bad contention profile line %q", l)
+		}
+		if ns < 10e6 {
+			continue
+		}
+		for _, f := range strings.Fields(l[strings.Index(l, "@")+1:]) {
+			pc, err := strconv.Btoui64(f, 0)
+			if err != nil {
+				t.Fatalf("bad pc in %q", l)
 			}
-			if strings.Contains(f.Name(), "ChecksumIEEE") {
-				found = true
+			if fn := runtime.FuncForPC(uintptr(pc)); fn != nil {
+				found[fn.Name()] = true
 			}
 		}
-		val = val[2+val[1]:]
 	}
+	for _, name := range []string{"runtime.chanrecv", "runtime.semacquire"} {
+		if !found[name] {
+			t.Errorf("no long block in %s in profile:\n%s", name, prof.String())
+		}
+	}
+}
 
-	if !found {
-		t.Fatal("did not find ChecksumIEEE in the profile")
+// Event types and argument counts, from runtime.h.
+const (
+	traceEvBatch = 1 + iota
+	traceEvStack
+	traceEvGoState
+	traceEvGoCreate
+	traceEvGoStart
+	traceEvGoSched
+	traceEvGoEnd
+	traceEvGoBlock
+	traceEvGoUnblock
+	traceEvGoSysCall
+	traceEvGoSysExit
+	traceEvGoSysBlock
+	traceEvGCStart
+	traceEvGCDone
+	traceEvCount
+)
+
+var traceArgs = [traceEvCount]int{
+	traceEvBatch:      2,
+	traceEvGoState:    2,
+	traceEvGoCreate:   3,
+	traceEvGoStart:    1,
+	traceEvGoSched:    1,
+	traceEvGoEnd:      1,
+	traceEvGoBlock:    3,
+	traceEvGoUnblock:  3,
+	traceEvGoSysCall:  1,
+	traceEvGoSysExit:  1,
+	traceEvGoSysBlock: 1,
+	traceEvGCStart:    0,
+	traceEvGCDone:     1,
+}
+
+func TestTrace(t *testing.T) {
+	var buf bytes.Buffer
+	if err := StartTrace(&buf); err != nil {
+		t.Fatal(err)
+	}
+	if err := StartTrace(&buf); err == nil {
+		t.Fatal("second StartTrace succeeded")
+	}
+	c := make(chan int)
+	done := make(chan bool)
+	go func() {
+		for _ = range c {
+		}
+		done <- true
+	}()
+	for i := 0; i < 100; i++ {
+		c <- i
+	}
+	close(c)
+	<-done
+	runtime.GC()
+	StopTrace()
+
+	data := buf.Bytes()
+	if !bytes.HasPrefix(data, []byte("go trace 1\n")) {
+		t.Fatalf("bad trace header %q", data[:10])
+	}
+	data = data[len("go trace 1\n"):]
+	next := func() uint64 {
+		var v uint64
+		for shift := uint(0); ; shift += 7 {
+			if len(data) == 0 {
+				t.Fatal("truncated trace")
+			}
+			b := data[0]
+			data = data[1:]
+			v |= uint64(b&0x7f) << shift
+			if b < 0x80 {
+				return v
+			}
+		}
+		panic("unreachable")
+	}
+	var count [traceEvCount]int
+	// Stacks can be defined in a later batch than the one using them.
+	stacks := make(map[uint64]bool)
+	used := make(map[uint64]bool)
+	for len(data) > 0 {
+		ev := data[0]
+		data = data[1:]
+		if ev == 0 || ev >= traceEvCount {
+			t.Fatalf("bad event type %d", ev)
+		}
+		count[ev]++
+		switch ev {
+		case traceEvBatch:
+			next()
+			next()
+		case traceEvStack:
+			stacks[next()] = true
+			for n := next(); n > 0; n-- {
+				next()
+			}
+		default:
+			next() // time
+			for i := 0; i < traceArgs[ev]; i++ {
+				v := next()
+				if i == 2 && v != 0 {
+					used[v] = true
+				}
+			}
+		}
+	}
+	for id := range used {
+		if !stacks[id] {
+			t.Errorf("stack %d used but not defined", id)
+		}
+	}
+	for _, ev := range []int{traceEvBatch, traceEvGoState, traceEvGoCreate, traceEvGoStart,
+		traceEvGoBlock, traceEvGoUnblock, traceEvGoEnd, traceEvGCStart, traceEvGCDone} {
+		if count[ev] == 0 {
+			t.Errorf("no events of type %d in trace", ev)
+		}
 	}
 }
@@ -55,27 +55,76 @@ int32	runtime·gcwaiting;
 struct Sched {
 	Lock;
 
-	G *gfree;	// available gs (status == Gdead)
+	Lock	gflock;	// protects gfree
+	G *gfree;	// available gs (status == Gdead) not cached by an m
 
 	G *ghead;	// gs waiting to run
 	G *gtail;
 	int32 gwait;	// number of gs waiting to run
 	int32 gcount;	// number of gs that are alive
+	int32 grunning;	// number of gs running on cpu or in syscall
 
 	M *mhead;	// ms waiting for work
 	int32 mwait;	// number of ms waiting for work
 	int32 mcount;	// number of ms that have been created
-	int32 mcpu;	// number of ms executing on cpu
-	int32 mcpumax;	// max number of ms allowed on cpu
-	int32 msyscall;	// number of ms in system calls
+
+	volatile uint32 atomic;	// atomic scheduling word (see below)
 
 	int32 predawn;	// running initialization, don't run new gs.
 	int32 profilehz;	// cpu profiling rate
 
-	Note	stopped;	// one g can wait here for ms to stop
-	int32 waitstop;	// after setting this flag
+	Note	stopped;	// one g can set waitstop and wait here for ms to stop
+};
+
+// The atomic word in sched is an atomic uint32 that
+// holds these fields.
+//
+//	[15 bits] mcpu		number of ms executing on cpu
+//	[15 bits] mcpumax	max number of ms allowed on cpu
+//	[1 bit] waitstop	some g is waiting on stopped
+//	[1 bit] gwaiting	gwait != 0
+//
+// These fields are the information needed by entersyscall
+// and exitsyscall to decide whether to coordinate with the
+// scheduler.  Packing them into a single machine word lets
+// them use a fast path with a single atomic read/write and
+// no lock/unlock.  This greatly reduces contention in
+// syscall- or cgo-heavy multithreaded programs.
+//
+// Except for entersyscall and exitsyscall, the manipulations
+// to these fields only happen while holding the schedlock,
+// so the routines holding schedlock only need to worry about
+// what entersyscall and exitsyscall do, not the other routines
+// (which also use the schedlock).
+//
+// In particular, entersyscall and exitsyscall only read mcpumax,
+// waitstop, and gwaiting.  They never write them.  Thus, writes to those
+// fields can be done (holding schedlock) without fear of write conflicts.
+// There may still be logic conflicts: for example, the set of waitstop must
+// be conditioned on mcpu >= mcpumax or else the wait may be a
+// spurious sleep.
+enum
+{
+	mcpuWidth = 15,
+	mcpuMask = (1<<mcpuWidth) - 1,
+	mcpuShift = 0,
+	mcpumaxShift = mcpuShift + mcpuWidth,
+	waitstopShift = mcpumaxShift + mcpuWidth,
+	gwaitingShift = waitstopShift+1,
+
+	// The max value of GOMAXPROCS is constrained
+	// by the max value we can store in the bit fields
+	// of the atomic word.  Reserve a few high values
+	// so that we can detect accidental decrement
+	// beyond zero.
+	maxgomaxprocs = mcpuMask - 10,
 };
 
+#define atomic_mcpu(v)		(((v)>>mcpuShift)&mcpuMask)
+#define atomic_mcpumax(v)	(((v)>>mcpumaxShift)&mcpuMask)
+#define atomic_waitstop(v)	(((v)>>waitstopShift)&1)
+#define atomic_gwaiting(v)	(((v)>>gwaitingShift)&1)
+
 Sched runtime·sched;
 int32 gomaxprocs;
 
@@ -91,11 +140,14 @@ static void gput(G*);	// put/get on ghead/gtail
 static G* gget(void);
 static void mput(M*);	// put/get on mhead
 static M* mget(G*);
-static void gfput(G*);	// put/get on gfree
-static G* gfget(void);
+static void gfput(G*);	// put/get on m->gfree, spilling to gfree
+static G* gfget(void);	// does not need sched locked
 static void matchmg(void);	// match ms to gs
 static void readylocked(G*);	// ready, but sched is locked
 static void mnextg(M*, G*);
+static bool haveg(void);	// report whether gget would return something
+static bool canaddmcpu(void);	// try to account for one more m on cpu
+static void setmcpumax(uint32);
 
 // The bootstrap sequence is:
 //
@@ -129,9 +181,12 @@ runtime·schedinit(void)
 
 	runtime·gomaxprocs = 1;
 	p = runtime·getenv("GOMAXPROCS");
-	if(p != nil && (n = runtime·atoi(p)) != 0)
+	if(p != nil && (n = runtime·atoi(p)) != 0) {
+		if(n > maxgomaxprocs)
+			n = maxgomaxprocs;
 		runtime·gomaxprocs = n;
-	runtime·sched.mcpumax = runtime·gomaxprocs;
+	}
+	setmcpumax(runtime·gomaxprocs);
 	runtime·sched.mcount = 1;
 	runtime·sched.predawn = 1;
 
@@ -172,6 +227,23 @@ runtime·initdone(void)
 	schedlock();
 	matchmg();
 	schedunlock();
+
+	runtime·profctlinit();
+}
+
+// Called when the program exits normally:
+// after main·main returns, and by os.Exit.
+void
+runtime·beforeexit(void)
+{
+	runtime·coverdump();
+	runtime·profctlexit();
+}
+
+void
+os·beforeexit(void)
+{
+	runtime·beforeexit();
 }
 
 void
@@ -213,7 +285,7 @@ gput(G *g)
 	M *m;
 
 	// If g is wired, hand it off directly.
-	if(runtime·sched.mcpu < runtime·sched.mcpumax && (m = g->lockedm) != nil) {
+	if((m = g->lockedm) != nil && canaddmcpu()) {
 		mnextg(m, g);
 		return;
 	}
@@ -236,7 +308,18 @@ gput(G *g)
 	else
 		runtime·sched.gtail->schedlink = g;
 	runtime·sched.gtail = g;
-	runtime·sched.gwait++;
+
+	// increment gwait.
+	// if it transitions to nonzero, set atomic gwaiting bit.
+	if(runtime·sched.gwait++ == 0)
+		runtime·xadd(&runtime·sched.atomic, 1<<gwaitingShift);
+}
+
+// Report whether gget would return something.
+static bool
+haveg(void)
+{
+	return runtime·sched.ghead != nil || m->idleg != nil;
 }
 
 // Get from `g' queue.  Sched must be locked.
@@ -250,7 +333,10 @@ gget(void)
 		runtime·sched.ghead = g->schedlink;
 		if(runtime·sched.ghead == nil)
 			runtime·sched.gtail = nil;
-		runtime·sched.gwait--;
+		// decrement gwait.
+		// if it transitions to zero, clear atomic gwaiting bit.
+		if(--runtime·sched.gwait == 0)
+			runtime·xadd(&runtime·sched.atomic, -1<<gwaitingShift);
 	} else if(m->idleg != nil) {
 		g = m->idleg;
 		m->idleg = nil;
@@ -289,6 +375,8 @@ mget(G *g)
 void
 runtime·ready(G *g)
 {
+	if(runtime·tracing)
+		runtime·tracegostk(TraceEvGoUnblock, g, m->curg != nil ? m->curg->goid : 0);
 	schedlock();
 	readylocked(g);
 	schedunlock();
@@ -334,11 +422,43 @@ newprocreadylocked(G *g)
 	readylocked(g);
 }
 
+// Try to increment mcpu.  Report whether succeeded.
+static bool
+canaddmcpu(void)
+{
+	uint32 v;
+
+	for(;;) {
+		v = runtime·sched.atomic;
+		if(atomic_mcpu(v) >= atomic_mcpumax(v))
+			return 0;
+		if(runtime·cas(&runtime·sched.atomic, v, v+(1<<mcpuShift)))
+			return 1;
+	}
+}
+
+// Set mcpumax.  Sched must be locked.
+static void
+setmcpumax(uint32 n)
+{
+	uint32 v, w;
+
+	for(;;) {
+		v = runtime·sched.atomic;
+		w = v;
+		w &= ~(mcpuMask<<mcpumaxShift);
+		w |= n<<mcpumaxShift;
+		if(runtime·cas(&runtime·sched.atomic, v, w))
+			break;
+	}
+}
+
 // Pass g to m for running.
+// Caller has already incremented mcpu.
 static void
 mnextg(M *m, G *g)
 {
-	runtime·sched.mcpu++;
+	runtime·sched.grunning++;
 	m->nextg = g;
 	if(m->waitnextg) {
 		m->waitnextg = 0;
@@ -356,12 +476,13 @@ static G*
 nextgandunlock(void)
 {
 	G *gp;
+	uint32 v;
 
-	if(runtime·sched.mcpu < 0)
-		runtime·throw("negative runtime·sched.mcpu");
+	if(atomic_mcpu(runtime·sched.atomic) >= maxgomaxprocs)
+		runtime·throw("negative mcpu");
 
-	// If there is a g waiting as m->nextg,
-	// mnextg took care of the runtime·sched.mcpu++.
+	// If there is a g waiting as m->nextg, the mcpu++
+	// happened before it was passed to mnextg.
 	if(m->nextg != nil) {
 		gp = m->nextg;
 		m->nextg = nil;
@@ -373,29 +494,65 @@ nextgandunlock(void)
 		// We can only run one g, and it's not available.
 		// Make sure some other cpu is running to handle
 		// the ordinary run queue.
-		if(runtime·sched.gwait != 0)
+		if(runtime·sched.gwait != 0) {
 			matchmg();
+			// m->lockedg might have been on the queue.
+			if(m->nextg != nil) {
+				gp = m->nextg;
+				m->nextg = nil;
+				schedunlock();
+				return gp;
+			}
+		}
 	} else {
 		// Look for work on global queue.
-		while(runtime·sched.mcpu < runtime·sched.mcpumax && (gp=gget()) != nil) {
+		while(haveg() && canaddmcpu()) {
+			gp = gget();
+			if(gp == nil)
+				runtime·throw("gget inconsistency");
+
 			if(gp->lockedm) {
 				mnextg(gp->lockedm, gp);
 				continue;
 			}
-			runtime·sched.mcpu++;		// this m will run gp
+			runtime·sched.grunning++;
 			schedunlock();
 			return gp;
 		}
-		// Otherwise, wait on global m queue.
+
+		// The while loop ended either because the g queue is empty
+		// or because we have maxed out our m procs running go
+		// code (mcpu >= mcpumax).  We need to check that
+		// concurrent actions by entersyscall/exitsyscall cannot
+		// invalidate the decision to end the loop.
+		//
+		// We hold the sched lock, so no one else is manipulating the
+		// g queue or changing mcpumax.  Entersyscall can decrement
+		// mcpu, but if does so when there is something on the g queue,
+		// the gwait bit will be set, so entersyscall will take the slow path
+		// and use the sched lock.  So it cannot invalidate our decision.
+		//
+		// Wait on global m queue.
 		mput(m);
 	}
-	if(runtime·sched.mcpu == 0 && runtime·sched.msyscall == 0)
+
+	// Look for deadlock situation.
+	// A g in a system call still counts as running,
+	// so this does not fire while a cgo call is outstanding.
+	if(runtime·sched.grunning == 0)
 		runtime·throw("all goroutines are asleep - deadlock!");
 	m->nextg = nil;
 	m->waitnextg = 1;
 	runtime·noteclear(&m->havenextg);
-	if(runtime·sched.waitstop && runtime·sched.mcpu <= runtime·sched.mcpumax) {
-		runtime·sched.waitstop = 0;
+
+	// Stoptheworld is waiting for all but its cpu to go to stop.
+	// Entersyscall might have decremented mcpu too, but if so
+	// it will see the waitstop and take the slow path.
+	// Exitsyscall never increments mcpu beyond mcpumax.
+	v = runtime·atomicload(&runtime·sched.atomic);
+	if(atomic_waitstop(v) && atomic_mcpu(v) <= atomic_mcpumax(v)) {
+		// set waitstop = 0 (known to be 1)
+		runtime·xadd(&runtime·sched.atomic, -1<<waitstopShift);
 		runtime·notewakeup(&runtime·sched.stopped);
 	}
 	schedunlock();
@@ -412,16 +569,32 @@ nextgandunlock(void)
 void
 runtime·stoptheworld(void)
 {
+	uint32 v;
+
 	schedlock();
 	runtime·gcwaiting = 1;
-	runtime·sched.mcpumax = 1;
-	while(runtime·sched.mcpu > 1) {
+
+	setmcpumax(1);
+
+	// while mcpu > 1
+	for(;;) {
+		v = runtime·sched.atomic;
+		if(atomic_mcpu(v) <= 1)
+			break;
+
 		// It would be unsafe for multiple threads to be using
 		// the stopped note at once, but there is only
 		// ever one thread doing garbage collection,
 		// so this is okay.
 		runtime·noteclear(&runtime·sched.stopped);
-		runtime·sched.waitstop = 1;
+		if(atomic_waitstop(v))
+			runtime·throw("invalid waitstop");
+
+		// atomic { waitstop = 1 }, predicated on mcpu <= 1 check above
+		// still being true.
+		if(!runtime·cas(&runtime·sched.atomic, v, v+(1<<waitstopShift)))
+			continue;
+
 		schedunlock();
 		runtime·notesleep(&runtime·sched.stopped);
 		schedlock();
@@ -436,7 +609,7 @@ runtime·starttheworld(void)
 {
 	schedlock();
 	runtime·gcwaiting = 0;
-	runtime·sched.mcpumax = runtime·gomaxprocs;
+	setmcpumax(runtime·gomaxprocs);
 	matchmg();
 	schedunlock();
 }
@@ -484,9 +657,13 @@ matchmg(void)
 
 	if(m->mallocing || m->gcing)
 		return;
-	while(runtime·sched.mcpu < runtime·sched.mcpumax && (g = gget()) != nil){
+	while(haveg() && canaddmcpu()) {
 		M *m;
 
+		g = gget();
+		if(g == nil)
+			runtime·throw("gget inconsistency");
+
 		// Find the m that will run g.
 		if((m = mget(g)) == nil){
 			m = runtime·malloc(sizeof(M));
@@ -528,6 +705,7 @@ static void
 schedule(G *gp)
 {
 	int32 hz;
+	uint32 v;
 
 	schedlock();
 	if(gp != nil) {
@@ -536,20 +714,26 @@ schedule(G *gp)
 
 		// Just finished running gp.
 		gp->m = nil;
-		runtime·sched.mcpu--;
+		runtime·sched.grunning--;
 
-		if(runtime·sched.mcpu < 0)
-			runtime·throw("runtime·sched.mcpu < 0 in scheduler");
+		// atomic { mcpu-- }
+		v = runtime·xadd(&runtime·sched.atomic, -1<<mcpuShift);
+		if(atomic_mcpu(v) > maxgomaxprocs)
+			runtime·throw("negative mcpu in scheduler");
 		switch(gp->status){
 		case Grunnable:
 		case Gdead:
 			// Shouldn't have been running!
 			runtime·throw("bad gp->status in sched");
 		case Grunning:
+			if(runtime·tracing)
+				runtime·tracego(TraceEvGoSched, gp);
 			gp->status = Grunnable;
 			gput(gp);
 			break;
 		case Gmoribund:
+			if(runtime·tracing)
+				runtime·tracego(TraceEvGoEnd, gp);
 			gp->status = Gdead;
 			if(gp->lockedm) {
 				gp->lockedm = nil;
@@ -563,6 +747,10 @@ schedule(G *gp)
 			break;
 		}
 		if(gp->readyonstop){
+			// Blocked goroutines recorded the event themselves
+			// (see chan.c); this is exitsyscall finding no free cpu.
+			if(runtime·tracing && gp->status == Gsyscall)
+				runtime·tracego(TraceEvGoSysBlock, gp);
 			gp->readyonstop = 0;
 			readylocked(gp);
 		}
@@ -574,11 +762,16 @@ schedule(G *gp)
 	gp->status = Grunning;
 	m->curg = gp;
 	gp->m = m;
+	if(runtime·tracing)
+		runtime·tracego(TraceEvGoStart, gp);
 	
 	// Check whether the profiler needs to be turned on or off.
 	hz = runtime·sched.profilehz;
-	if(m->profilehz != hz)
+	if(m->profilehz != hz) {
+		if(hz != 0)
+			runtime·cpuprofminit(m);
 		runtime·resetcpuprofiler(hz);
+	}
 
 	if(gp->sched.pc == (byte*)runtime·goexit) {	// kickoff
 		runtime·gogocall(&gp->sched, (void(*)(void))gp->entry);
@@ -612,37 +805,65 @@ runtime·gosched(void)
 // make g->sched refer to the caller's stack segment, because
 // entersyscall is going to return immediately after.
 // It's okay to call matchmg and notewakeup even after
-// decrementing mcpu, because we haven't released the
-// sched lock yet, so the garbage collector cannot be running.
+// decrementing mcpu: if the garbage collector has started
+// in the meantime, mcpumax is 1 and matchmg cannot start
+// another m.
 #pragma textflag 7
 void
 runtime·entersyscall(void)
 {
+	uint32 v;
+
 	if(runtime·sched.predawn)
 		return;
-	schedlock();
-	g->status = Gsyscall;
-	runtime·sched.mcpu--;
-	runtime·sched.msyscall++;
-	if(runtime·sched.gwait != 0)
-		matchmg();
 
-	if(runtime·sched.waitstop && runtime·sched.mcpu <= runtime·sched.mcpumax) {
-		runtime·sched.waitstop = 0;
-		runtime·notewakeup(&runtime·sched.stopped);
-	}
+	// Record the event before saving SP: tracego may split the stack.
+	if(runtime·tracing)
+		runtime·tracego(TraceEvGoSysCall, g);
 
 	// Leave SP around for gc and traceback.
-	// Do before schedunlock so that gc
+	// Do before the atomic decrement below so that gc
 	// never sees Gsyscall with wrong stack.
 	runtime·gosave(&g->sched);
 	g->gcsp = g->sched.sp;
 	g->gcstack = g->stackbase;
 	g->gcguard = g->stackguard;
+	g->status = Gsyscall;
 	if(g->gcsp < g->gcguard-StackGuard || g->gcstack < g->gcsp) {
-		runtime·printf("entersyscall inconsistent %p [%p,%p]\n", g->gcsp, g->gcguard-StackGuard, g->gcstack);
+		// The printf would push entersyscall's nosplit
+		// frame chain past StackLimit; see 6l's stkcheck.
+		// runtime·printf("entersyscall inconsistent %p [%p,%p]\n",
+		//	g->gcsp, g->gcguard-StackGuard, g->gcstack);
 		runtime·throw("entersyscall");
 	}
+
+	// Fast path.
+	// The slow path inside the schedlock/schedunlock will get
+	// through without stopping if it does:
+	//	mcpu--
+	//	gwait not true
+	//	waitstop && mcpu <= mcpumax not true
+	// If we can do the same with a single atomic add,
+	// then we can skip the locks.
+	v = runtime·xadd(&runtime·sched.atomic, -1<<mcpuShift);
+	if(!atomic_gwaiting(v) && (!atomic_waitstop(v) || atomic_mcpu(v) > atomic_mcpumax(v)))
+		return;
+
+	schedlock();
+	v = runtime·atomicload(&runtime·sched.atomic);
+	if(atomic_gwaiting(v)) {
+		matchmg();
+		v = runtime·atomicload(&runtime·sched.atomic);
+	}
+	if(atomic_waitstop(v) && atomic_mcpu(v) <= atomic_mcpumax(v)) {
+		runtime·xadd(&runtime·sched.atomic, -1<<waitstopShift);
+		runtime·notewakeup(&runtime·sched.stopped);
+	}
+
+	// Re-save sched in case one of the calls
+	// (notewakeup, matchmg) triggered something using it.
+	runtime·gosave(&g->sched);
+
 	schedunlock();
 }
 
@@ -653,35 +874,40 @@ runtime·entersyscall(void)
 void
 runtime·exitsyscall(void)
 {
+	uint32 v;
+
 	if(runtime·sched.predawn)
 		return;
 
-	schedlock();
-	runtime·sched.msyscall--;
-	runtime·sched.mcpu++;
-	// Fast path - if there's room for this m, we're done.
-	if(m->profilehz == runtime·sched.profilehz && runtime·sched.mcpu <= runtime·sched.mcpumax) {
+	// Fast path.
+	// If we can do the mcpu++ bookkeeping and
+	// find that we still have mcpu <= mcpumax, then we can
+	// start executing Go code immediately, without having to
+	// schedlock/schedunlock.
+	v = runtime·xadd(&runtime·sched.atomic, (1<<mcpuShift));
+	if(m->profilehz == runtime·sched.profilehz && atomic_mcpu(v) <= atomic_mcpumax(v)) {
 		// There's a cpu for us, so we can run.
 		g->status = Grunning;
 		// Garbage collector isn't running (since we are),
 		// so okay to clear gcstack.
 		g->gcstack = nil;
-		schedunlock();
+		if(runtime·tracing)
+			runtime·tracego(TraceEvGoSysExit, g);
 		return;
 	}
+
 	// Tell scheduler to put g back on the run queue:
 	// mostly equivalent to g->status = Grunning,
 	// but keeps the garbage collector from thinking
 	// that g is running right now, which it's not.
 	g->readyonstop = 1;
-	schedunlock();
 
-	// Slow path - all the cpus are taken.
+	// All the cpus are taken.
 	// The scheduler will ready g and put this m to sleep.
 	// When the scheduler takes g away from m,
-	// it will undo the runtime·sched.mcpu++ above.
+	// it will undo the mcpu++ above.
 	runtime·gosched();
-	
+
 	// Gosched returned, so we're allowed to run now.
 	// Delete the gcstack information that we left for
 	// the garbage collector during the system call.
@@ -689,6 +915,8 @@ runtime·exitsyscall(void)
 	// we don't know for sure that the garbage collector
 	// is not running.
 	g->gcstack = nil;
+	if(runtime·tracing)
+		runtime·tracego(TraceEvGoSysExit, g);
 }
 
 void
@@ -718,7 +946,7 @@ runtime·oldstack(void)
 	g1->stackbase = old.stackbase;
 	g1->stackguard = old.stackguard;
 
-	runtime·gogo(&old.gobuf, m->cret);
+	runtime·gogoret(&old.gobuf, m->cret);
 }
 
 void
@@ -876,17 +1104,22 @@ runtime·newproc1(byte *fn, byte *argp, int32 narg, int32 nret, void *callerpc)
 	if(siz > 1024)
 		runtime·throw("runtime.newproc: too many args");
 
-	schedlock();
-
+	// Only making newg runnable needs the scheduler lock.
+	// The garbage collector cannot run until this goroutine
+	// reaches a scheduling point, so newg can be set up unlocked.
 	if((newg = gfget()) != nil){
-		newg->status = Gwaiting;
+		if(!runtime·cas(&newg->status, Gdead, Gwaiting))
+			runtime·throw("bad status in newg");
 		if(newg->stackguard - StackGuard != newg->stack0)
 			runtime·throw("invalid stack in newg");
 	} else {
 		newg = runtime·malg(StackMin);
 		newg->status = Gwaiting;
-		newg->alllink = runtime·allg;
-		runtime·allg = newg;
+		// Gs are only ever added to the front of allg,
+		// so others can walk it without a lock.
+		do
+			newg->alllink = runtime·allg;
+		while(!runtime·casp(&runtime·allg, newg->alllink, newg));
 	}
 
 	sp = newg->stackbase;
@@ -903,11 +1136,14 @@ runtime·newproc1(byte *fn, byte *argp, int32 narg, int32 nret, void *callerpc)
 	newg->sched.g = newg;
 	newg->entry = fn;
 	newg->gopc = (uintptr)callerpc;
+	newg->proflabel = g->proflabel;
 
-	runtime·sched.gcount++;
-	runtime·goidgen++;
-	newg->goid = runtime·goidgen;
+	newg->goid = runtime·xadd((uint32*)&runtime·goidgen, 1);
+	if(runtime·tracing)
+		runtime·tracegostk(TraceEvGoCreate, newg, g->goid);
 
+	schedlock();
+	runtime·sched.gcount++;
 	newprocreadylocked(newg);
 	schedunlock();
 
@@ -959,7 +1195,8 @@ runtime·deferreturn(uintptr arg0)
 	runtime·mcpy(argp, d->args, d->siz);
 	g->defer = d->link;
 	fn = d->fn;
-	runtime·free(d);
+	if(!d->nofree)
+		runtime·free(d);
 	runtime·jmpdefer(fn, argp);
 }
 
@@ -971,7 +1208,8 @@ rundefer(void)
 	while((d = g->defer) != nil) {
 		g->defer = d->link;
 		reflect·call(d->fn, d->args, d->siz);
-		runtime·free(d);
+		if(!d->nofree)
+			runtime·free(d);
 	}
 }
 
@@ -1051,7 +1289,8 @@ runtime·panic(Eface e)
 			runtime·mcall(recovery);
 			runtime·throw("recovery failed"); // mcall should not return
 		}
-		runtime·free(d);
+		if(!d->nofree)
+			runtime·free(d);
 	}
 
 	// ran out of deferred calls - old-school panic now
@@ -1086,7 +1325,8 @@ recovery(G *gp)
 	else
 		gp->sched.sp = (byte*)d->argp - 2*sizeof(uintptr);
 	gp->sched.pc = d->pc;
-	runtime·free(d);
+	if(!d->nofree)
+		runtime·free(d);
 	runtime·gogo(&gp->sched, 1);
 }
 
@@ -1161,25 +1401,57 @@ nomatch:
 }
 
 
-// Put on gfree list.  Sched must be locked.
+enum
+{
+	MaxGfree = 64,	// dead gs cached per m
+};
+
+// Put on m's list of dead gs.  If the list gets too long,
+// move half of it to the global gfree list.
+// Dead gs keep their stacks, so reusing one is cheap.
+// Only the m itself touches m->gfree, so it needs no lock.
 static void
 gfput(G *g)
 {
 	if(g->stackguard - StackGuard != g->stack0)
 		runtime·throw("invalid stack in gfput");
-	g->schedlink = runtime·sched.gfree;
-	runtime·sched.gfree = g;
+	g->schedlink = m->gfree;
+	m->gfree = g;
+	if(++m->gfreecnt < MaxGfree)
+		return;
+	runtime·lock(&runtime·sched.gflock);
+	while(m->gfreecnt > MaxGfree/2) {
+		g = m->gfree;
+		m->gfree = g->schedlink;
+		m->gfreecnt--;
+		g->schedlink = runtime·sched.gfree;
+		runtime·sched.gfree = g;
+	}
+	runtime·unlock(&runtime·sched.gflock);
 }
 
-// Get from gfree list.  Sched must be locked.
+// Get from m's list of dead gs, refilling it from
+// the global gfree list if it is empty.
 static G*
 gfget(void)
 {
 	G *g;
 
-	g = runtime·sched.gfree;
-	if(g)
-		runtime·sched.gfree = g->schedlink;
+	if(m->gfree == nil && runtime·sched.gfree != nil) {
+		runtime·lock(&runtime·sched.gflock);
+		while(m->gfreecnt < MaxGfree/2 && (g = runtime·sched.gfree) != nil) {
+			runtime·sched.gfree = g->schedlink;
+			g->schedlink = m->gfree;
+			m->gfree = g;
+			m->gfreecnt++;
+		}
+		runtime·unlock(&runtime·sched.gflock);
+	}
+	g = m->gfree;
+	if(g) {
+		m->gfree = g->schedlink;
+		m->gfreecnt--;
+	}
 	return g;
 }
 
@@ -1216,21 +1488,28 @@ int32
 runtime·gomaxprocsfunc(int32 n)
 {
 	int32 ret;
+	uint32 v;
 
 	schedlock();
 	ret = runtime·gomaxprocs;
-	if (n <= 0)
+	if(n <= 0)
 		n = ret;
+	if(n > maxgomaxprocs)
+		n = maxgomaxprocs;
 	runtime·gomaxprocs = n;
- 	if (runtime·gcwaiting != 0) {
- 		if (runtime·sched.mcpumax != 1)
- 			runtime·throw("invalid runtime·sched.mcpumax during gc");
+	if(runtime·gcwaiting != 0) {
+		if(atomic_mcpumax(runtime·sched.atomic) != 1)
+			runtime·throw("invalid mcpumax during gc");
 		schedunlock();
 		return ret;
 	}
-	runtime·sched.mcpumax = n;
-	// handle fewer procs?
-	if(runtime·sched.mcpu > runtime·sched.mcpumax) {
+
+	setmcpumax(n);
+
+	// If there are now fewer allowed procs
+	// than procs running, stop.
+	v = runtime·atomicload(&runtime·sched.atomic);
+	if(atomic_mcpu(v) > n) {
 		schedunlock();
 		// just give up the cpu.
 		// we'll only get rescheduled once the
@@ -1292,32 +1571,26 @@ runtime·badmcall2(void)  // called from assembly
 
 static struct {
 	Lock;
-	void (*fn)(uintptr*, int32);
+	void (*fn)(uint8*, uint8*, uint8*, G*);
 	int32 hz;
-	uintptr pcbuf[100];
 } prof;
 
+// sigprof runs on every m at once, so it takes no locks.
+// The hook records the sample in a per-m buffer and must
+// tolerate being called after profiling has been turned off.
 void
 runtime·sigprof(uint8 *pc, uint8 *sp, uint8 *lr, G *gp)
 {
-	int32 n;
-	
-	if(prof.fn == nil || prof.hz == 0)
-		return;
-	
-	runtime·lock(&prof);
-	if(prof.fn == nil) {
-		runtime·unlock(&prof);
+	void (*fn)(uint8*, uint8*, uint8*, G*);
+
+	fn = prof.fn;
+	if(fn == nil || prof.hz == 0)
 		return;
-	}
-	n = runtime·gentraceback(pc, sp, lr, gp, 0, prof.pcbuf, nelem(prof.pcbuf));
-	if(n > 0)
-		prof.fn(prof.pcbuf, n);
-	runtime·unlock(&prof);
+	fn(pc, sp, lr, gp);
 }
 
 void
-runtime·setcpuprofilerate(void (*fn)(uintptr*, int32), int32 hz)
+runtime·setcpuprofilerate(void (*fn)(uint8*, uint8*, uint8*, G*), int32 hz)
 {
 	// Force sane arguments.
 	if(hz < 0)
@@ -1327,9 +1600,7 @@ runtime·setcpuprofilerate(void (*fn)(uintptr*, int32), int32 hz)
 	if(fn == nil)
 		hz = 0;
 
-	// Stop profiler on this cpu so that it is safe to lock prof.
-	// if a profiling signal came in while we had prof locked,
-	// it would deadlock.
+	// Stop profiler on this cpu while the hook changes.
 	runtime·resetcpuprofiler(0);
 
 	runtime·lock(&prof);
@@ -6,6 +6,7 @@ package runtime_test
 
 import (
 	"runtime"
+	"sync"
 	"testing"
 )
 
@@ -41,3 +42,90 @@ func TestStopTheWorldDeadlock(t *testing.T) {
 	<-compl
 	stop <- true
 }
+
+// spawn starts n goroutines that exit immediately, from each of
+// procs goroutines, and waits for them all to finish.  It waits for
+// each batch of 100 before starting the next, so that the dead
+// goroutines are reused rather than piling up.
+func spawn(procs, n int) {
+	var all sync.WaitGroup
+	all.Add(procs)
+	for p := 0; p < procs; p++ {
+		go func() {
+			var wg sync.WaitGroup
+			for i := 0; i < n; i += 100 {
+				m := n - i
+				if m > 100 {
+					m = 100
+				}
+				wg.Add(m)
+				for j := 0; j < m; j++ {
+					go wg.Done()
+				}
+				wg.Wait()
+			}
+			all.Done()
+		}()
+	}
+	all.Wait()
+}
+
+func TestGoroutineReuse(t *testing.T) {
+	defer runtime.GOMAXPROCS(runtime.GOMAXPROCS(4))
+	for i := 0; i < 10; i++ {
+		spawn(4, 1000)
+		runtime.GC()
+	}
+	if n := runtime.Goroutines(); n > 10 {
+		t.Errorf("%d goroutines still running", n)
+	}
+}
+
+func benchmarkCreate(b *testing.B, procs int) {
+	b.StopTimer()
+	defer runtime.GOMAXPROCS(runtime.GOMAXPROCS(procs))
+	spawn(procs, 100) // warm up the free lists
+	b.StartTimer()
+	spawn(procs, b.N/procs)
+}
+
+func BenchmarkGoroutineCreate(b *testing.B)  { benchmarkCreate(b, 1) }
+func BenchmarkGoroutineCreate4(b *testing.B) { benchmarkCreate(b, 4) }
+
+// parallel runs f on $GOMAXPROCS goroutines, giving each an equal
+// share of b.N iterations, and waits for them all to finish.
+func parallel(b *testing.B, f func(n int)) {
+	procs := runtime.GOMAXPROCS(-1)
+	var wg sync.WaitGroup
+	wg.Add(procs)
+	for p := 0; p < procs; p++ {
+		n := b.N / procs
+		if p < b.N%procs {
+			n++
+		}
+		go func() {
+			f(n)
+			wg.Done()
+		}()
+	}
+	wg.Wait()
+}
+
+func BenchmarkGoroutineCreateParallel(b *testing.B) {
+	spawn(runtime.GOMAXPROCS(-1), b.N)
+}
+
+// Two goroutines take turns through runtime.Gosched.
+func BenchmarkGoroutineSwitch(b *testing.B) {
+	done := make(chan bool)
+	for i := 0; i < 2; i++ {
+		go func() {
+			for j := 0; j < b.N/2; j++ {
+				runtime.Gosched()
+			}
+			done <- true
+		}()
+	}
+	<-done
+	<-done
+}
@@ -127,23 +127,6 @@ runtime·mcpy(byte *t, byte *f, uint32 n)
 	}
 }
 
-int32
-runtime·mcmp(byte *s1, byte *s2, uint32 n)
-{
-	uint32 i;
-	byte c1, c2;
-
-	for(i=0; i<n; i++) {
-		c1 = s1[i];
-		c2 = s2[i];
-		if(c1 < c2)
-			return -1;
-		if(c1 > c2)
-			return +1;
-	}
-	return 0;
-}
-
 
 byte*
 runtime·mchr(byte *p, byte c, byte *ep)
@@ -364,20 +347,9 @@ memhash(uint32 s, void *a)
 static uint32
 memequal(uint32 s, void *a, void *b)
 {
-	byte *ba, *bb, *aend;
-
 	if(a == b)
 	  return 1;
-	ba = a;
-	bb = b;
-	aend = ba+s;
-	while(ba != aend) {
-		if(*ba != *bb)
-			return 0;
-		ba++;
-		bb++;
-	}
-	return 1;
+	return runtime·memeq(a, b, s);
 }
 
 static void
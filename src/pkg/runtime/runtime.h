@@ -190,7 +190,7 @@ struct	G
 	byte*	entry;		// initial function
 	G*	alllink;	// on allg
 	void*	param;		// passed parameter on wakeup
-	int16	status;
+	uint32	status;
 	int32	goid;
 	uint32	selgen;		// valid sudog pointer
 	G*	schedlink;
@@ -204,6 +204,7 @@ struct	G
 	uintptr	sigcode1;
 	uintptr	sigpc;
 	uintptr	gopc;	// pc of go statement that created this goroutine
+	uintptr	proflabel;	// cpu profile label, inherited by new goroutines
 };
 struct	M
 {
@@ -217,6 +218,9 @@ struct	M
 	uint32	moreframesize;	// size arguments to morestack
 	uint32	moreargsize;
 	uintptr	cret;		// return value from C
+	uintptr	moreregs[6];	// register arguments saved by morestack (amd64)
+	float64	morefregs[4];
+	float64	cretf;		// floating point return value, saved by lessstack (amd64)
 	uint64	procid;		// for debuggers, but offset not hard-coded
 	G*	gsignal;	// signal-handling G
 	uint32	tls[8];		// thread-local storage (for 386 extern register)
@@ -226,9 +230,17 @@ struct	M
 	int32	gcing;
 	int32	locks;
 	int32	nomemprof;
+	void*	mprofbuf;	// MProfBuf of unrecorded memory profile samples, see mprof.goc
+	int32	noblockprof;
+	G*	gfree;		// dead gs with stacks, see gfput in proc.c
+	int32	gfreecnt;
 	int32	waitnextg;
 	int32	dying;
 	int32	profilehz;
+	void*	profbuf;	// ProfBuf of cpu profile samples, see cpuprof.c
+	void*	tracebuf;	// TraceBuf being filled, see trace.c
+	uint32	tracewriting;	// m is writing to tracebuf
+	uint64	ncgocall;	// number of cgo calls made on this m
 	Note	havenextg;
 	G*	nextg;
 	M*	alllink;	// on allm
@@ -338,6 +350,7 @@ enum {
 struct Defer
 {
 	int32	siz;
+	bool	nofree;	// if true, do not free d (it lives in the caller's frame)
 	byte*	argp;  // where args were copied from
 	byte*	pc;
 	byte*	fn;
@@ -356,6 +369,38 @@ struct Panic
 	bool	recovered;	// whether this panic is over
 };
 
+/*
+ * execution trace events, see trace.c.
+ * the arguments follow the time since the previous event,
+ * except for TraceEvBatch and TraceEvStack.
+ */
+enum
+{
+	TraceEvNone,
+	TraceEvBatch,		// start of a batch [mid, timestamp]
+	TraceEvStack,		// stack table entry [id, n, pc...]
+	TraceEvGoState,		// goroutine that existed when tracing started [goid, status]
+	TraceEvGoCreate,	// [goid, parent goid, stack]
+	TraceEvGoStart,		// [goid]
+	TraceEvGoSched,		// yielded or preempted [goid]
+	TraceEvGoEnd,		// [goid]
+	TraceEvGoBlock,		// [goid, TraceBlock reason, stack]
+	TraceEvGoUnblock,	// [goid, waker goid, stack]
+	TraceEvGoSysCall,	// [goid]
+	TraceEvGoSysExit,	// [goid]
+	TraceEvGoSysBlock,	// syscall returned but no cpu was free [goid]
+	TraceEvGCStart,		// []
+	TraceEvGCDone,		// [heap bytes in use]
+};
+enum
+{
+	TraceBlockSend,
+	TraceBlockRecv,
+	TraceBlockSelect,
+	TraceBlockSync,
+	TraceBlockFinalizer,
+};
+
 /*
  * external data
  */
@@ -369,6 +414,8 @@ extern	uint32	runtime·panicking;
 extern	int32	runtime·gcwaiting;		// gc is waiting to run
 int8*	runtime·goos;
 extern	bool	runtime·iscgo;
+extern	uint32	runtime·tracing;	// execution tracer is on
+extern	volatile int32	runtime·BlockProfileRate;
 
 /*
  * common functions and data
@@ -386,6 +433,7 @@ int32	runtime·charntorune(int32*, uint8*, int32);
 #define FLUSH(x)	USED(x)
 
 void	runtime·gogo(Gobuf*, uintptr);
+void	runtime·gogoret(Gobuf*, uintptr);
 void	runtime·gogocall(Gobuf*, void(*)(void));
 void	runtime·gosave(Gobuf*);
 void	runtime·lessstack(void);
@@ -401,6 +449,7 @@ void	runtime·printf(int8*, ...);
 byte*	runtime·mchr(byte*, byte, byte*);
 void	runtime·mcpy(byte*, byte*, uint32);
 int32	runtime·mcmp(byte*, byte*, uint32);
+bool	runtime·memeq(void*, void*, uintptr);
 void	runtime·memmove(void*, void*, uint32);
 void*	runtime·mal(uintptr);
 String	runtime·catstring(String, String);
@@ -416,6 +465,7 @@ int32	runtime·write(int32, void*, int32);
 bool	runtime·cas(uint32*, uint32, uint32);
 bool	runtime·casp(void**, void*, void*);
 uint32	runtime·xadd(uint32 volatile*, int32);
+uint32	runtime·atomicload(uint32 volatile*);
 void	runtime·jmpdefer(byte*, void*);
 void	runtime·exit1(int32);
 void	runtime·ready(G*);
@@ -464,7 +514,20 @@ void	runtime·dopanic(int32);
 void	runtime·startpanic(void);
 void	runtime·sigprof(uint8 *pc, uint8 *sp, uint8 *lr, G *gp);
 void	runtime·resetcpuprofiler(int32);
-void	runtime·setcpuprofilerate(void(*)(uintptr*, int32), int32);
+void	runtime·setcpuprofilerate(void(*)(uint8*, uint8*, uint8*, G*), int32);
+void	runtime·cpuprofminit(M*);
+void	runtime·SetCPUProfileRate(int32);
+bool	runtime·cpuprofstart(int32);
+void	runtime·cpuprofwrite(int32);
+void	runtime·profctlinit(void);
+void	runtime·profctlexit(void);
+void	runtime·coverdump(void);
+void	runtime·beforeexit(void);
+int32	runtime·coveropen(byte*);
+void	runtime·tracego(int32, G*);
+void	runtime·tracegostk(int32, G*, uintptr);
+void	runtime·tracegc(int32, uint64);
+void	runtime·blockevent(int64, int32);
 
 #pragma	varargck	argpos	runtime·printf	1
 #pragma	varargck	type	"d"	int32
@@ -0,0 +1,82 @@
+// Copyright 2011 The Go Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+package runtime_test
+
+import (
+	"testing"
+)
+
+// recurse calls itself n times with a frame of about
+// 1 KB, so a deep call grows the stack several times.
+func recurse(n int) int {
+	var buf [128]int
+	buf[n%len(buf)] = n
+	if n == 0 {
+		return buf[0]
+	}
+	return recurse(n-1) + buf[n%len(buf)]
+}
+
+// Each op runs a fresh goroutine that grows its stack to about
+// depth KB and returns; the segments are freed on the way back.
+func benchmarkStackGrowth(b *testing.B, depth int) {
+	parallel(b, func(n int) {
+		done := make(chan int)
+		for i := 0; i < n; i++ {
+			go func() { done <- recurse(depth) }()
+			<-done
+		}
+	})
+}
+
+func BenchmarkStackGrowth4K(b *testing.B)   { benchmarkStackGrowth(b, 4) }
+func BenchmarkStackGrowth64K(b *testing.B)  { benchmarkStackGrowth(b, 64) }
+func BenchmarkStackGrowth512K(b *testing.B) { benchmarkStackGrowth(b, 512) }
+
+// Growth and shrinkage within one goroutine, crossing a
+// segment boundary on every call.
+func BenchmarkStackSplit(b *testing.B) {
+	for i := 0; i < b.N; i++ {
+		recurse(8)
+	}
+}
+
+func deferred() {}
+
+func withDefer() {
+	defer deferred()
+}
+
+func withDefers() {
+	defer deferred()
+	defer deferred()
+	defer deferred()
+	defer deferred()
+}
+
+func BenchmarkDefer(b *testing.B) {
+	for i := 0; i < b.N; i++ {
+		withDefer()
+	}
+}
+
+func BenchmarkDefer4(b *testing.B) {
+	for i := 0; i < b.N; i++ {
+		withDefers()
+	}
+}
+
+func withRecover() {
+	defer func() {
+		recover()
+	}()
+	panic(0)
+}
+
+func BenchmarkDeferRecover(b *testing.B) {
+	for i := 0; i < b.N; i++ {
+		withRecover()
+	}
+}
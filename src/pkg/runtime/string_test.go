@@ -0,0 +1,99 @@
+// Copyright 2011 The Go Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+package runtime_test
+
+import (
+	"strings"
+	"testing"
+	"utf8"
+)
+
+var rangeTests = []string{
+	"",
+	"a",
+	"hello, world",
+	"héllo, wörld",
+	"日本語",
+	"a\xffb\xc0\xafc",
+	"\xe6\x97",
+	"ascii then 日本語 then ascii again, long enough to span words",
+}
+
+func TestRangeString(t *testing.T) {
+	for _, s := range rangeTests {
+		var ri, rv []int
+		valid := true
+		for i, c := range s {
+			ri = append(ri, i)
+			rv = append(rv, c)
+			if c == utf8.RuneError {
+				valid = false
+			}
+		}
+		n := 0
+		for i := 0; i < len(s); {
+			c, size := utf8.DecodeRuneInString(s[i:])
+			if n >= len(ri) || ri[n] != i || rv[n] != c {
+				t.Fatalf("range %q: bad rune %d", s, n)
+			}
+			i += size
+			n++
+		}
+		if n != len(ri) {
+			t.Errorf("range %q: %d runes, want %d", s, len(ri), n)
+		}
+		m := 0
+		for _ = range s {
+			m++
+		}
+		if m != n {
+			t.Errorf("range %q (index only): %d runes, want %d", s, m, n)
+		}
+		a := []int(s)
+		if len(a) != n {
+			t.Errorf("[]int(%q): %d runes, want %d", s, len(a), n)
+		}
+		for i, c := range rv {
+			if i < len(a) && a[i] != c {
+				t.Errorf("[]int(%q)[%d] = %#x, want %#x", s, i, a[i], c)
+			}
+		}
+		if s2 := string(rv); valid && s2 != s {
+			t.Errorf("string([]int(%q)) = %q", s, s2)
+		}
+	}
+}
+
+var asciiString = string(make([]byte, 4096))
+
+var mixedString = strings.Repeat("text 日本 ", 4096/12)
+
+func bmRange(b *testing.B, s string) {
+	b.SetBytes(int64(len(s)))
+	for i := 0; i < b.N; i++ {
+		n := 0
+		for _, c := range s {
+			n += c
+		}
+	}
+}
+
+func BenchmarkRangeStringASCII(b *testing.B) { bmRange(b, asciiString) }
+func BenchmarkRangeStringMixed(b *testing.B) { bmRange(b, mixedString) }
+
+func BenchmarkStringToIntsASCII(b *testing.B) {
+	b.SetBytes(int64(len(asciiString)))
+	for i := 0; i < b.N; i++ {
+		_ = []int(asciiString)
+	}
+}
+
+func BenchmarkIntsToStringASCII(b *testing.B) {
+	a := []int(asciiString)
+	b.SetBytes(int64(len(a)))
+	for i := 0; i < b.N; i++ {
+		_ = string(a)
+	}
+}
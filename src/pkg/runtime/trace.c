@@ -0,0 +1,458 @@
+// Copyright 2011 The Go Authors.  All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+// Execution tracer.
+//
+// While tracing is on, the scheduler, channel and semaphore
+// operations, system calls and the garbage collector record
+// events in a buffer owned by the current m.  Full buffers are
+// queued for a single reader, which copies them out one at a
+// time with ReadTrace.  The reader is expected to keep up:
+// the queue is not bounded.
+//
+// The trace is the header "go trace 1\n" followed by batches.
+// A batch holds the events that one m recorded, in order:
+//
+//	TraceEvBatch mid timestamp
+//	event...
+//
+// Each event is its type byte followed by unsigned varint arguments,
+// the first of which is the time in nanoseconds since the previous
+// event in the batch.  The event types and their arguments are listed
+// in runtime.h.  Events that record a stack refer to it by id; the first
+// event to use a stack in a trace is preceded by
+//
+//	TraceEvStack id n pc...
+//
+// Stack id 0 is the empty stack.  Cmd/gotrace decodes traces.
+//
+// Writers do not take locks except to swap a full buffer for an
+// empty one: each m writes only to its own buffer.  To stop the
+// trace, StopTrace turns off runtime·tracing and then waits for
+// each m's tracewriting count to drop to zero before taking its buffer.
+
+#include "runtime.h"
+#include "arch.h"
+#include "malloc.h"
+
+enum
+{
+	BufSize = 64<<10,
+	MaxStack = 32,
+	StackHash = 1<<10,
+	// Room needed for the longest event, a TraceEvStack
+	// followed by the event that uses it.
+	Room = 2 + 10*(2+MaxStack) + 10*4,
+
+	Off = 0,
+	On,
+	Stopping,
+};
+
+typedef struct TraceBuf TraceBuf;
+typedef struct TraceStack TraceStack;
+
+struct TraceBuf
+{
+	TraceBuf *link;
+	int64 lastts;		// time of the last event in buf
+	uintptr n;		// bytes used in buf
+	byte buf[BufSize];
+};
+
+struct TraceStack
+{
+	TraceStack *link;	// in hash chain
+	uintptr hash;
+	uint32 id;
+	uint32 gen;		// trace in which it was last recorded
+	int32 n;
+	uintptr *stk;
+};
+
+static struct
+{
+	Lock;
+	int32 state;
+	bool stopped;		// all ms have given up their buffers
+	bool header;		// header has been returned
+	bool wakeme;		// reader is waiting on wait
+	Note wait;
+	TraceBuf *full;		// queue of buffers for the reader
+	TraceBuf *fulltail;
+	TraceBuf *empty;	// free buffers
+	TraceBuf *reading;	// returned by the last ReadTrace
+	uint32 gen;
+
+	Lock stacklock;
+	TraceStack *stacks[StackHash];
+	uint32 nstack;
+	byte *mem;		// allocation arena for stacks
+	uintptr nmem;
+} trace;
+
+uint32 runtime·tracing;
+
+static byte header[] = "go trace 1\n";
+
+static void
+put(TraceBuf *b, uint64 v)
+{
+	byte *p;
+
+	p = b->buf + b->n;
+	while(v >= 0x80) {
+		*p++ = v | 0x80;
+		v >>= 7;
+	}
+	*p++ = v;
+	b->n = p - b->buf;
+}
+
+// Queue b for the reader and return an empty buffer
+// with a batch header, or nil if there is no memory.
+static TraceBuf*
+flush(TraceBuf *b)
+{
+	runtime·lock(&trace);
+	if(b != nil) {
+		b->link = nil;
+		if(trace.full == nil)
+			trace.full = b;
+		else
+			trace.fulltail->link = b;
+		trace.fulltail = b;
+		if(trace.wakeme) {
+			trace.wakeme = false;
+			runtime·notewakeup(&trace.wait);
+		}
+	}
+	b = trace.empty;
+	if(b != nil)
+		trace.empty = b->link;
+	runtime·unlock(&trace);
+
+	if(b == nil) {
+		b = runtime·SysAlloc(sizeof *b);
+		if(b == nil)
+			return nil;
+	}
+	b->n = 0;
+	b->lastts = runtime·nanotime();
+	b->buf[b->n++] = TraceEvBatch;
+	put(b, m->id);
+	put(b, b->lastts);
+	return b;
+}
+
+// Acquire returns m's buffer, with room for an event,
+// or nil if tracing is off.  If acquire returns a buffer,
+// the caller must call release when done with it.
+static TraceBuf*
+acquire(void)
+{
+	TraceBuf *b;
+
+	runtime·xadd(&m->tracewriting, 1);
+	if(!runtime·tracing) {
+		runtime·xadd(&m->tracewriting, -1);
+		return nil;
+	}
+	b = m->tracebuf;
+	if(b == nil || b->n + Room > BufSize) {
+		b = flush(b);
+		m->tracebuf = b;
+		if(b == nil) {
+			runtime·xadd(&m->tracewriting, -1);
+			return nil;
+		}
+	}
+	return b;
+}
+
+static void
+release(void)
+{
+	runtime·xadd(&m->tracewriting, -1);
+}
+
+// Begin writes the type and time of an event to b.
+static void
+begin(TraceBuf *b, int32 ev)
+{
+	int64 ts;
+
+	ts = runtime·nanotime();
+	if(ts < b->lastts)	// wall clock went backward
+		ts = b->lastts;
+	b->buf[b->n++] = ev;
+	put(b, ts - b->lastts);
+	b->lastts = ts;
+}
+
+static void*
+stackmem(uintptr n)
+{
+	byte *p;
+
+	if(n > trace.nmem) {
+		trace.nmem = 64<<10;
+		trace.mem = runtime·SysAlloc(trace.nmem);
+		if(trace.mem == nil) {
+			trace.nmem = 0;
+			return nil;
+		}
+	}
+	p = trace.mem;
+	trace.mem += n;
+	trace.nmem -= n;
+	return p;
+}
+
+// Stackid returns the id of stk, recording it in b
+// if it has not yet been recorded in this trace.
+static uint32
+stackid(TraceBuf *b, uintptr *stk, int32 n)
+{
+	TraceStack *s;
+	uintptr h;
+	int32 i;
+	uint32 id;
+
+	if(n == 0)
+		return 0;
+	h = 0;
+	for(i=0; i<n; i++)
+		h = h*31 + stk[i];
+
+	runtime·lock(&trace.stacklock);
+	for(s = trace.stacks[h%StackHash]; s; s=s->link) {
+		if(s->hash == h && s->n == n && runtime·mcmp((byte*)s->stk, (byte*)stk, n*sizeof stk[0]) == 0)
+			break;
+	}
+	if(s == nil) {
+		s = stackmem(sizeof *s + n*sizeof stk[0]);
+		if(s == nil) {
+			runtime·unlock(&trace.stacklock);
+			return 0;
+		}
+		s->hash = h;
+		s->id = ++trace.nstack;
+		s->n = n;
+		s->stk = (uintptr*)(s+1);
+		runtime·memmove(s->stk, stk, n*sizeof stk[0]);
+		s->link = trace.stacks[h%StackHash];
+		trace.stacks[h%StackHash] = s;
+	}
+	id = s->id;
+	if(s->gen != trace.gen) {
+		s->gen = trace.gen;
+		b->buf[b->n++] = TraceEvStack;
+		put(b, id);
+		put(b, n);
+		for(i=0; i<n; i++)
+			put(b, stk[i]);
+	}
+	runtime·unlock(&trace.stacklock);
+	return id;
+}
+
+// Tracego records an event about gp.
+void
+runtime·tracego(int32 ev, G *gp)
+{
+	TraceBuf *b;
+
+	if((b = acquire()) == nil)
+		return;
+	begin(b, ev);
+	put(b, gp->goid);
+	release();
+}
+
+// Tracegostk records an event about gp, with an argument
+// and the stack of the function that called tracegostk.
+void
+runtime·tracegostk(int32 ev, G *gp, uintptr arg)
+{
+	TraceBuf *b;
+	uintptr stk[MaxStack];
+	int32 n;
+	uint32 id;
+
+	n = runtime·callers(1, stk, nelem(stk));
+	if((b = acquire()) == nil)
+		return;
+	id = stackid(b, stk, n);
+	begin(b, ev);
+	put(b, gp->goid);
+	put(b, arg);
+	put(b, id);
+	release();
+}
+
+// Tracegc records a garbage collection event.
+void
+runtime·tracegc(int32 ev, uint64 heap)
+{
+	TraceBuf *b;
+
+	if((b = acquire()) == nil)
+		return;
+	begin(b, ev);
+	if(ev == TraceEvGCDone)
+		put(b, heap);
+	release();
+}
+
+// The user documentation is in debug.go.
+void
+runtime·StartTrace(bool ok)
+{
+	TraceBuf *b;
+	G *gp;
+
+	ok = false;
+	runtime·lock(&trace);
+	if(trace.state == Off) {
+		trace.state = On;
+		trace.stopped = false;
+		trace.header = false;
+		trace.gen++;
+		ok = true;
+	}
+	runtime·unlock(&trace);
+	if(ok) {
+		runtime·xadd(&runtime·tracing, 1);
+
+		// Record the goroutines that already exist.  Goroutines are
+		// only ever added to the front of allg, and new ones record
+		// their own creation now that tracing is on, so the list can
+		// be walked without the scheduler lock.  The states may be
+		// stale by the time they are recorded; cmd/gotrace uses them
+		// only for goroutines it has not otherwise seen.
+		for(gp = runtime·allg; gp != nil; gp = gp->alllink) {
+			if(gp->status == Gdead)
+				continue;
+			if((b = acquire()) == nil)
+				break;
+			begin(b, TraceEvGoState);
+			put(b, gp->goid);
+			put(b, gp->status);
+			release();
+		}
+	}
+	FLUSH(&ok);
+}
+
+// The user documentation is in debug.go.
+void
+runtime·StopTrace(void)
+{
+	M *mp;
+	TraceBuf *b;
+
+	runtime·lock(&trace);
+	if(trace.state != On) {
+		runtime·unlock(&trace);
+		return;
+	}
+	trace.state = Stopping;
+	runtime·unlock(&trace);
+
+	runtime·xadd(&runtime·tracing, -1);
+	for(mp=runtime·allm; mp; mp=mp->alllink) {
+		// Wait for any event mp is in the middle of writing.
+		while(runtime·atomicload(&mp->tracewriting) != 0)
+			;
+		b = mp->tracebuf;
+		mp->tracebuf = nil;
+		if(b != nil) {
+			runtime·lock(&trace);
+			b->link = nil;
+			if(trace.full == nil)
+				trace.full = b;
+			else
+				trace.fulltail->link = b;
+			trace.fulltail = b;
+			runtime·unlock(&trace);
+		}
+	}
+
+	runtime·lock(&trace);
+	trace.stopped = true;
+	if(trace.wakeme) {
+		trace.wakeme = false;
+		runtime·notewakeup(&trace.wait);
+	}
+	runtime·unlock(&trace);
+}
+
+static Slice
+readtrace(void)
+{
+	Slice ret;
+	TraceBuf *b;
+
+	ret.array = nil;
+	ret.len = 0;
+	ret.cap = 0;
+
+	runtime·lock(&trace);
+	if(trace.reading != nil) {
+		trace.reading->link = trace.empty;
+		trace.empty = trace.reading;
+		trace.reading = nil;
+	}
+	if(trace.state == Off) {
+		runtime·unlock(&trace);
+		return ret;
+	}
+	if(!trace.header) {
+		trace.header = true;
+		runtime·unlock(&trace);
+		ret.array = header;
+		ret.len = sizeof header - 1;
+		ret.cap = ret.len;
+		return ret;
+	}
+	for(;;) {
+		if(trace.full != nil) {
+			b = trace.full;
+			trace.full = b->link;
+			trace.reading = b;
+			runtime·unlock(&trace);
+			ret.array = b->buf;
+			ret.len = b->n;
+			ret.cap = b->n;
+			return ret;
+		}
+		if(trace.stopped) {
+			// All the data has been returned.
+			trace.state = Off;
+			runtime·unlock(&trace);
+			return ret;
+		}
+
+		// Wait for a full buffer or the end of the trace.
+		// The reader may record events of its own while in the
+		// system call, so trace must be unlocked.
+		runtime·noteclear(&trace.wait);
+		trace.wakeme = true;
+		runtime·unlock(&trace);
+		runtime·entersyscall();
+		runtime·notesleep(&trace.wait);
+		runtime·exitsyscall();
+		runtime·lock(&trace);
+	}
+}
+
+// ReadTrace returns the next block of the execution trace as a []byte.
+// The user documentation is in debug.go.
+void
+runtime·ReadTrace(Slice ret)
+{
+	ret = readtrace();
+	FLUSH(&ret);
+}
@@ -121,12 +121,20 @@ initevent(void **pevent)
 static void
 eventlock(Lock *l)
 {
+	int64 t0;
+
 	// Allocate event if needed.
 	if(l->event == 0)
 		initevent(&l->event);
 
-	if(runtime·xadd(&l->key, 1) > 1)	// someone else has it; wait
+	if(runtime·xadd(&l->key, 1) > 1) {	// someone else has it; wait
+		t0 = 0;
+		if(runtime·BlockProfileRate > 0)
+			t0 = runtime·nanotime();
 		runtime·stdcall(runtime·WaitForSingleObject, 2, l->event, -1);
+		if(t0 != 0)
+			runtime·blockevent(runtime·nanotime() - t0, 2);
+	}
 }
 
 static void
@@ -384,3 +392,32 @@ os·sigpipe(void)
 {
 	runtime·throw("too many writes on closed pipe");
 }
+
+// The profiling control channel for prof -i (see linux/profctl.c)
+// exists only on Linux.  Say so rather than ignore $GOPROFCTL.
+void
+runtime·profctlinit(void)
+{
+	byte *p;
+
+	p = runtime·getenv("GOPROFCTL");
+	if(p != nil && *p != 0)
+		runtime·printf("runtime: GOPROFCTL is set, but prof -i is not supported on Windows\n");
+}
+
+void
+runtime·profctlexit(void)
+{
+}
+
+// Coverage output (see cover.c) is written only on Linux.
+// A program built with -C and run with $GOCOVER set
+// must not appear to succeed without writing the counts.
+int32
+runtime·coveropen(byte *path)
+{
+	USED(path);
+	runtime·printf("runtime: GOCOVER is set, but coverage output is not supported on Windows\n");
+	runtime·exit(2);
+	return -1;
+}
@@ -0,0 +1,22 @@
+// Copyright 2011 The Go Authors.  All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+// The loops are shared with the runtime and the
+// bytes package; see runtime/386/asm.s.
+
+TEXT ·indexByte(SB),7,$0
+	MOVL	p+0(FP), SI
+	MOVL	len+4(FP), BX
+	MOVB	b+8(FP), AL
+	CALL	runtime·indexbytebody(SB)
+	MOVL	AX, ret+12(FP)
+	RET
+
+TEXT ·countByte(SB),7,$0
+	MOVL	p+0(FP), SI
+	MOVL	len+4(FP), BX
+	MOVB	b+8(FP), AL
+	CALL	runtime·countbytebody(SB)
+	MOVL	AX, ret+12(FP)
+	RET
@@ -0,0 +1,22 @@
+// Copyright 2011 The Go Authors.  All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+// The loops are shared with the runtime and the
+// bytes package; see runtime/amd64/asm.s.
+
+TEXT ·indexByte(SB),7,$0
+	MOVQ	p+0(FP), SI
+	MOVL	len+8(FP), BX
+	MOVB	b+16(FP), AL
+	CALL	runtime·indexbytebody(SB)
+	MOVL	AX, ret+24(FP)
+	RET
+
+TEXT ·countByte(SB),7,$0
+	MOVQ	p+0(FP), SI
+	MOVL	len+8(FP), BX
+	MOVB	b+16(FP), AL
+	CALL	runtime·countbytebody(SB)
+	MOVL	AX, ret+24(FP)
+	RET
@@ -0,0 +1,10 @@
+// Copyright 2011 The Go Authors.  All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+// no memchr implementation on arm yet
+TEXT ·indexByte(SB),7,$0
+	B	·indexBytePortable(SB)
+
+TEXT ·countByte(SB),7,$0
+	B	·countBytePortable(SB)
@@ -0,0 +1,11 @@
+// Copyright 2011 The Go Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+package strings
+
+// Export func for testing
+var IndexByte = indexByte
+var IndexBytePortable = indexBytePortable
+var CountByte = countByte
+var CountBytePortable = countBytePortable
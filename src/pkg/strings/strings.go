@@ -42,20 +42,23 @@ func Count(s, sep string) int {
 	}
 	c := sep[0]
 	l := len(sep)
-	n := 0
 	if l == 1 {
 		// special case worth making fast
-		for i := 0; i < len(s); i++ {
-			if s[i] == c {
-				n++
-			}
-		}
-		return n
+		return countByte(s, c)
 	}
-	for i := 0; i+l <= len(s); i++ {
-		if s[i] == c && s[i:i+l] == sep {
+	n := 0
+	for i := 0; i+l <= len(s); {
+		// skip ahead to the next possible match
+		o := indexByte(s[i:len(s)-l+1], c)
+		if o < 0 {
+			break
+		}
+		i += o
+		if s[i:i+l] == sep {
 			n++
-			i += l - 1
+			i += l
+		} else {
+			i++
 		}
 	}
 	return n
@@ -75,22 +78,42 @@ func Index(s, sep string) int {
 	c := sep[0]
 	if n == 1 {
 		// special case worth making fast
-		for i := 0; i < len(s); i++ {
-			if s[i] == c {
-				return i
-			}
-		}
-		return -1
+		return indexByte(s, c)
 	}
 	// n > 1
 	for i := 0; i+n <= len(s); i++ {
-		if s[i] == c && s[i:i+n] == sep {
+		// skip ahead to the next possible match
+		o := indexByte(s[i:len(s)-n+1], c)
+		if o < 0 {
+			break
+		}
+		i += o
+		if s[i:i+n] == sep {
+			return i
+		}
+	}
+	return -1
+}
+
+func indexBytePortable(s string, c byte) int {
+	for i := 0; i < len(s); i++ {
+		if s[i] == c {
 			return i
 		}
 	}
 	return -1
 }
 
+func countBytePortable(s string, c byte) int {
+	n := 0
+	for i := 0; i < len(s); i++ {
+		if s[i] == c {
+			n++
+		}
+	}
+	return n
+}
+
 // LastIndex returns the index of the last instance of sep in s, or -1 if sep is not present in s.
 func LastIndex(s, sep string) int {
 	n := len(sep)
@@ -0,0 +1,11 @@
+// Copyright 2011 The Go Authors.  All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+package strings
+
+// indexByte returns the index of the first instance of c in s, or -1 if c is not present in s.
+func indexByte(s string, c byte) int // asm_$GOARCH.s
+
+// countByte returns the number of instances of c in s.
+func countByte(s string, c byte) int // asm_$GOARCH.s
@@ -170,6 +170,83 @@ func BenchmarkIndex(b *testing.B) {
 	}
 }
 
+func TestIndexByte(t *testing.T) {
+	var buf [100]byte
+	for i := range buf {
+		buf[i] = 'a' + byte(i%7)
+	}
+	s := string(buf[:])
+	for off := 0; off < 8; off++ {
+		for n := 0; off+n <= len(s); n++ {
+			for _, c := range []byte{'a', 'g', 'x'} {
+				sub := s[off : off+n]
+				if i, want := IndexByte(sub, c), IndexBytePortable(sub, c); i != want {
+					t.Errorf("IndexByte(s[%d:%d], %q) = %d, want %d", off, off+n, c, i, want)
+				}
+				if i, want := CountByte(sub, c), CountBytePortable(sub, c); i != want {
+					t.Errorf("CountByte(s[%d:%d], %q) = %d, want %d", off, off+n, c, i, want)
+				}
+			}
+		}
+	}
+}
+
+var countTests = []IndexTest{
+	{"", "", 1},
+	{"", "a", 0},
+	{"abc", "", 4},
+	{"aaaa", "a", 4},
+	{"aaaa", "aa", 2},
+	{"aaaaa", "aa", 2},
+	{"barfoobarfoo", "foo", 2},
+	{"barfoobarfoo", "bar", 2},
+	{"foofoofo", "foo", 2},
+	{"0123456789abcdef0123456789abcdef", "f", 2},
+	{"0123456789abcdef0123456789abcdef", "ef0", 1},
+}
+
+func TestCount(t *testing.T) {
+	for _, test := range countTests {
+		if n := Count(test.s, test.sep); n != test.out {
+			t.Errorf("Count(%q, %q) = %d, want %d", test.s, test.sep, n, test.out)
+		}
+	}
+}
+
+var benchmarkLongString = Repeat("some_text=some_value ", 200) + "key=value"
+
+func BenchmarkIndexByteLong(b *testing.B) {
+	b.SetBytes(int64(len(benchmarkLongString)))
+	for i := 0; i < b.N; i++ {
+		Index(benchmarkLongString, "k")
+	}
+}
+
+func BenchmarkIndexShortNeedle(b *testing.B) {
+	b.SetBytes(int64(len(benchmarkLongString)))
+	for i := 0; i < b.N; i++ {
+		Index(benchmarkLongString, "key=")
+	}
+}
+
+func BenchmarkCountByte(b *testing.B) {
+	b.SetBytes(int64(len(benchmarkLongString)))
+	for i := 0; i < b.N; i++ {
+		Count(benchmarkLongString, "=")
+	}
+}
+
+func BenchmarkEqual(b *testing.B) {
+	x := benchmarkLongString
+	y := string([]byte(benchmarkLongString))
+	b.SetBytes(int64(len(x)))
+	for i := 0; i < b.N; i++ {
+		if x != y {
+			panic("bad equal")
+		}
+	}
+}
+
 
 type ExplodeTest struct {
 	s string
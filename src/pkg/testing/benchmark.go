@@ -176,6 +176,12 @@ func RunBenchmarks(matchString func(pat, str string) (bool, os.Error), benchmark
 	if len(*matchBenchmarks) == 0 {
 		return
 	}
+	// cpuList is set by Main; a caller running benchmarks
+	// directly gets the -test.cpu flag, or the current GOMAXPROCS.
+	if len(cpuList) == 0 {
+		parseCpuList()
+	}
+	defer runtime.GOMAXPROCS(runtime.GOMAXPROCS(-1)) // the loop below changes it
 	for _, Benchmark := range benchmarks {
 		matched, err := matchString(*matchBenchmarks, Benchmark.Name)
 		if err != nil {
@@ -185,9 +191,16 @@ func RunBenchmarks(matchString func(pat, str string) (bool, os.Error), benchmark
 		if !matched {
 			continue
 		}
-		b := &B{benchmark: Benchmark}
-		r := b.run()
-		fmt.Printf("%s\t%v\n", Benchmark.Name, r)
+		for _, procs := range cpuList {
+			runtime.GOMAXPROCS(procs)
+			b := &B{benchmark: Benchmark}
+			r := b.run()
+			name := Benchmark.Name
+			if procs != 1 {
+				name = fmt.Sprintf("%s-%d", name, procs)
+			}
+			fmt.Printf("%s\t%v\n", name, r)
+		}
 	}
 }
 
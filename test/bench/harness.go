@@ -0,0 +1,572 @@
+// Copyright 2011 The Go Authors.  All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+// Harness runs the benchmarks in this directory repeatedly and
+// reports robust statistics, so that small changes in the compilers
+// or the runtime can be told apart from noise.
+//
+// Each benchmark is built from its .go file with the local compiler
+// and, where gcc and the libraries are available, from its .c file.
+// Every version is run -warm times to settle caches, then -n more
+// times; for each run the harness records the wall time, the user+sys
+// CPU time of the process and, for Go programs, the number of garbage
+// collections and their total pause, taken from the runtime's
+// GOGCTRACE output (MemStats.NumGC).  It prints the median, the median
+// absolute deviation (MAD) and a distribution-free 95% confidence
+// interval for the median.
+//
+//	harness -save base.txt		# record a baseline
+//	harness -base base.txt		# compare against it
+//
+// With -base, each version is compared with the baseline's samples
+// using the Mann-Whitney U test.  A change with p < -alpha is marked
+// as faster or slower; if any version is significantly slower by more
+// than -min percent, harness exits with status 1, which makes it
+// usable as a gate for runtime changes.  So does a Go version that
+// fails to build, and, with -base, a Go version in the baseline that
+// has no result in this run.
+//
+// The sizes below are a fraction of those in timing.sh, to keep a run
+// of the whole suite to a few minutes.
+package main
+
+import (
+	"bufio"
+	"exec"
+	"flag"
+	"fmt"
+	"io/ioutil"
+	"math"
+	"os"
+	"runtime"
+	"sort"
+	"strconv"
+	"strings"
+	"time"
+)
+
+var (
+	iters  = flag.Int("n", 10, "timed runs of each benchmark")
+	warm   = flag.Int("warm", 1, "untimed runs before timing")
+	save   = flag.String("save", "", "write the samples to this baseline file")
+	base   = flag.String("base", "", "compare against this baseline file")
+	metric = flag.String("metric", "cpu", "what to compare: cpu or wall")
+	alpha  = flag.Float64("alpha", 0.01, "significance level for comparisons")
+	minpct = flag.Float64("min", 0, "ignore significant slowdowns smaller than this many percent")
+	nocc   = flag.Bool("noc", false, "skip the C versions")
+	verb   = flag.Bool("v", false, "print each run")
+)
+
+// A Bench describes one benchmark program.
+type Bench struct {
+	name  string
+	input int      // if > 0, stdin is fasta output of this length
+	goarg []string // arguments for the Go version
+	carg  []string // arguments for the C version
+	clibs []string // extra gcc arguments; nil if there is no C version
+}
+
+var benches = []Bench{
+	{"fasta", 0, []string{"-n", "2500000"}, []string{"2500000"}, []string{}},
+	{"reverse-complement", 2500000, nil, nil, []string{}},
+	{"nbody", 0, []string{"-n", "5000000"}, []string{"5000000"}, []string{"-lm"}},
+	{"binary-tree", 0, []string{"-n", "15"}, []string{"15"}, []string{"-lm"}},
+	{"binary-tree-freelist", 0, []string{"-n", "15"}, nil, nil},
+	{"fannkuch", 0, []string{"-n", "10"}, []string{"10"}, []string{}},
+	{"fannkuch-parallel", 0, []string{"-n", "10"}, nil, nil},
+	{"regex-dna", 100000, nil, nil, []string{"-lpcre"}},
+	{"regex-dna-parallel", 100000, nil, nil, nil},
+	{"spectral-norm", 0, []string{"-n", "1000"}, []string{"1000"}, []string{"-lm"}},
+	{"spectral-norm-parallel", 0, []string{"-n", "1000"}, nil, nil},
+	{"k-nucleotide", 1000000, nil, nil, []string{"-I/usr/include/glib-2.0", "-I/usr/lib/glib-2.0/include", "-lglib-2.0"}},
+	{"k-nucleotide-parallel", 1000000, nil, nil, nil},
+	{"mandelbrot", 0, []string{"-n", "4000"}, []string{"4000"}, []string{}},
+	{"meteor-contest", 0, []string{"-n", "2098"}, []string{"2098"}, []string{}},
+	{"pidigits", 0, []string{"-n", "2000"}, []string{"2000"}, []string{"-lgmp"}},
+	{"threadring", 0, []string{"-n", "500000"}, []string{"500000"}, []string{"-lpthread"}},
+	{"chameneosredux", 0, []string{"600000"}, []string{"600000"}, []string{"-lpthread"}},
+}
+
+// A Sample is the measurement of one run.
+type Sample struct {
+	wall  float64 // seconds
+	cpu   float64 // seconds, user+sys
+	gc    float64 // number of collections
+	pause float64 // milliseconds
+}
+
+// A Result holds the samples for one version of a benchmark,
+// named like "fasta/go" or "fasta/c".
+type Result struct {
+	name    string
+	samples []Sample
+}
+
+func main() {
+	flag.Parse()
+	only := make(map[string]bool)
+	for _, a := range flag.Args() {
+		only[a] = true
+	}
+	var baseline map[string]map[string][]float64
+	if *base != "" {
+		var err os.Error
+		baseline, err = readBaseline(*base)
+		if err != nil {
+			fatalf("%s", err)
+		}
+	}
+
+	var results []*Result
+	inputs := make(map[int]string)
+	failed := false
+	broken := false
+	printHeader(baseline != nil)
+	for _, b := range benches {
+		if len(only) > 0 && !only[b.name] {
+			continue
+		}
+		in := ""
+		if b.input > 0 {
+			if inputs[b.input] == "" {
+				inputs[b.input] = makeInput(b.input)
+			}
+			in = inputs[b.input]
+		}
+		if prog, err := buildGo(b.name); err != nil {
+			fmt.Fprintf(os.Stderr, "%s/go: %s\n", b.name, err)
+			broken = true
+		} else {
+			r := measure(b.name+"/go", prog, b.goarg, in, true)
+			results = append(results, r)
+			if report(r, baseline) {
+				failed = true
+			}
+		}
+		if *nocc || b.clibs == nil {
+			continue
+		}
+		if prog, err := buildC(b.name, b.clibs); err != nil {
+			if *verb {
+				fmt.Fprintf(os.Stderr, "%s/c: %s\n", b.name, err)
+			}
+		} else {
+			r := measure(b.name+"/c", prog, b.carg, in, false)
+			results = append(results, r)
+			if report(r, baseline) {
+				failed = true
+			}
+		}
+	}
+	for _, f := range inputs {
+		os.Remove(f)
+	}
+	if *save != "" {
+		if err := writeBaseline(*save, results); err != nil {
+			fatalf("%s", err)
+		}
+	}
+	if baseline != nil {
+		measured := make(map[string]bool)
+		for _, r := range results {
+			measured[r.name] = true
+		}
+		for name := range baseline {
+			if strings.HasSuffix(name, "/go") && !measured[name] && (len(only) == 0 || only[name[:len(name)-3]]) {
+				fmt.Printf("%-30s no result\n", name)
+				broken = true
+			}
+		}
+	}
+	if broken {
+		fmt.Printf("FAIL: missing Go results\n")
+		os.Exit(1)
+	}
+	if failed {
+		fmt.Printf("FAIL: significant slowdown\n")
+		os.Exit(1)
+	}
+}
+
+func fatalf(format string, args ...interface{}) {
+	fmt.Fprintf(os.Stderr, "harness: "+format+"\n", args...)
+	os.Exit(2)
+}
+
+// run runs the command and waits for it, returning its standard error.
+func run(stdin string, env []string, name string, args ...string) (string, *os.Waitmsg, os.Error) {
+	path, err := exec.LookPath(name)
+	if err != nil {
+		return "", nil, err
+	}
+	var in *os.File
+	if stdin != "" {
+		in, err = os.Open(stdin)
+	} else {
+		in, err = os.Open(os.DevNull)
+	}
+	if err != nil {
+		return "", nil, err
+	}
+	defer in.Close()
+	out, err := os.OpenFile(os.DevNull, os.O_WRONLY, 0)
+	if err != nil {
+		return "", nil, err
+	}
+	defer out.Close()
+	r, w, err := os.Pipe()
+	if err != nil {
+		return "", nil, err
+	}
+	argv := append([]string{name}, args...)
+	p, err := os.StartProcess(path, argv, &os.ProcAttr{Env: env, Files: []*os.File{in, out, w}})
+	w.Close()
+	if err != nil {
+		r.Close()
+		return "", nil, err
+	}
+	stderr, _ := ioutil.ReadAll(r)
+	r.Close()
+	msg, err := p.Wait(os.WRUSAGE)
+	p.Release()
+	if err != nil {
+		return "", nil, err
+	}
+	if !msg.Exited() || msg.ExitStatus() != 0 {
+		return string(stderr), msg, os.NewError(name + " failed: " + msg.String() + "\n" + string(stderr))
+	}
+	return string(stderr), msg, nil
+}
+
+func archChar() string {
+	switch runtime.GOARCH {
+	case "386":
+		return "8"
+	case "arm":
+		return "5"
+	}
+	return "6"
+}
+
+func buildGo(name string) (string, os.Error) {
+	O := archChar()
+	obj := name + "." + O
+	prog := "./" + name + "." + O + ".out"
+	if _, _, err := run("", nil, O+"g", "-o", obj, name+".go"); err != nil {
+		return "", err
+	}
+	if _, _, err := run("", nil, O+"l", "-o", prog, obj); err != nil {
+		return "", err
+	}
+	os.Remove(obj)
+	return prog, nil
+}
+
+func buildC(name string, libs []string) (string, os.Error) {
+	prog := "./" + name + ".c.out"
+	args := append([]string{"-O2", "-o", prog, name + ".c"}, libs...)
+	if _, _, err := run("", nil, "gcc", args...); err != nil {
+		return "", err
+	}
+	return prog, nil
+}
+
+// makeInput writes n bases of fasta output to a temporary file.
+func makeInput(n int) string {
+	prog, err := buildGo("fasta")
+	if err != nil {
+		fatalf("building input generator: %s", err)
+	}
+	f, err := ioutil.TempFile("", "fasta")
+	if err != nil {
+		fatalf("%s", err)
+	}
+	p, err := os.StartProcess(prog, []string{prog, "-n", strconv.Itoa(n)}, &os.ProcAttr{Files: []*os.File{nil, f, os.Stderr}})
+	if err != nil {
+		fatalf("%s", err)
+	}
+	p.Wait(0)
+	p.Release()
+	f.Close()
+	return f.Name()
+}
+
+func measure(name, prog string, args []string, stdin string, isGo bool) *Result {
+	env := os.Environ()
+	if isGo {
+		env = append(env, "GOGCTRACE=1")
+	}
+	r := &Result{name: name}
+	for i := 0; i < *warm+*iters; i++ {
+		t0 := time.Nanoseconds()
+		stderr, msg, err := run(stdin, env, prog, args...)
+		t1 := time.Nanoseconds()
+		if err != nil {
+			fatalf("%s: %s", name, err)
+		}
+		if i < *warm {
+			continue
+		}
+		var s Sample
+		s.wall = float64(t1-t0) / 1e9
+		ru := msg.Rusage
+		s.cpu = float64(ru.Utime.Sec+ru.Stime.Sec) + float64(ru.Utime.Usec+ru.Stime.Usec)/1e6
+		if isGo {
+			s.gc, s.pause = gcstats(stderr)
+		}
+		if *verb {
+			fmt.Printf("# %s %.3fs wall %.3fs cpu %.0f gc %.0fms\n", name, s.wall, s.cpu, s.gc, s.pause)
+		}
+		r.samples = append(r.samples, s)
+	}
+	return r
+}
+
+// gcstats parses GOGCTRACE lines, which look like
+//	gc12: 1+2+0 ms 10 -> 5 MB ...
+// and returns the number of the last collection and
+// the sum of the pause times.
+func gcstats(trace string) (n, pause float64) {
+	for _, line := range strings.Split(trace, "\n", -1) {
+		f := strings.Fields(line)
+		if len(f) < 3 || !strings.HasPrefix(f[0], "gc") || !strings.HasSuffix(f[0], ":") || f[2] != "ms" {
+			continue
+		}
+		num, err := strconv.Atoi(f[0][2 : len(f[0])-1])
+		if err != nil {
+			continue
+		}
+		n = float64(num)
+		for _, t := range strings.Split(f[1], "+", -1) {
+			ms, _ := strconv.Atoi(t)
+			pause += float64(ms)
+		}
+	}
+	return
+}
+
+func (r *Result) values(metric string) []float64 {
+	v := make([]float64, len(r.samples))
+	for i, s := range r.samples {
+		switch metric {
+		case "wall":
+			v[i] = s.wall
+		case "cpu":
+			v[i] = s.cpu
+		case "gc":
+			v[i] = s.gc
+		case "pause":
+			v[i] = s.pause
+		}
+	}
+	return v
+}
+
+func median(x []float64) float64 {
+	y := make([]float64, len(x))
+	copy(y, x)
+	sort.SortFloat64s(y)
+	n := len(y)
+	if n == 0 {
+		return 0
+	}
+	if n%2 == 1 {
+		return y[n/2]
+	}
+	return (y[n/2-1] + y[n/2]) / 2
+}
+
+// mad returns the median absolute deviation from the median.
+func mad(x []float64) float64 {
+	m := median(x)
+	d := make([]float64, len(x))
+	for i, v := range x {
+		d[i] = math.Fabs(v - m)
+	}
+	return median(d)
+}
+
+// medianCI returns an approximate 95% confidence interval for the
+// median, using the order statistics whose ranks are 1.96 standard
+// deviations of a Binomial(n, 1/2) either side of n/2.
+func medianCI(x []float64) (lo, hi float64) {
+	y := make([]float64, len(x))
+	copy(y, x)
+	sort.SortFloat64s(y)
+	n := len(y)
+	if n == 0 {
+		return 0, 0
+	}
+	k := int(math.Floor(float64(n)/2 - 1.96*math.Sqrt(float64(n))/2))
+	j := int(math.Ceil(float64(n)/2 + 1.96*math.Sqrt(float64(n))/2))
+	if k < 0 {
+		k = 0
+	}
+	if j > n-1 {
+		j = n - 1
+	}
+	return y[k], y[j]
+}
+
+// mannWhitney returns the two-sided p-value of the Mann-Whitney U test
+// that x and y come from the same distribution, using the normal
+// approximation with a correction for ties.
+func mannWhitney(x, y []float64) float64 {
+	nx, ny := len(x), len(y)
+	if nx == 0 || ny == 0 {
+		return 1
+	}
+	all := make(byValue, 0, nx+ny)
+	for _, v := range x {
+		all = append(all, obs{v, true})
+	}
+	for _, v := range y {
+		all = append(all, obs{v, false})
+	}
+	sort.Sort(all)
+	var rx, tie float64
+	for i := 0; i < len(all); {
+		j := i
+		for j < len(all) && all[j].v == all[i].v {
+			j++
+		}
+		rank := float64(i+j+1) / 2 // average of ranks i+1..j
+		for k := i; k < j; k++ {
+			if all[k].x {
+				rx += rank
+			}
+		}
+		t := float64(j - i)
+		tie += t*t*t - t
+		i = j
+	}
+	n1, n2 := float64(nx), float64(ny)
+	u := rx - n1*(n1+1)/2
+	mu := n1 * n2 / 2
+	n := n1 + n2
+	sigma := math.Sqrt(n1 * n2 / 12 * ((n + 1) - tie/(n*(n-1))))
+	if sigma == 0 {
+		if u == mu {
+			return 1
+		}
+		return 0
+	}
+	z := (math.Fabs(u-mu) - 0.5) / sigma
+	if z < 0 {
+		z = 0
+	}
+	return math.Erfc(z / math.Sqrt2)
+}
+
+// An obs is one observation in the Mann-Whitney test;
+// x reports whether it is from the first sample.
+type obs struct {
+	v float64
+	x bool
+}
+
+type byValue []obs
+
+func (a byValue) Len() int           { return len(a) }
+func (a byValue) Less(i, j int) bool { return a[i].v < a[j].v }
+func (a byValue) Swap(i, j int)      { a[i], a[j] = a[j], a[i] }
+
+func printHeader(compare bool) {
+	fmt.Printf("%-30s %9s %8s %21s %6s %8s", "benchmark", "median", "MAD", "95% CI", "gc", "pause")
+	if compare {
+		fmt.Printf("  vs base")
+	}
+	fmt.Printf("\n")
+}
+
+// report prints the statistics for r and, given a baseline,
+// the comparison.  It returns true for a significant slowdown.
+func report(r *Result, baseline map[string]map[string][]float64) bool {
+	v := r.values(*metric)
+	m := median(v)
+	lo, hi := medianCI(v)
+	fmt.Printf("%-30s %8.3fs %7.3fs [%8.3fs,%8.3fs]", r.name, m, mad(v), lo, hi)
+	if strings.HasSuffix(r.name, "/go") {
+		fmt.Printf(" %6.0f %6.0fms", median(r.values("gc")), median(r.values("pause")))
+	} else {
+		fmt.Printf(" %6s %8s", "-", "-")
+	}
+	slower := false
+	if baseline != nil {
+		b := baseline[r.name][*metric]
+		if len(b) == 0 {
+			fmt.Printf("  (no baseline)")
+		} else {
+			bm := median(b)
+			delta := 100 * (m - bm) / bm
+			p := mannWhitney(v, b)
+			fmt.Printf("  %+6.1f%% p=%.3f", delta, p)
+			if p < *alpha {
+				if delta > 0 {
+					fmt.Printf(" SLOWER")
+					slower = delta > *minpct
+				} else {
+					fmt.Printf(" faster")
+				}
+			}
+			if g := baseline[r.name]["gc"]; len(g) > 0 && median(g) != median(r.values("gc")) {
+				fmt.Printf(" gc %.0f->%.0f", median(g), median(r.values("gc")))
+			}
+		}
+	}
+	fmt.Printf("\n")
+	return slower
+}
+
+// The baseline file has one line per version and metric:
+//	fasta/go cpu 1.234 1.240 ...
+func writeBaseline(file string, results []*Result) os.Error {
+	f, err := os.Create(file)
+	if err != nil {
+		return err
+	}
+	w := bufio.NewWriter(f)
+	for _, r := range results {
+		for _, m := range []string{"cpu", "wall", "gc", "pause"} {
+			fmt.Fprintf(w, "%s %s", r.name, m)
+			for _, v := range r.values(m) {
+				fmt.Fprintf(w, " %g", v)
+			}
+			fmt.Fprintf(w, "\n")
+		}
+	}
+	if err := w.Flush(); err != nil {
+		f.Close()
+		return err
+	}
+	return f.Close()
+}
+
+func readBaseline(file string) (map[string]map[string][]float64, os.Error) {
+	data, err := ioutil.ReadFile(file)
+	if err != nil {
+		return nil, err
+	}
+	b := make(map[string]map[string][]float64)
+	for i, line := range strings.Split(string(data), "\n", -1) {
+		f := strings.Fields(line)
+		if len(f) == 0 {
+			continue
+		}
+		if len(f) < 2 {
+			return nil, fmt.Errorf("%s:%d: malformed line", file, i+1)
+		}
+		if b[f[0]] == nil {
+			b[f[0]] = make(map[string][]float64)
+		}
+		for _, s := range f[2:] {
+			v, err := strconv.Atof64(s)
+			if err != nil {
+				return nil, fmt.Errorf("%s:%d: %s", file, i+1, err)
+			}
+			b[f[0]][f[1]] = append(b[f[0]][f[1]], v)
+		}
+	}
+	return b, nil
+}
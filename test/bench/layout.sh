@@ -0,0 +1,111 @@
+#!/usr/bin/env bash
+# Copyright 2011 The Go Authors.  All rights reserved.
+# Use of this source code is governed by a BSD-style
+# license that can be found in the LICENSE file.
+
+# Layout.sh measures profile-guided code layout (6l -P) on a large
+# synthetic program.  The program has $nfunc functions; every $stride-th
+# one is hot, and each of them carries a large error path that never
+# runs.  Linked in the usual order, the hot code is spread thinly over
+# about two megabytes of text and misses in the instruction cache and
+# the iTLB on every round.  The program is run once with -cpuprofile,
+# long enough for most hot functions to get a sample at 100 Hz, then
+# relinked with -P, which packs the hot code into a few pages.
+#
+#	./layout.sh [nfunc [stride [rounds]]]
+
+set -e
+
+eval $(gomake --no-print-directory -f ../../src/Make.inc go-env)
+
+nfunc=${1:-4096}
+stride=${2:-16}
+rounds=${3:-50000}
+
+awk -v nfunc=$nfunc -v stride=$stride '
+BEGIN {
+	print "// generated by layout.sh; DO NOT EDIT"
+	print ""
+	print "package main"
+	print ""
+	print "import ("
+	print "\t\"flag\""
+	print "\t\"fmt\""
+	print "\t\"os\""
+	print "\t\"runtime/pprof\""
+	print "\t\"time\""
+	print ")"
+	for(i=0; i<nfunc; i++) {
+		print ""
+		printf("func f%d(x int) int {\n", i)
+		print "\tif x < 0 {"
+		printf("\t\ty := x*%d + 1\n", i)
+		for(j=0; j<16; j++)
+			printf("\t\ty = y*%d ^ y>>%d\n", 2*j+3, j%7+1)
+		printf("\t\tprintln(\"f%d\", y)\n", i)
+		print "\t\tpanic(\"negative\")"
+		print "\t}"
+		printf("\tx += %d\n", i)
+		print "\tx ^= x >> 7"
+		print "\tx *= 0x2545f491"
+		print "\treturn x & 0x7fffffff"
+		print "}"
+	}
+	print ""
+	print "var hot = []func(int) int{"
+	for(i=0; i<nfunc; i+=stride)
+		printf("\tf%d,\n", i)
+	print "}"
+	print ""
+	print "var cold = []func(int) int{"
+	for(i=0; i<nfunc; i++)
+		if(i%stride != 0)
+			printf("\tf%d,\n", i)
+	print "}"
+	print ""
+	print "var rounds = flag.Int(\"n\", 1000, \"rounds\")"
+	print "var cpuprofile = flag.String(\"cpuprofile\", \"\", \"write a cpu profile to this file\")"
+	print ""
+	print "func main() {"
+	print "\tflag.Parse()"
+	print "\tif *cpuprofile != \"\" {"
+	print "\t\tf, err := os.Create(*cpuprofile)"
+	print "\t\tif err != nil {"
+	print "\t\t\tpanic(err)"
+	print "\t\t}"
+	print "\t\tpprof.StartCPUProfile(f)"
+	print "\t\tdefer pprof.StopCPUProfile()"
+	print "\t}"
+	print "\tx := 1"
+	print "\tif *rounds < 0 {"
+	print "\t\tfor _, f := range cold {"
+	print "\t\t\tx = f(x)"
+	print "\t\t}"
+	print "\t}"
+	print "\tt0 := time.Nanoseconds()"
+	print "\tfor i := 0; i < *rounds; i++ {"
+	print "\t\tfor _, f := range hot {"
+	print "\t\t\tx = f(x)"
+	print "\t\t}"
+	print "\t}"
+	print "\tt1 := time.Nanoseconds()"
+	print "\tfmt.Printf(\"%.2f ns/call (%d)\\n\", float64(t1-t0)/float64(*rounds*len(hot)), x&1)"
+	print "}"
+}' > layout-big.go
+
+$GC layout-big.go
+$LD -o layout-big layout-big.$O
+./layout-big -n $((rounds*40)) -cpuprofile layout-big.prof >/dev/null
+cp layout-big layout-big.base
+$LD -P layout-big.prof -o layout-big layout-big.$O
+
+best() {
+	for i in 1 2 3 4 5
+	do
+		"$@"
+	done | sort -n | sed 1q
+}
+
+echo "layout: $nfunc functions, $(((nfunc+stride-1)/stride)) hot"
+echo "	load order	$(best ./layout-big.base -n $rounds)"
+echo "	with -P		$(best ./layout-big -n $rounds)"
@@ -0,0 +1,53 @@
+// $G -C $D/$F.go && $L $F.$A || exit 1
+// test $GOOS = linux || exit 0	# only Linux writes $GOCOVER
+// rm -f $F.cnt && GOCOVER=$F.cnt ./$A.out || exit 1
+// got=$(sed 's/^.*://' $F.cnt | sort -n) && rm -f $F.cnt
+// want='20,20 0 10 21,21 1 4 23,23 2 6 24,24 3 3 26,26 4 3 30,30 5 1 32,32 6 3 33,33 7 6 35,35 8 3 36,36 9 2 38,38 10 1 42,42 11 0 46,47 12 1 48,48 13 10 50,50 14 1 51,51 15 0'
+// test "$(echo $got)" = "$want" || echo BUG: coverage counts: $got
+
+// Copyright 2011 The Go Authors.  All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+// Check the coverage counts of a program compiled with -C:
+// ten calls of classify split 4, 3, 3, never is not called,
+// and the labeled loop in retry is entered three times,
+// twice by goto.
+
+package main
+
+func classify(i int) int {
+	if i%3 == 0 {
+		return 0
+	}
+	if i%3 == 1 {
+		return 1
+	}
+	return 2
+}
+
+func retry() int {
+	tries := 0
+again:
+	for i := 0; i < 2; i++ {
+		tries++
+	}
+	if tries < 6 {
+		goto again
+	}
+	return tries
+}
+
+func never() {
+	panic("never called")
+}
+
+func main() {
+	n := 0
+	for i := 0; i < 10; i++ {
+		n += classify(i)
+	}
+	if n != 9 || retry() != 6 {
+		never()
+	}
+}
@@ -0,0 +1,107 @@
+// $G $D/$F.go && $L $F.$A && ./$A.out
+
+// Copyright 2011 The Go Authors.  All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+package main
+
+// check that a value loaded twice is loaded again
+// when a store or a call in between may change it.
+
+type T struct {
+	a, b int
+	f    float64
+	next *T
+}
+
+var g T
+
+func alias(p, q *T) int {
+	x := p.a
+	q.a = x + 1
+	return x + p.a
+}
+
+func chain(p *T) int {
+	return p.next.a + p.next.b
+}
+
+func chainstore(p, q *T) int {
+	x := p.next.a
+	p.next = q
+	return x + p.next.a
+}
+
+func set(p *T) { p.a++ }
+
+func call(p *T) int {
+	x := p.a
+	set(p)
+	return x + p.a
+}
+
+func local(n int) int {
+	var a [4]int
+	a[1] = n
+	x := a[1]
+	a[1] = n + 1
+	return x + a[1]
+}
+
+func ptrlocal(n int) int {
+	var a [4]int
+	p := &a[1]
+	a[1] = n
+	x := a[1]
+	*p = n + 5
+	return x + a[1]
+}
+
+func index(s []int, i int) int {
+	x := s[i]
+	s[i+1-1] = x * 2
+	return x + s[i]
+}
+
+func float(p, q *T) float64 {
+	x := p.f * 2
+	q.f = 10
+	return x + p.f*2
+}
+
+func branch(p *T, c bool) int {
+	x := p.next.a
+	if c {
+		p.next.a = 7
+	}
+	return x + p.next.a
+}
+
+func check(name string, got, want int) {
+	if got != want {
+		println(name, got, want)
+		panic("fail")
+	}
+}
+
+func main() {
+	t := &T{a: 1, b: 2, f: 1}
+	u := &T{a: 3, b: 4, next: t}
+	check("alias", alias(t, t), 3)
+	t.a = 1
+	check("alias2", alias(t, u), 2)
+	check("chain", chain(u), 3)
+	check("chainstore", chainstore(u, u), 3)
+	u.next = t
+	check("call", call(t), 3)
+	check("local", local(4), 9)
+	check("ptrlocal", ptrlocal(4), 13)
+	check("index", index([]int{1, 2, 3}, 1), 6)
+	if f := float(t, t); f != 22 {
+		println("float", f)
+		panic("fail")
+	}
+	check("branch", branch(u, true), 9)
+	check("branch2", branch(u, false), 14)
+}
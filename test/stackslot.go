@@ -0,0 +1,95 @@
+// $G $D/$F.go && $L $F.$A && ./$A.out
+
+// Copyright 2011 The Go Authors.  All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+package main
+
+// check that locals and temporaries that share
+// stack memory never clobber one another.
+
+type big struct {
+	a [20]int
+	s string
+}
+
+func mk(n int) big {
+	var b big
+	for i := range b.a {
+		b.a[i] = n + i
+	}
+	b.s = "x"
+	return b
+}
+
+func sum(b big) int {
+	t := 0
+	for _, v := range b.a {
+		t += v
+	}
+	return t + len(b.s)
+}
+
+// each case has temporaries of its own
+func cases(n int) int {
+	switch n {
+	case 0:
+		return sum(mk(1))
+	case 1:
+		x := mk(2)
+		y := mk(3)
+		return sum(x) - sum(y)
+	case 2:
+		s := []int{1, 2, 3}
+		t := "abc" + string('d'+n)
+		return len(s) + len(t)
+	case 3:
+		m := map[string]big{"y": mk(4)}
+		b, ok := m["x"]
+		if ok {
+			return -1
+		}
+		return sum(b)
+	}
+	return 0
+}
+
+// x lives across the loop while y is a new value each time around
+func loop(n int) int {
+	x := mk(n)
+	t := 0
+	for i := 0; i < 3; i++ {
+		y := mk(i)
+		t += sum(y)
+		x.a[i] = t
+	}
+	return sum(x)
+}
+
+func set(p *big, n int) { p.a[0] = n }
+
+// b's address is taken; c must not land on it
+func addr(n int) int {
+	var b big
+	p := &b
+	c := mk(n)
+	set(p, n)
+	return b.a[0] + sum(c) + p.a[0]
+}
+
+func check(name string, got, want int) {
+	if got != want {
+		println(name, got, want)
+		panic("fail")
+	}
+}
+
+func main() {
+	check("case0", cases(0), 211)
+	check("case1", cases(1), -20)
+	check("case2", cases(2), 7)
+	check("case3", cases(3), 0)
+	check("loop", loop(10), 1584)
+	check("addr", addr(5), 301)
+}